@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# Souffle - A Datalog Compiler
+# Copyright (c) 2019, The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+#
+
+"""Checks that the RAM transformers preserve the outputs of the dataflow analyses.
+
+The example analyses run on their own facts. The analyses of run_bench.py
+also run on generated programs. Each analysis runs under the interpreter
+twice: once with the RAM transformers and once without them. The sorted
+output relations of both runs must be equal.
+"""
+
+import argparse
+import os
+import sys
+
+import gen_cfg
+from run_bench import ANALYSES, ROOT, run
+
+RAM_TRANSFORMERS = ["LevelConditionsTransformer", "CreateIndicesTransformer",
+                    "ConvertExistenceChecksTransformer"]
+
+# example -> (directory, program, fact directory, include directories)
+EXAMPLES = {
+    "const": ("Const_lattice", "const_prop.dl", "facts", []),
+    "const_while": ("Const_lattice_whileloop", "const_prop.dl", ".", []),
+    "sign": ("Sign_lattice", "sign.dl", "facts", []),
+    "sign_glb_lub": ("Sign_lattice_glb_lub", "sign.dl", "facts", []),
+    "powerset": ("Powerset_lattice", "available.dl", ".", []),
+    "example_lattice": ("Example_lat_test", "example.dl", ".", []),
+    "example": ("Example_test", "example.dl", ".", []),
+}
+for test in ["test1", "test3"]:
+    EXAMPLES["ae_" + test] = ("ae", "availableExp.dl", "../tests/" + test, ["../shared"])
+    EXAMPLES["ae_powerset_" + test] = ("Powerset_lattice", "availableExp.dl", "../tests/" + test, ["../shared"])
+    EXAMPLES["liveness_" + test] = ("liveness", "liveness.dl", "../tests/" + test, ["../shared", "."])
+    EXAMPLES["rd_" + test] = ("rd", "reachingDef.dl", "../tests/" + test, ["../shared", "."])
+    EXAMPLES["vbe_" + test] = ("veryBusyExpr", "veryBusyExp.dl", "../tests/" + test, ["../shared"])
+
+
+def read_output(directory):
+    """Reads the sorted tuples of each output relation."""
+    output = {}
+    for name in os.listdir(directory):
+        if name.endswith(".csv"):
+            with open(os.path.join(directory, name)) as relation:
+                output[name] = sorted(relation.read().splitlines())
+    return output
+
+
+def check(args, name, directory, program, facts, includes, work):
+    """Runs an analysis with and without the RAM transformers, comparing the outputs."""
+    outputs = []
+    for disabled in [[], RAM_TRANSFORMERS]:
+        output = os.path.join(work, name, "without" if disabled else "with")
+        os.makedirs(output, exist_ok=True)
+        cmd = [args.souffle, program, "-F", facts, "-D", output, "-j", str(args.jobs)]
+        cmd += ["-I" + include for include in includes]
+        if disabled:
+            cmd.append("--disable-transformers=" + ",".join(disabled))
+        status, _, _, stderr = run(cmd, os.path.join(ROOT, directory), args.timeout)
+        if status != "ok":
+            sys.stderr.write("%s: %s\n%s" % (name, status, stderr))
+            return False
+        outputs.append(read_output(output))
+
+    differing = sorted(relation for relation in set(outputs[0]) | set(outputs[1])
+                       if outputs[0].get(relation) != outputs[1].get(relation))
+    if differing:
+        sys.stderr.write("%s: outputs differ in %s\n" % (name, ", ".join(differing)))
+        return False
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--souffle", default=os.path.join(ROOT, "..", "src", "souffle"),
+                        help="souffle executable")
+    parser.add_argument("--lines", type=int, default=25, help="size of the generated program")
+    parser.add_argument("--seed", type=int, default=0, help="seed of the generated program")
+    parser.add_argument("--jobs", type=int, default=1, help="number of threads")
+    parser.add_argument("--timeout", type=float, default=120, help="seconds per run")
+    parser.add_argument("--work", default="work", help="directory for facts and outputs")
+    args = parser.parse_args()
+
+    args.souffle = os.path.abspath(args.souffle)
+    work = os.path.join(os.path.abspath(args.work), "check")
+
+    failures = 0
+    for name, (directory, program, facts, includes) in EXAMPLES.items():
+        if not check(args, name, directory, program, facts, includes, work):
+            failures += 1
+
+    facts = os.path.join(work, "facts")
+    gen_cfg.Program(args.lines, 5, 0.1, args.seed).generate().write(facts)
+    for analysis, variants in ANALYSES.items():
+        for variant, (directory, program, includes) in variants.items():
+            name = "generated_%s_%s" % (analysis, variant)
+            if not check(args, name, directory, program, facts, includes, work):
+                failures += 1
+
+    print("%d analyses differ or failed" % failures if failures else "all outputs agree")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
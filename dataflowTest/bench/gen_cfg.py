@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+#
+# Souffle - A Datalog Compiler
+# Copyright (c) 2019, The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+#
+
+"""Generates synthetic control flow graphs as fact sets for the dataflow tests.
+
+A program is a sequence of assignments over a fixed set of variables. With
+probability BRANCHING an assignment is followed by an if/else, whose branches
+are generated recursively and join again afterwards. The control flow graph
+is acyclic, such that the analyses without lattices terminate as well.
+
+Each program is written in all schemas used by the dataflow tests:
+  - statements (Const_*, Sign_*): setConstStm, addStm, minusStm, multStm,
+    divStm, increStm and flow
+  - expressions (shared/prog.dl): constExp, varExp, opExp, assignStmt,
+    testCond, initLabel and finalLabel
+  - simplified (shared/progSimpl.dl): assign and read
+"""
+
+import argparse
+import os
+import random
+
+OPERATORS = ["add", "minus", "mult", "div"]
+
+# prog.dl only knows + and *
+EXPRESSION_OPERATOR = {"add": "+", "minus": "+", "mult": "*", "div": "*"}
+
+
+class Program:
+    def __init__(self, lines, variables, branching, seed):
+        self.random = random.Random(seed)
+        self.lines = lines
+        self.variables = ["v%d" % i for i in range(variables)]
+        self.branching = branching
+        self.statements = []
+        self.flow = []
+
+    def generate(self):
+        # define every variable before its first use
+        preds = []
+        for var in self.variables[:self.lines]:
+            preds = self.emit(preds, ("setConst", var, self.constant()))
+        tails = self.block(self.lines - len(self.statements), preds)
+        self.final = sorted(set(tails))
+        return self
+
+    def block(self, budget, preds):
+        while budget > 0:
+            preds = self.emit(preds, self.statement())
+            budget -= 1
+            if budget >= 2 and self.random.random() < self.branching:
+                # split the rest of this block between the branches
+                size = self.random.randint(2, max(2, min(budget, 16)))
+                left = self.random.randint(1, size - 1)
+                fork = preds
+                preds = self.block(left, fork) + self.block(size - left, fork)
+                budget -= size
+        return preds
+
+    def emit(self, preds, statement):
+        label = len(self.statements)
+        self.statements.append(statement)
+        for pred in preds:
+            self.flow.append((pred, label))
+        return [label]
+
+    def statement(self):
+        target = self.random.choice(self.variables)
+        if self.random.random() < 0.2:
+            return ("setConst", target, self.constant())
+        op = self.random.choice(OPERATORS)
+        return (op, target, self.random.choice(self.variables), self.random.choice(self.variables))
+
+    def constant(self):
+        return self.random.randint(-5, 5)
+
+    def write(self, directory):
+        os.makedirs(directory, exist_ok=True)
+        facts = {name: [] for name in
+                 ["setConstStm", "increStm", "flow", "constExp", "varExp", "opExp", "assignStmt",
+                  "testCond", "initLabel", "finalLabel", "assign", "read"]
+                 + [op + "Stm" for op in OPERATORS]}
+
+        facts["flow"] = list(self.flow)
+        facts["initLabel"] = [(0,)]
+        facts["finalLabel"] = [(label,) for label in self.final]
+        facts["varExp"] = [("x_" + var, var) for var in self.variables]
+
+        constants = set()
+        expressions = set()
+        for label, statement in enumerate(self.statements):
+            kind, target = statement[0], statement[1]
+            facts["assign"].append((label, target))
+            if kind == "setConst":
+                value = statement[2]
+                facts["setConstStm"].append((label, target, value))
+                constants.add(value)
+                facts["assignStmt"].append((label, target, "c_%d" % value))
+            else:
+                x, y = statement[2], statement[3]
+                facts[kind + "Stm"].append((label, target, x, y))
+                op = EXPRESSION_OPERATOR[kind]
+                expression = "e_%s_%s_%s" % (kind, x, y)
+                expressions.add((expression, op, "x_" + x, "x_" + y))
+                facts["assignStmt"].append((label, target, expression))
+                facts["read"].extend(sorted({(label, x), (label, y)}))
+
+        facts["constExp"] = [("c_%d" % value, value) for value in sorted(constants)]
+        facts["opExp"] = sorted(expressions)
+
+        for name, rows in facts.items():
+            with open(os.path.join(directory, name + ".facts"), "w") as out:
+                for row in rows:
+                    out.write("\t".join(str(col) for col in row) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--lines", type=int, default=50, help="number of statements")
+    parser.add_argument("--vars", type=int, default=5, help="number of variables")
+    parser.add_argument("--branching", type=float, default=0.1,
+                        help="probability of an if/else after a statement")
+    parser.add_argument("--seed", type=int, default=0, help="random seed")
+    parser.add_argument("output", help="directory for the fact files")
+    args = parser.parse_args()
+
+    Program(args.lines, args.vars, args.branching, args.seed).generate().write(args.output)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+#
+# Souffle - A Datalog Compiler
+# Copyright (c) 2019, The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+#
+
+"""Benchmarks the dataflow analyses with and without lattices.
+
+Every analysis variant is run on synthetic programs from gen_cfg.py. It runs
+both under the interpreter and as a compiled binary. Each run writes one CSV
+row to the report with these columns:
+
+  analysis, variant, mode    what was run (mode is interpreter or compiler)
+  lines, vars, branching     the parameters of the generated program
+  seed
+  status                     ok, failed or timeout
+  wall_s                     wall clock time of the run (excluding C++ compilation)
+  peak_rss_kb                maximum resident set size of the run
+  iterations                 fixpoint iterations summed over all strata
+  tuples                     tuples (lattice cells) derived by all rules
+  output_tuples              tuples in the output relations
+
+Iterations and tuples are taken from the profile log of the run.
+"""
+
+import argparse
+import csv
+import json
+import multiprocessing
+import os
+import resource
+import subprocess
+import sys
+import time
+
+import gen_cfg
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# analysis -> variant -> (directory, program, include directories)
+ANALYSES = {
+    "const": {
+        "lattice": ("Const_lattice", "const_prop.dl", []),
+        "noLattice": ("Const_noLattice", "const_prop.dl", []),
+    },
+    "sign": {
+        "lattice": ("Sign_lattice", "sign.dl", []),
+        "noLattice": ("Sign_noLattice", "sign.dl", []),
+    },
+    "ae": {
+        "lattice": ("Powerset_lattice", "availableExp.dl", ["../shared"]),
+        "noLattice": ("ae", "availableExp.dl", ["../shared"]),
+    },
+    "rd": {
+        "noLattice": ("rd", "reachingDef.dl", ["../shared", "."]),
+    },
+    "liveness": {
+        "noLattice": ("liveness", "liveness.dl", ["../shared", "."]),
+    },
+}
+
+COLUMNS = ["analysis", "variant", "mode", "lines", "vars", "branching", "seed", "status", "wall_s",
+           "peak_rss_kb", "iterations", "tuples", "output_tuples"]
+
+
+def measure(cmd, cwd, timeout):
+    """Runs a command in the calling process, see run()."""
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    try:
+        _, stderr = proc.communicate(timeout=timeout)
+        status = "ok" if proc.returncode == 0 else "failed"
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        _, stderr = proc.communicate()
+        status = "timeout"
+    wall = time.monotonic() - start
+    rss = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    return status, wall, rss, stderr.decode(errors="replace")
+
+
+def run(cmd, cwd, timeout):
+    """Runs a command, returning its status, wall time, peak RSS and error output.
+
+    RUSAGE_CHILDREN holds the largest RSS of all children waited for, so each
+    command is run from a fresh worker process whose only child it is.
+    """
+    with multiprocessing.Pool(1) as pool:
+        return pool.apply(measure, (cmd, cwd, timeout))
+
+
+def read_profile(path):
+    """Sums the iterations and derived tuples of a profile log."""
+    with open(path) as log:
+        program = json.load(log)["root"]["program"]
+    relations = program.get("relation", {})
+
+    iterations = 0
+    for stratum in program.get("stratum", {}).values():
+        iterations += max([len(relations.get(name, {}).get("iteration", {}))
+                           for name in stratum.get("relation", {})] or [0])
+
+    tuples = 0
+    for relation in relations.values():
+        if "loadtime" in relation:
+            continue
+        tuples += relation.get("num-tuples", 0)
+        for iteration in relation.get("iteration", {}).values():
+            tuples += iteration.get("num-tuples", 0)
+    return iterations, tuples
+
+
+def count_output(directory):
+    count = 0
+    for name in os.listdir(directory):
+        if name.endswith(".csv"):
+            with open(os.path.join(directory, name)) as out:
+                count += sum(1 for _ in out)
+    return count
+
+
+def compile_variant(args, analysis, variant, work):
+    """Compiles an analysis variant to a binary with profiling enabled."""
+    directory, program, includes = ANALYSES[analysis][variant]
+    binary = os.path.join(work, "bin", "%s_%s" % (analysis, variant))
+    os.makedirs(os.path.dirname(binary), exist_ok=True)
+    cmd = [args.souffle, program, "-p", binary + ".log", "-o", binary, "-j", str(args.jobs)]
+    cmd += ["-I" + include for include in includes]
+    # C++ compilation is not timed, so it gets an hour regardless of --timeout
+    status, _, _, stderr = run(cmd, os.path.join(ROOT, directory), 3600)
+    if status != "ok":
+        sys.stderr.write("%s/%s: compilation %s\n%s" % (analysis, variant, status, stderr))
+        return None
+    return binary
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--souffle", default=os.path.join(ROOT, "..", "src", "souffle"),
+                        help="souffle executable")
+    parser.add_argument("--analyses", default=",".join(ANALYSES), help="analyses to run")
+    parser.add_argument("--modes", default="interpreter,compiler", help="execution modes to run")
+    parser.add_argument("--lines", default="25,50,100", help="program sizes")
+    parser.add_argument("--vars", default="5", help="numbers of variables")
+    parser.add_argument("--branching", default="0.1", help="branching probabilities")
+    parser.add_argument("--seeds", type=int, default=3, help="programs per configuration")
+    parser.add_argument("--jobs", type=int, default=1, help="number of threads")
+    parser.add_argument("--timeout", type=float, default=120, help="seconds per run")
+    parser.add_argument("--work", default="work", help="directory for facts, binaries and outputs")
+    parser.add_argument("--report", default="report.csv", help="CSV report to write")
+    args = parser.parse_args()
+
+    args.souffle = os.path.abspath(args.souffle)
+    work = os.path.abspath(args.work)
+    analyses = args.analyses.split(",")
+    modes = args.modes.split(",")
+    for analysis in analyses:
+        if analysis not in ANALYSES:
+            parser.error("unknown analysis " + analysis)
+
+    binaries = {}
+    if "compiler" in modes:
+        for analysis in analyses:
+            for variant in ANALYSES[analysis]:
+                binaries[(analysis, variant)] = compile_variant(args, analysis, variant, work)
+
+    with open(args.report, "w", newline="") as report:
+        writer = csv.writer(report)
+        writer.writerow(COLUMNS)
+        for lines in map(int, args.lines.split(",")):
+            for num_vars in map(int, args.vars.split(",")):
+                for branching in map(float, args.branching.split(",")):
+                    for seed in range(args.seeds):
+                        config = "L%d_V%d_B%g_S%d" % (lines, num_vars, branching, seed)
+                        facts = os.path.join(work, "facts", config)
+                        gen_cfg.Program(lines, num_vars, branching, seed).generate().write(facts)
+
+                        for analysis in analyses:
+                            for variant, (directory, program, includes) in ANALYSES[analysis].items():
+                                for mode in modes:
+                                    name = "%s_%s_%s" % (analysis, variant, mode)
+                                    output = os.path.join(work, "out", config, name)
+                                    os.makedirs(output, exist_ok=True)
+                                    profile = output + ".log"
+                                    if mode == "interpreter":
+                                        cmd = [args.souffle, program, "-j", str(args.jobs)]
+                                        cmd += ["-I" + include for include in includes]
+                                    else:
+                                        if binaries[(analysis, variant)] is None:
+                                            continue
+                                        cmd = [binaries[(analysis, variant)], "-j", str(args.jobs)]
+                                    cmd += ["-F", facts, "-D", output, "-p", profile]
+
+                                    status, wall, rss, stderr = run(
+                                            cmd, os.path.join(ROOT, directory), args.timeout)
+                                    iterations, tuples, outputs = "", "", ""
+                                    if status == "ok":
+                                        iterations, tuples = read_profile(profile)
+                                        outputs = count_output(output)
+                                    else:
+                                        sys.stderr.write("%s on %s: %s\n%s" % (name, config, status, stderr))
+                                    writer.writerow([analysis, variant, mode, lines, num_vars, branching,
+                                                     seed, status, "%.3f" % wall, rss, iterations, tuples,
+                                                     outputs])
+                                    report.flush()
+                                    print("%-32s %-20s %-8s %8.3fs %8d KB" % (name, config, status, wall, rss),
+                                          flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -318,6 +318,16 @@ public:
         return fixedPlan;
     }
 
+    /** Updates the flag requesting a multi-way join of the body atoms */
+    void setMultiwayJoin(bool value = true) {
+        multiwayJoin = value;
+    }
+
+    /** Determines whether the body atoms are to be joined by a multi-way join */
+    bool usesMultiwayJoin() const {
+        return multiwayJoin;
+    }
+
     /** Obtains the execution plan associated to this clause or null if there is none */
     const AstExecutionPlan* getExecutionPlan() const {
         return plan.get();
@@ -377,6 +387,7 @@ public:
             res->constraints.emplace_back(cur->clone());
         }
         res->fixedPlan = fixedPlan;
+        res->multiwayJoin = multiwayJoin;
         res->generated = generated;
         return res;
     }
@@ -447,6 +458,9 @@ protected:
     /** Determines whether the given execution order should be enforced */
     bool fixedPlan = false;
 
+    /** Determines whether the body atoms are joined by a multi-way join instead of nested loops */
+    bool multiwayJoin = false;
+
     /** The user defined execution plan -- if any */
     std::unique_ptr<AstExecutionPlan> plan;
 
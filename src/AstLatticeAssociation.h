@@ -77,9 +77,43 @@ public:
 		return glb;
 	}
 
+	/** set widening and narrowing functions, an empty name omits the operator */
+	void setWidenNarrow(const std::string& W, const std::string& N) {
+		widen = W;
+		narrow = N;
+	}
+
+	/** mark as the built-in powerset lattice, whose elements are bitsets */
+	void setPowerset() {
+		powerset = true;
+	}
+
+	bool isPowerset() const {
+		return powerset;
+	}
+
+	bool hasWiden() const {
+		return !widen.empty();
+	}
+
+	const std::string& getWiden() const {
+		return widen;
+	}
+
+	bool hasNarrow() const {
+		return !narrow.empty();
+	}
+
+	const std::string& getNarrow() const {
+		return narrow;
+	}
+
 	AstLatticeAssociation* clone() const override {
 		auto res = new AstLatticeAssociation(name);
-		res->setALL(top, bottom, lub, glb);
+		res->setALL(bottom, top, lub, glb);
+		res->setWidenNarrow(widen, narrow);
+		res->powerset = powerset;
+		res->setSrcLoc(getSrcLoc());
 		return res;
 	}
 
@@ -99,11 +133,21 @@ public:
 	}
 
 	void print(std::ostream& os) const override {
+		if (powerset) {
+			os << "Lattice Association: " << name << "<> = powerset";
+			return;
+		}
 		os << "Lattice Association: " << name << "<> = (\n";
 		os << "Bottom element: " << bottom << "\n";
 		os << "Top element: " << top << "\n";
 		os << "lub function name: " << lub << "\n";
 		os << "glb function name: " << glb << "\n";
+		if (hasWiden()) {
+			os << "widen function name: " << widen << "\n";
+		}
+		if (hasNarrow()) {
+			os << "narrow function name: " << narrow << "\n";
+		}
 		os << ")";
 	}
 
@@ -124,11 +168,21 @@ protected:
 	/** greatest lower bound **/
 	std::string glb;
 
+	/** widening operator, optional **/
+	std::string widen;
+
+	/** narrowing operator, optional **/
+	std::string narrow;
+
+	/** whether this is the built-in powerset lattice **/
+	bool powerset = false;
+
 	/** Implements the node comparison for this node type */
 	bool equal(const AstNode& node) const override {
 		assert(nullptr != dynamic_cast<const AstLatticeAssociation*>(&node));
 		const auto& other = static_cast<const AstLatticeAssociation&>(node);
-		return name==other.getName() && lub==(other.lub) && glb==(other.glb) && top==(other.top) && bottom==(other.bottom);
+		return name==other.getName() && lub==(other.lub) && glb==(other.glb) && top==(other.top) && bottom==(other.bottom)
+				&& widen==(other.widen) && narrow==(other.narrow);
 	}
 };
 }
@@ -93,8 +93,9 @@ void AstProgram::addLatticeFunction(std::unique_ptr<souffle::AstLatticeFunction>
 
 /** Set a Lattice Association to the program */
 void AstProgram::addLatticeAssociation(std::unique_ptr<souffle::AstLatticeAssociation> f) {
-	assert(latticeAssociation.get()==nullptr && "Dual definition of Lattice Association!");
-	latticeAssociation = std::move(f);
+	const std::string name = f->getName();
+	assert(latticeAssociations.find(name) == latticeAssociations.end() && "Dual definition of Lattice Association!");
+	latticeAssociations[name] = std::move(f);
 }
 
 /* Add a functor declaration to the program */
@@ -145,8 +146,30 @@ const std::map<std::string, std::unique_ptr<AstLatticeFunction>>& AstProgram::Ge
 	return latticeFunctions;
 }
 
-AstLatticeAssociation* AstProgram::getLatticeAssociation() const {
-	return latticeAssociation.get();
+AstLatticeAssociation* AstProgram::getLatticeAssociation(const std::string& name) const {
+	auto pos = latticeAssociations.find(name);
+	return pos==latticeAssociations.end() ? nullptr : pos->second.get();
+}
+
+AstLatticeAssociation* AstProgram::getLatticeAssociationOfType(const AstTypeIdentifier& type) const {
+	for (const auto& cur : latticeAssociations) {
+		// the built-in powerset lattice is associated to the type of its name
+		if (cur.second->isPowerset()) {
+			if (cur.first == toString(type)) {
+				return cur.second.get();
+			}
+			continue;
+		}
+		const auto* lub = dynamic_cast<const AstLatticeBinaryFunction*>(getLatticeFunction(cur.second->getLub()));
+		if (lub != nullptr && lub->getOutput() == toString(type)) {
+			return cur.second.get();
+		}
+	}
+	return nullptr;
+}
+
+const std::map<std::string, std::unique_ptr<AstLatticeAssociation>>& AstProgram::getLatticeAssociations() const {
+	return latticeAssociations;
 }
 
 AstFunctorDeclaration* AstProgram::getFunctorDeclaration(const std::string& name) const {
@@ -225,9 +248,11 @@ void AstProgram::print(std::ostream& os) const {
 	}
 
 	os << "\n// ----- Lattice -----\n";
-	if (getLatticeAssociation()!=nullptr) {
-		latticeAssociation->print(os);
-		os << "\n";
+	if (!latticeAssociations.empty()) {
+		for (const auto& cur : latticeAssociations) {
+			cur.second->print(os);
+			os << "\n";
+		}
 		for (const auto& cur : latticeFunctions) {
 			const std::unique_ptr<AstLatticeFunction>& f = cur.second;
 			os << "\n\n// -- " << f->getName() << " --\n";
@@ -79,8 +79,14 @@ public:
 	/** Get the whole map for lattice binary functions **/
 	const std::map<std::string, std::unique_ptr<AstLatticeFunction>>& GetMapLatticeFunction() const;
 
-	/** Get lattice association definition */
-	AstLatticeAssociation* getLatticeAssociation() const;
+	/** Get the lattice association of the given name, or nullptr */
+	AstLatticeAssociation* getLatticeAssociation(const std::string& name) const;
+
+	/** Get the lattice association whose elements are of the given type, or nullptr */
+	AstLatticeAssociation* getLatticeAssociationOfType(const AstTypeIdentifier& type) const;
+
+	/** Get all lattice associations, indexed by their names */
+	const std::map<std::string, std::unique_ptr<AstLatticeAssociation>>& getLatticeAssociations() const;
 
 	/** Get functor declaration */
 	AstFunctorDeclaration* getFunctorDeclaration(const std::string& name) const;
@@ -152,7 +158,9 @@ public:
 		for (const auto& cur : types) {
 			res.push_back(cur.second.get());
 		}
-		res.push_back(latticeAssociation.get());
+		for (const auto& cur : latticeAssociations) {
+			res.push_back(cur.second.get());
+		}
 		for (const auto& cur : latticeFunctions) {
 			res.push_back(cur.second.get());
 		}
@@ -198,7 +206,7 @@ protected:
 		}
 
 		// check lattice
-		if (latticeAssociation.get() != other.latticeAssociation.get()) {
+		if (latticeAssociations.size() != other.latticeAssociations.size()) {
 			return false;
 		}
 		//TODO
@@ -257,8 +265,8 @@ private:
 	/** Program types  */
 	std::map<AstTypeIdentifier, std::unique_ptr<AstType>> types;
 
-	/** Lattice */
-	std::unique_ptr<AstLatticeAssociation> latticeAssociation;
+	/** Lattice associations, one per lattice type */
+	std::map<std::string, std::unique_ptr<AstLatticeAssociation>> latticeAssociations;
 	std::map<std::string, std::unique_ptr<AstLatticeFunction>> latticeFunctions;
 
 	/** Program relations */
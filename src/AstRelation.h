@@ -59,6 +59,9 @@
 /* Relation uses a union relation */
 #define EQREL_RELATION (0x100)
 
+/* Relation uses hash indices for equality searches */
+#define HASH_RELATION (0x200)
+
 /* Relation warnings are suppressed */
 #define SUPPRESSED_RELATION (0x800)
 
@@ -136,6 +139,8 @@ public:
             representation = RelationRepresentation::BRIE;
         } else if (q & BTREE_RELATION) {
             representation = RelationRepresentation::BTREE;
+        } else if (q & HASH_RELATION) {
+            representation = RelationRepresentation::HASH;
         }
 
         if (q & INPUT_RELATION) {
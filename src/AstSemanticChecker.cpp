@@ -21,6 +21,8 @@
 #include "AstFunctorDeclaration.h"
 #include "AstGroundAnalysis.h"
 #include "AstIO.h"
+#include "AstLatticeAssociation.h"
+#include "AstLatticeFunction.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
 #include "AstProgram.h"
@@ -112,6 +114,7 @@ void AstSemanticChecker::checkProgram(ErrorReport& report,
 	checkTypes(report, program);
 	checkRules(report, typeEnv, program, recursiveClauses, ioTypes);
 	checkNamespaces(report, program);
+	checkLatticeAssociation(report, typeEnv, program);
 	checkIODirectives(report, program);
 	checkWitnessProblem(report, program);
 	checkInlining(report, program, precedenceGraph, ioTypes);
@@ -637,23 +640,34 @@ void AstSemanticChecker::checkRelationDeclaration(ErrorReport& report,
 					attr->getSrcLoc());
 		}
 
-		/* added by Qing Gong: if it is lattice relation, the last
-		 * variable should be enum, and other variables are not. */
+		/* a lattice relation ends in one or more lattice columns, i.e. enum
+		 * columns or columns of a powerset type, each of which is joined by
+		 * the lattice association of its type; the columns before them form
+		 * the key and cannot be enum. */
 		if (relation.isLattice()) {
-			if (i == relation.getArity() - 1) {
-				// last variable
-				if (!isEnumType(typeEnv.getType(typeName))) {
-					report.addError(
-							"Last variable must be Enum for lattice relation",
-							attr->getSrcLoc());
-				}
-			} else {
-				// not the last variable
-				if (isEnumType(typeEnv.getType(typeName))) {
+			auto isLatticeType = [&](const AstTypeIdentifier& type) {
+				const AstLatticeAssociation* assoc =
+						program.getLatticeAssociationOfType(type);
+				return isEnumType(typeEnv.getType(type))
+						|| (assoc != nullptr && assoc->isPowerset());
+			};
+			if (isLatticeType(typeName)) {
+				if (program.getLatticeAssociationOfType(typeName) == nullptr) {
 					report.addError(
-							"Variables other than the last one cannot be Enum for lattice relation",
+							"No lattice association defined for type "
+									+ toString(typeName),
 							attr->getSrcLoc());
 				}
+			} else if (i == relation.getArity() - 1) {
+				report.addError(
+						"Last variable must be Enum or powerset for lattice relation",
+						attr->getSrcLoc());
+			} else if (i > 0
+					&& isLatticeType(
+							relation.getAttribute(i - 1)->getTypeName())) {
+				report.addError(
+						"Lattice variables of a lattice relation must be trailing",
+						attr->getSrcLoc());
 			}
 
 		} else {
@@ -1401,6 +1415,42 @@ void AstSemanticChecker::checkNamespaces(ErrorReport& report,
 	}
 }
 
+// Check that the functions of the lattice associations are binary lattice functions
+void AstSemanticChecker::checkLatticeAssociation(ErrorReport& report,
+		const TypeEnvironment& typeEnv, const AstProgram& program) {
+	for (const auto& cur : program.getLatticeAssociations()) {
+		const AstLatticeAssociation* assoc = cur.second.get();
+
+		// the built-in powerset lattice ranges over bitsets of a numeric type
+		if (assoc->isPowerset()) {
+			if (!typeEnv.isType(assoc->getName())
+					|| !isNumberType(typeEnv.getType(assoc->getName()))) {
+				report.addError("Powerset lattice association "
+						+ assoc->getName() + " requires a numeric type of the same name",
+						assoc->getSrcLoc());
+			}
+			continue;
+		}
+
+		std::vector<std::pair<std::string, std::string>> functions = {
+				{ "lub", assoc->getLub() }, { "glb", assoc->getGlb() } };
+		if (assoc->hasWiden()) {
+			functions.emplace_back("widen", assoc->getWiden());
+		}
+		if (assoc->hasNarrow()) {
+			functions.emplace_back("narrow", assoc->getNarrow());
+		}
+		for (const auto& fun : functions) {
+			const AstLatticeFunction* func = program.getLatticeFunction(fun.second);
+			if (dynamic_cast<const AstLatticeBinaryFunction*>(func) == nullptr) {
+				report.addError("Undefined binary lattice function " + fun.second
+						+ " used as " + fun.first + " of lattice association "
+						+ assoc->getName(), assoc->getSrcLoc());
+			}
+		}
+	}
+}
+
 bool AstExecutionPlanChecker::transform(AstTranslationUnit& translationUnit) {
 	auto* relationSchedule = translationUnit.getAnalysis<RelationSchedule>();
 	auto* recursiveClauses = translationUnit.getAnalysis<RecursiveClauses>();
@@ -76,6 +76,8 @@ private:
     static void checkTypes(ErrorReport& report, const AstProgram& program);
 
     static void checkNamespaces(ErrorReport& report, const AstProgram& program);
+    static void checkLatticeAssociation(
+            ErrorReport& report, const TypeEnvironment& typeEnv, const AstProgram& program);
     static void checkIODirectives(ErrorReport& report, const AstProgram& program);
     static void checkWitnessProblem(ErrorReport& report, const AstProgram& program);
     static void checkInlining(ErrorReport& report, const AstProgram& program,
@@ -83,9 +83,23 @@ std::unique_ptr<RamElementAccess> AstTranslator::makeRamElementAccess(
 std::unique_ptr<RamLatticeGLB> AstTranslator::makeRamLatticeGLB(
 		const std::set<Location>& locs) {
 	auto res = std::make_unique<RamLatticeGLB>();
-	for (const auto& loc : locs) {
+	// the first reference is a lattice column, whose association gives the glb;
+	// the elements of unpacked records have no relation
+	auto addRef = [&](const Location& loc) {
 		res->addRef(loc.identifier, loc.element,
-				std::unique_ptr<RamRelationReference>(loc.relation->clone()));
+				loc.relation == nullptr ?
+						nullptr :
+						std::unique_ptr<RamRelationReference>(
+								loc.relation->clone()));
+	};
+	auto lattice = std::find_if(locs.begin(), locs.end(),
+			[](const Location& loc) {return ValueIndex::isLatticeElement(loc);});
+	assert(lattice != locs.end() && "no lattice column referenced");
+	addRef(*lattice);
+	for (const auto& loc : locs) {
+		if (loc != *lattice) {
+			addRef(loc);
+		}
 	}
 	return std::move(res);
 }
@@ -148,6 +162,14 @@ void AstTranslator::makeIODirective(IODirectives& ioDirective,
 				&& ioDirective.getFileName().front() != '/') {
 			ioDirective.setFileName(filePath + "/" + ioDirective.getFileName());
 		}
+	} else if (ioDirective.getIOType() == "binary") {
+		// binary files are named after the relation by default and found in the same directories
+		if (!ioDirective.has("filename")) {
+			ioDirective.setFileName(ioDirective.getRelationName() + ".bin");
+		}
+		if (ioDirective.getFileName().front() != '/') {
+			ioDirective.setFileName(filePath + "/" + ioDirective.getFileName());
+		}
 	}
 }
 
@@ -253,13 +275,14 @@ std::unique_ptr<RamRelationReference> AstTranslator::createRelationReference(
 		const std::vector<std::string> attributeNames,
 		const std::vector<std::string> attributeTypeQualifiers,
 		const SymbolMask mask, const EnumTypeMask enumTypeMask,
-		const RelationRepresentation representation, const bool latticeFlag) {
+		const RelationRepresentation representation, const bool latticeFlag,
+		const std::vector<std::string> latticeAssociations) {
 	const RamRelation* ramRel = ramProg->getRelation(name);
 	if (ramRel == nullptr) {
 		ramProg->addRelation(
 				std::make_unique<RamRelation>(name, arity, attributeNames,
 						attributeTypeQualifiers, mask, enumTypeMask,
-						representation, latticeFlag));
+						representation, latticeFlag, latticeAssociations));
 		ramRel = ramProg->getRelation(name);
 		assert(ramRel != nullptr && "cannot find relation");
 	}
@@ -286,6 +309,7 @@ std::unique_ptr<RamRelationReference> AstTranslator::translateRelation(
 		const AstRelation* rel, const std::string relationNamePrefix) {
 	std::vector<std::string> attributeNames;
 	std::vector<std::string> attributeTypeQualifiers;
+	std::vector<std::string> latticeAssociations;
 	for (size_t i = 0; i < rel->getArity(); ++i) {
 		attributeNames.push_back(rel->getAttribute(i)->getAttributeName());
 		if (typeEnv) {
@@ -294,13 +318,29 @@ std::unique_ptr<RamRelationReference> AstTranslator::translateRelation(
 							typeEnv->getType(
 									rel->getAttribute(i)->getTypeName())));
 		}
+
+	}
+
+	// each trailing enum or powerset column is joined by the association of its type
+	EnumTypeMask enumTypeMask = getEnumTypeMask(*rel);
+	if (rel->isLattice()) {
+		for (size_t i = rel->getArity(); i > 0; --i) {
+			const auto* assoc = program->getLatticeAssociationOfType(
+					rel->getAttribute(i - 1)->getTypeName());
+			if (assoc == nullptr
+					|| !(enumTypeMask.isEnumType(i - 1) || assoc->isPowerset())) {
+				break;
+			}
+			latticeAssociations.insert(latticeAssociations.begin(),
+					assoc->getName());
+		}
 	}
 
 	return createRelationReference(
 			relationNamePrefix + getRelationName(rel->getName()),
 			rel->getArity(), attributeNames, attributeTypeQualifiers,
-			getSymbolMask(*rel), getEnumTypeMask(*rel),
-			rel->getRepresentation(), rel->isLattice());
+			getSymbolMask(*rel), enumTypeMask,
+			rel->getRepresentation(), rel->isLattice(), latticeAssociations);
 }
 
 std::unique_ptr<RamRelationReference> AstTranslator::translateDeltaRelation(
@@ -313,16 +353,6 @@ std::unique_ptr<RamRelationReference> AstTranslator::translateNewRelation(
 	return translateRelation(rel, "@new_");
 }
 
-std::unique_ptr<RamRelationReference> AstTranslator::translateLatTempRelation(
-		const AstRelation* rel) {
-	return translateRelation(rel, "@lat_temp_");
-}
-
-std::unique_ptr<RamRelationReference> AstTranslator::translateOrgLatRelation(
-		const AstRelation* rel) {
-	return translateRelation(rel, "@org_lat_");
-}
-
 std::unique_ptr<RamRelationReference> AstTranslator::translateNewLatRelation(
 		const AstRelation* rel) {
 	return translateRelation(rel, "@new_lat_");
@@ -355,8 +385,8 @@ std::unique_ptr<RamValue> AstTranslator::translateValue(const AstArgument* arg,
 
 			/* Normal case */
 			assert(index.isDefined(var) && "variable not grounded");
-			if (index.isArgEnum(index.getDefinitionPoint(var),
-					translator.typeEnv)) {
+			if (index.isLatticeVariable(
+					index.getVariableReferences().at(var.getName()))) {
 //				std::cout << "Enum type detected! all loc size:"
 //						<< index.getVariableReferences().at(var.getName()).size()
 //						<< "\n";
@@ -612,7 +642,27 @@ std::unique_ptr<RamCondition> AstTranslator::translateConstraint(
 }
 
 std::unique_ptr<RamLatticeAssociation> AstTranslator::translateLatticeAssoc(
-		const AstTranslationUnit& tu) {
+		const AstTranslationUnit& tu,
+		const AstLatticeAssociation* AstLatAssoc) {
+
+	// the built-in powerset lattice joins bitsets by union and meets them by
+	// intersection, from the empty set up to the full set
+	if (AstLatAssoc->isPowerset()) {
+		auto bitwise = [](FunctorOp op) {
+			auto res = std::make_shared<RamLatticeBinaryFunction>();
+			res->addCase(nullptr,
+					std::make_unique<RamIntrinsicOperator>(op,
+							std::make_unique<RamArgument>(0),
+							std::make_unique<RamArgument>(1)));
+			return res;
+		};
+		auto RamLat = std::make_unique<RamLatticeAssociation>();
+		RamLat->setPowerset();
+		RamLat->setLUB(bitwise(FunctorOp::BOR));
+		RamLat->setGLB(bitwise(FunctorOp::BAND));
+		RamLat->setBotTop(0, RamLatticeAssociation::getPowersetTop());
+		return RamLat;
+	}
 
 	// Translate ast lbf into ram lbf
 //	class LatticeBinarytranslator {
@@ -690,10 +740,6 @@ std::unique_ptr<RamLatticeAssociation> AstTranslator::translateLatticeAssoc(
 //		}
 //	};
 
-	const AstLatticeAssociation* AstLatAssoc = program->getLatticeAssociation();
-	if (AstLatAssoc == nullptr)
-		return nullptr;
-
 	const AstLatticeBinaryFunction* AstLUB =
 			static_cast<const AstLatticeBinaryFunction*>(program->getLatticeFunction(
 					AstLatAssoc->getLub()));
@@ -713,6 +759,22 @@ std::unique_ptr<RamLatticeAssociation> AstTranslator::translateLatticeAssoc(
 	RamLat->setLUB(std::move(translateLatticeBinaryFunction(AstLUB)));
 	RamLat->setGLB(std::move(translateLatticeBinaryFunction(AstGLB)));
 
+	// optional operators bounding the length of ascending and descending chains
+	if (AstLatAssoc->hasWiden()) {
+		const AstLatticeBinaryFunction* AstWiden =
+				static_cast<const AstLatticeBinaryFunction*>(program->getLatticeFunction(
+						AstLatAssoc->getWiden()));
+		assert(AstWiden != nullptr);
+		RamLat->setWiden(translateLatticeBinaryFunction(AstWiden));
+	}
+	if (AstLatAssoc->hasNarrow()) {
+		const AstLatticeBinaryFunction* AstNarrow =
+				static_cast<const AstLatticeBinaryFunction*>(program->getLatticeFunction(
+						AstLatAssoc->getNarrow()));
+		assert(AstNarrow != nullptr);
+		RamLat->setNarrow(translateLatticeBinaryFunction(AstNarrow));
+	}
+
 	const SymbolTable& symTab = tu.getSymbolTable();
 	assert(symTab.exist(AstLatAssoc->getBottom()));
 	RamDomain bot = symTab.lookupExisting(AstLatAssoc->getBottom());
@@ -954,6 +1016,123 @@ void AstTranslator::ClauseTranslator::createValueIndex(
 			aggregators.push_back(&cur);});
 }
 
+/**
+ * join the atoms of a clause by one intersection per variable, or return null if
+ * the atoms have arguments other than variables or a variable is not bound by them
+ */
+std::unique_ptr<RamOperation> AstTranslator::ClauseTranslator::createMultiwayJoin(
+		const AstClause& clause, const AstClause& originalClause,
+		const int version) {
+	// order the variables by their first appearance in the atoms
+	std::vector<const AstVariable*> variables;
+	std::map<std::string, size_t> varLevel;
+	for (const AstAtom* atom : clause.getAtoms()) {
+		for (const AstArgument* arg : atom->getArguments()) {
+			if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+				if (varLevel.insert(std::make_pair(var->getName(), variables.size())).second) {
+					variables.push_back(var);
+				}
+			} else if (dynamic_cast<const AstUnnamedVariable*>(arg) == nullptr) {
+				return nullptr;
+			}
+		}
+	}
+	bool bound = true;
+	visitDepthFirst(clause, [&](const AstVariable& var) {
+		if (varLevel.count(var.getName()) == 0) {
+			bound = false;
+		}
+	});
+	visitDepthFirst(clause, [&](const AstAggregator&) {
+		bound = false;
+	});
+	if (!bound) {
+		return nullptr;
+	}
+
+	// each variable is the only element of the tuple of its level
+	for (const AstVariable* var : variables) {
+		valueIndex.addVarReference(*var, varLevel[var->getName()], 0);
+	}
+
+	std::unique_ptr<RamOperation> op = createOperation(clause);
+
+	/* add conditions caused by negations and binary relations */
+	for (const auto& lit : clause.getBodyLiterals()) {
+		if (auto condition = translator.translateConstraint(lit, valueIndex)) {
+			op = std::make_unique<RamFilter>(std::move(condition),
+					std::move(op));
+		}
+	}
+
+	// intersect the atoms of each variable, bound by the variables of the outer
+	// levels; an atom without bound variables only restricts a level to all the
+	// values of a column, so it is left to the levels of its other variables
+	// unless no other atom is bound
+	for (size_t level = variables.size(); level-- > 0;) {
+		std::vector<std::unique_ptr<RamRelationReference>> relations;
+		std::vector<std::vector<std::unique_ptr<RamValue>>> patterns;
+		std::vector<size_t> columns;
+		std::stringstream atoms;
+		bool bound = any_of(clause.getAtoms(), [&](const AstAtom* atom) {
+			bool contains = false;
+			bool keyed = false;
+			for (const AstArgument* arg : atom->getArguments()) {
+				if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+					contains |= varLevel[var->getName()] == level;
+					keyed |= varLevel[var->getName()] < level;
+				}
+			}
+			return contains && keyed;
+		});
+		for (const AstAtom* atom : clause.getAtoms()) {
+			std::vector<std::unique_ptr<RamValue>> pattern;
+			size_t column = atom->argSize();
+			bool keyed = false;
+			bool later = false;
+			for (size_t pos = 0; pos < atom->argSize(); ++pos) {
+				const auto* var =
+						dynamic_cast<const AstVariable*>(atom->getArgument(pos));
+				if (var != nullptr && varLevel[var->getName()] < level) {
+					pattern.push_back(
+							std::make_unique<RamElementAccess>(
+									varLevel[var->getName()], 0));
+					keyed = true;
+				} else {
+					if (var != nullptr && varLevel[var->getName()] == level) {
+						column = pos;
+					}
+					later |= var != nullptr && varLevel[var->getName()] > level;
+					pattern.push_back(nullptr);
+				}
+			}
+			if (column < atom->argSize() && (keyed || !later || !bound)) {
+				relations.push_back(translator.translateRelation(atom));
+				patterns.push_back(std::move(pattern));
+				columns.push_back(column);
+				atoms << (columns.size() > 1 ? "," : "") << *atom;
+			}
+		}
+
+		std::string profileText;
+		if (Global::config().has("profile")) {
+			std::stringstream ss;
+			ss << "@frequency-atom" << ';';
+			ss << originalClause.getHead()->getName() << ';';
+			ss << version << ';';
+			ss << stringify(toString(clause)) << ';';
+			ss << stringify(atoms.str()) << ';';
+			ss << stringify(toString(originalClause)) << ';';
+			ss << level << ';';
+			profileText = ss.str();
+		}
+		op = std::make_unique<RamIntersect>(std::move(relations),
+				std::move(patterns), std::move(columns), level, std::move(op),
+				profileText);
+	}
+	return op;
+}
+
 /** begin with projection */
 std::unique_ptr<RamOperation> AstTranslator::ClauseTranslator::createOperation(
 		const AstClause& clause) {
@@ -1084,6 +1263,14 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
 	// the rest should be rules
 	assert(clause.isRule());
 
+	// join the atoms of cyclic rules variable by variable
+	if (clause.usesMultiwayJoin()) {
+		if (auto op = createMultiwayJoin(clause, originalClause, version)) {
+			return std::make_unique<RamInsert>(std::move(op),
+					createCondition(originalClause));
+		}
+	}
+
 	createValueIndex(clause);
 
 	// -- create RAM statement --
@@ -1095,8 +1282,8 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
 		// the first appearance
 		const Location& first = *cur.second.begin();
 
-		// if it's a lattice enum type, skip it
-		if (valueIndex.isArgEnum(first, this->translator.typeEnv))
+		// lattice elements are met by the glb instead, skip them
+		if (valueIndex.isLatticeVariable(cur.second))
 			continue;
 
 		// all other appearances
@@ -1336,9 +1523,6 @@ std::unique_ptr<RamStatement> AstTranslator::translateNonRecursiveRelation(
 
 	// the ram table reference
 	std::unique_ptr<RamRelationReference> rrel = translateRelation(&rel);
-	// mappings for temporary relations
-	std::unique_ptr<RamRelationReference> rrel_temp = translateLatTempRelation(
-			&rel);
 
 	/* iterate over all clauses that belong to the relation */
 	for (AstClause* clause : rel.getClauses()) {
@@ -1379,33 +1563,8 @@ std::unique_ptr<RamStatement> AstTranslator::translateNonRecursiveRelation(
 		appendStmt(res, std::move(rule));
 	}
 
-	// added by Qing Gong: consider lattice for non-recursive relations
-	if (res && rel.isLattice()) {
-		// Run only if there are non-recursive rules
-		// added by Qing Gong
-		// if this is lattice relation with lattice, need to normalize it.
-		appendStmt(res,
-				std::make_unique<RamCreate>(
-						std::unique_ptr<RamRelationReference>(
-								rrel_temp->clone())));
-
-		appendStmt(res,
-				std::make_unique<RamLatNorm>(
-						std::unique_ptr<RamRelationReference>(rrel->clone()),
-						std::unique_ptr<RamRelationReference>(
-								rrel_temp->clone())));
-		// add swaps for them
-		appendStmt(res,
-				std::make_unique<RamSwap>(
-						std::unique_ptr<RamRelationReference>(rrel->clone()),
-						std::unique_ptr<RamRelationReference>(
-								rrel_temp->clone())));
-		// add drop
-		appendStmt(res,
-				std::make_unique<RamDrop>(
-						std::unique_ptr<RamRelationReference>(
-								rrel_temp->clone())));
-	}
+	// lattice relations join the lattice elements of a cell on insertion,
+	// hence no normalisation is required after the non-recursive rules
 
 	// add logging for entire relation
 	if (Global::config().has("profile")) {
@@ -1472,13 +1631,14 @@ void AstTranslator::nameUnnamedVariables(AstClause* clause) {
 /** generate RAM code for recursive relations in a strongly-connected component */
 std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 		const std::set<const AstRelation*>& scc,
-		const RecursiveClauses* recursiveClauses) {
+		const RecursiveClauses* recursiveClauses,
+		const std::set<const AstRelation*>& inputs) {
 	// initialize sections
 	std::unique_ptr<RamStatement> preamble;
 	std::unique_ptr<RamSequence> updateTable(new RamSequence());
 	std::unique_ptr<RamStatement> postamble;
 
-	// added by Qing Gong: clean the "new" relations in the loop, between updateTable and Exit
+	// added by Qing Gong: merge the "new" relations in the loop, between updateTable and Exit
 	std::unique_ptr<RamStatement> beforeExit;
 
 	// --- create preamble ---
@@ -1489,7 +1649,6 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 	std::map<const AstRelation*, std::unique_ptr<RamRelationReference>> relNew;
 
 	// extra mappings for lattice relations
-	std::map<const AstRelation*, std::unique_ptr<RamRelationReference>> rrel_lat;
 	std::map<const AstRelation*, std::unique_ptr<RamRelationReference>> relNew_lat;
 
 	/* Compute non-recursive clauses for relations in scc and push
@@ -1502,7 +1661,6 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 		relDelta[rel] = translateDeltaRelation(rel);
 		relNew[rel] = translateNewRelation(rel);
 		if (rrel[rel]->isLattice()) {
-			rrel_lat[rel] = translateOrgLatRelation(rel);
 			relNew_lat[rel] = translateNewLatRelation(rel);
 		}
 
@@ -1536,13 +1694,16 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 //							std::unique_ptr<RamRelationReference>(
 //									relNew_lat[rel]->clone())));
 //		} else {
-		/* create update statements for fixpoint (even iteration) */
-		appendStmt(updateRelTable,
-				std::make_unique<RamMerge>(
-						std::unique_ptr<RamRelationReference>(
-								rrel[rel]->clone()),
-						std::unique_ptr<RamRelationReference>(
-								relNew[rel]->clone())));
+		/* create update statements for fixpoint (even iteration); lattice
+		 * relations have already been merged by LatMerge */
+		if (!rrel[rel]->isLattice()) {
+			appendStmt(updateRelTable,
+					std::make_unique<RamMerge>(
+							std::unique_ptr<RamRelationReference>(
+									rrel[rel]->clone()),
+							std::unique_ptr<RamRelationReference>(
+									relNew[rel]->clone())));
+		}
 //		}
 
 		appendStmt(updateRelTable,
@@ -1579,23 +1740,6 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 							relNew[rel]->clone()));
 		}
 
-		// Plan B: latnorm the lattice relation in postamble
-		if (rel->isLattice()) {
-			appendStmt(postamble,
-					std::make_unique<RamLatNorm>(
-							std::unique_ptr<RamRelationReference>(
-									rrel[rel]->clone()),
-							std::unique_ptr<RamRelationReference>(
-									rrel_lat[rel]->clone())));
-			// add swaps for them
-			appendStmt(postamble,
-					std::make_unique<RamSwap>(
-							std::unique_ptr<RamRelationReference>(
-									rrel[rel]->clone()),
-							std::unique_ptr<RamRelationReference>(
-									rrel_lat[rel]->clone())));
-		}
-
 		/* drop temporary tables after recursion */
 		appendStmt(postamble,
 				std::make_unique<RamSequence>(
@@ -1609,13 +1753,9 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 		// added by Qing Gong: drop temporary lattice relations
 		if (rel->isLattice()) {
 			appendStmt(postamble,
-					std::make_unique<RamSequence>(
-							std::make_unique<RamDrop>(
-									std::unique_ptr<RamRelationReference>(
-											rrel_lat[rel]->clone())),
-							std::make_unique<RamDrop>(
-									std::unique_ptr<RamRelationReference>(
-											relNew_lat[rel]->clone()))));
+					std::make_unique<RamDrop>(
+							std::unique_ptr<RamRelationReference>(
+									relNew_lat[rel]->clone())));
 		}
 
 		/* Generate code for non-recursive part of relation */
@@ -1634,11 +1774,12 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 		updateTable->add(std::move(updateRelTable));
 	}
 
-	// Plan B by Qing Gong: clean the "new" relations in the loop, between updateTable and Exit
+	// Plan B by Qing Gong: merge the "new" relations in the loop, between updateTable and Exit,
+	// so that only cells whose lattice element moved up remain in the "new" relations
 	for (const AstRelation* rel : scc) {
 		if (rrel[rel]->isLattice()) {
 			appendStmt(beforeExit,
-					std::make_unique<RamLatClean>(
+					std::make_unique<RamLatMerge>(
 							std::unique_ptr<RamRelationReference>(
 									rrel[rel]->clone()),
 							std::unique_ptr<RamRelationReference>(
@@ -1655,6 +1796,17 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 					std::make_unique<RamClear>(
 							std::unique_ptr<RamRelationReference>(
 									relNew_lat[rel]->clone())));
+
+			/* count the cells which moved up in each iteration */
+			if (Global::config().has("profile")) {
+				appendStmt(beforeExit,
+						std::make_unique<RamLogSize>(
+								std::unique_ptr<RamRelationReference>(
+										relNew[rel]->clone()),
+								LogStatement::nLatticeRelation(
+										toString(rel->getName()),
+										rel->getSrcLoc())));
+			}
 		}
 	}
 
@@ -1824,6 +1976,102 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
 		}
 
 	}
+
+	// --- build narrowing loop ---
+
+	/* after the ascending fixpoint (possibly accelerated by widening), all clauses
+	 * of the lattice relations are re-evaluated over the full relations and each
+	 * cell is narrowed by the element recomputed for it, until no cell moves down;
+	 * relations loaded from input are left alone as their facts are not re-derived */
+	// relations with at least one lattice column whose association narrows
+	auto isNarrowed = [&](const AstRelation* rel) {
+		const RamRelationReference& ref = *rrel[rel];
+		for (size_t i = ref.getArity() - ref.getLatticeArity();
+				i < ref.getArity(); i++) {
+			if (program->getLatticeAssociation(ref.getLatticeAssociation(i))->hasNarrow()) {
+				return true;
+			}
+		}
+		return false;
+	};
+	{
+		std::unique_ptr<RamParallel> narrowSeq(new RamParallel());
+		std::unique_ptr<RamStatement> narrowExit;
+		std::unique_ptr<RamCondition> narrowCond;
+		std::unique_ptr<RamSequence> narrowUpdate(new RamSequence());
+		for (const AstRelation* rel : scc) {
+			if (!rrel[rel]->isLattice() || inputs.count(rel) > 0
+					|| !isNarrowed(rel)) {
+				continue;
+			}
+			std::unique_ptr<RamStatement> narrowRelSeq;
+			for (size_t i = 0; i < rel->clauseSize(); i++) {
+				AstClause* cl = rel->getClause(i);
+				std::unique_ptr<AstClause> r1(cl->clone());
+				r1->getHead()->setName(relNew[rel]->getName());
+				nameUnnamedVariables(r1.get());
+				std::unique_ptr<RamStatement> rule =
+						ClauseTranslator(*this).translateClause(*r1, *cl);
+
+				// add debug info
+				std::ostringstream ds;
+				ds << toString(*cl) << "\nin file ";
+				ds << cl->getSrcLoc();
+				appendStmt(narrowRelSeq,
+						std::make_unique<RamDebugInfo>(std::move(rule),
+								ds.str()));
+			}
+			if (!narrowRelSeq) {
+				continue;
+			}
+			narrowSeq->add(std::move(narrowRelSeq));
+
+			appendStmt(narrowExit,
+					std::make_unique<RamLatNarrow>(
+							std::unique_ptr<RamRelationReference>(
+									rrel[rel]->clone()),
+							std::unique_ptr<RamRelationReference>(
+									relNew[rel]->clone()),
+							std::unique_ptr<RamRelationReference>(
+									relNew_lat[rel]->clone())));
+			appendStmt(narrowExit,
+					std::make_unique<RamSwap>(
+							std::unique_ptr<RamRelationReference>(
+									relNew[rel]->clone()),
+							std::unique_ptr<RamRelationReference>(
+									relNew_lat[rel]->clone())));
+			appendStmt(narrowExit,
+					std::make_unique<RamClear>(
+							std::unique_ptr<RamRelationReference>(
+									relNew_lat[rel]->clone())));
+			if (Global::config().has("profile")) {
+				appendStmt(narrowExit,
+						std::make_unique<RamLogSize>(
+								std::unique_ptr<RamRelationReference>(
+										relNew[rel]->clone()),
+								LogStatement::nNarrowingRelation(
+										toString(rel->getName()),
+										rel->getSrcLoc())));
+			}
+
+			addCondition(narrowCond,
+					std::make_unique<RamEmptinessCheck>(
+							std::unique_ptr<RamRelationReference>(
+									relNew[rel]->clone())));
+			narrowUpdate->add(
+					std::make_unique<RamClear>(
+							std::unique_ptr<RamRelationReference>(
+									relNew[rel]->clone())));
+		}
+		if (!narrowSeq->getStatements().empty()) {
+			appendStmt(res,
+					std::make_unique<RamLoop>(std::move(narrowSeq),
+							std::move(narrowExit),
+							std::make_unique<RamExit>(std::move(narrowCond)),
+							std::move(narrowUpdate)));
+		}
+	}
+
 	if (postamble) {
 		appendStmt(res, std::move(postamble));
 	}
@@ -2031,11 +2279,6 @@ void AstTranslator::translateProgram(
 										translateNewRelation(relation))));
 
 				if (relation->isLattice()) {
-					appendStmt(current,
-							std::make_unique<RamCreate>(
-									std::unique_ptr<RamRelationReference>(
-											translateOrgLatRelation(
-													relation))));
 					appendStmt(current,
 							std::make_unique<RamCreate>(
 									std::unique_ptr<RamRelationReference>(
@@ -2085,7 +2328,7 @@ void AstTranslator::translateProgram(
 								*((const AstRelation*) *allInterns.begin()),
 								recursiveClauses) :
 						translateRecursiveRelation(allInterns,
-								recursiveClauses);
+								recursiveClauses, internIns);
 		appendStmt(current, std::move(bodyStatement));
 #ifdef USE_MPI
 		// note that the order of sends is first by relation then second destination
@@ -2234,8 +2477,11 @@ void AstTranslator::translateProgram(
 				});
 	}
 
-	// add lattice association into ram program
-	ramProg->setLattice(translateLatticeAssoc(translationUnit));
+	// add lattice associations into ram program
+	for (const auto& cur : program->getLatticeAssociations()) {
+		ramProg->addLattice(cur.first,
+				translateLatticeAssoc(translationUnit, cur.second.get()));
+	}
 }
 
 std::unique_ptr<RamTranslationUnit> AstTranslator::translateUnit(
@@ -42,6 +42,7 @@ namespace souffle {
 // forward declarations
 class AstAtom;
 class AstClause;
+class AstLatticeAssociation;
 class AstLiteral;
 class AstProgram;
 class AstRelation;
@@ -201,19 +202,22 @@ private:
 			return *pos->second.begin();
 		}
 
-		const bool isArgEnum(const Location& loc,
-				const TypeEnvironment* typeEnv) const {
-			//const Location& loc = getDefinitionPoint(var);
-			auto rel = loc.relation->getRelation();
-			const std::string& argTypeQualifier = rel->getArgTypeQualifier(
-					loc.element);
-			size_t start = 1 + argTypeQualifier.find(":");
-			size_t i = start;
-			while (std::isalnum(argTypeQualifier[i])) {
-				i++;
+		/** Check whether a location refers to a lattice column of a lattice relation;
+		 * the elements of unpacked records and intersections have no relation */
+		static bool isLatticeElement(const Location& loc) {
+			if (loc.relation == nullptr) {
+				return false;
 			}
-			std::string ident = argTypeQualifier.substr(start, i - start);
-			return isEnumType(typeEnv->getType(ident));
+			const RamRelation* rel = loc.relation->getRelation();
+			return rel->isLattice()
+					&& loc.element + rel->getLatticeArity() >= rel->getArity();
+		}
+
+		/** Check whether some appearance of a variable is a lattice column, such
+		 * that all of its appearances are met by the glb instead of being equal */
+		static bool isLatticeVariable(const std::set<Location>& locs) {
+			return any_of(locs,
+					[](const Location& loc) {return isLatticeElement(loc);});
 		}
 
 		const variable_reference_map& getVariableReferences() const {
@@ -371,7 +375,7 @@ private:
 			const std::vector<std::string> attributeTypeQualifiers,
 			const SymbolMask mask, const EnumTypeMask enumTypeMask,
 			const RelationRepresentation structure, const bool latticeFlag =
-					false);
+					false, const std::vector<std::string> latticeAssociations = { });
 
 	/** create a reference to a RAM relation */
 	std::unique_ptr<RamRelationReference> createRelationReference(
@@ -389,18 +393,10 @@ private:
 	std::unique_ptr<RamRelationReference> translateDeltaRelation(
 			const AstRelation* rel);
 
-	/** (Non-recursive relation) translate a temporary lattice relation to a RAM relation for semi-naive evaluation */
-	std::unique_ptr<RamRelationReference> translateLatTempRelation(
-			const AstRelation* rel);
-
 	/** translate a temporary `new` relation to a RAM relation for semi-naive evaluation */
 	std::unique_ptr<RamRelationReference> translateNewRelation(
 			const AstRelation* rel);
 
-	/** added by Qing Gong: translate a temporary `org_lat` relation that stores only top lattice element */
-	std::unique_ptr<RamRelationReference> translateOrgLatRelation(
-			const AstRelation* rel);
-
 	/** added by Qing Gong: translate a temporary `new_lat` relation  that stores only top lattice element */
 	std::unique_ptr<RamRelationReference> translateNewLatRelation(
 			const AstRelation* rel);
@@ -415,7 +411,8 @@ private:
 
 	/** translate an AST lattice association with lattice binary functions into a RAM lattice **/
 	std::unique_ptr<RamLatticeAssociation> translateLatticeAssoc(
-			const AstTranslationUnit& tu);
+			const AstTranslationUnit& tu,
+			const AstLatticeAssociation* AstLatAssoc);
 
 	/** translate an AST lattice Unary Function declaration into a RAM LUF **/
 	std::unique_ptr<RamLatticeUnaryFunction> translateLatticeUnaryFunction(
@@ -448,6 +445,10 @@ private:
 
 		void createValueIndex(const AstClause& clause);
 
+		std::unique_ptr<RamOperation> createMultiwayJoin(
+				const AstClause& clause, const AstClause& originalClause,
+				const int version);
+
 	protected:
 		AstTranslator& translator;
 
@@ -492,10 +493,15 @@ private:
 	std::unique_ptr<RamStatement> translateNonRecursiveRelation(
 			const AstRelation& rel, const RecursiveClauses* recursiveClauses);
 
-	/** translate RAM code for recursive relations in a strongly-connected component */
+	/**
+	 * translate RAM code for recursive relations in a strongly-connected component;
+	 * the lattice relations of the component which are not loaded from input are
+	 * narrowed after the fixpoint if the lattice has a narrowing operator
+	 */
 	std::unique_ptr<RamStatement> translateRecursiveRelation(
 			const std::set<const AstRelation*>& scc,
-			const RecursiveClauses* recursiveClauses);
+			const RecursiveClauses* recursiveClauses,
+			const std::set<const AstRelation*>& inputs);
 
 	/** translate RAM code for subroutine to get subproofs */
 	std::unique_ptr<RamStatement> makeSubproofSubroutine(
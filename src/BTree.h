@@ -1707,6 +1707,29 @@ public:
         insert(other.begin(), other.end());
     }
 
+    /**
+     * Bulk-loads the given ordered range of elements into this tree, which
+     * has to be empty. Unlike load(), the comparators of this tree are kept.
+     *
+     * @tparam Iter .. the type of iterator specifying the range
+     *                     it must be a random-access iterator
+     */
+    template <typename Iter>
+    void loadSorted(const Iter& a, const Iter& b) {
+        assert(empty() && "bulk-load requires an empty tree");
+        if (a == b) {
+            return;
+        }
+
+        // build the tree and find its leftmost node
+        root = buildSubTree(a, b - 1);
+        node* cur = root;
+        while (!cur->isLeaf()) {
+            cur = cur->getChild(0);
+        }
+        leftmost = static_cast<leaf_node*>(cur);
+    }
+
     // Obtains an iterator referencing the first element of the tree.
     iterator begin() const {
         return iterator(leftmost, 0);
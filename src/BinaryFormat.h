@@ -0,0 +1,62 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BinaryFormat.h
+ *
+ * Layout of the files of the binary IO type. A file holds
+ *
+ *  - a BinaryHeader, followed by the symbol mask and the enum type mask
+ *    as one byte per column, padded to a multiple of 8 bytes,
+ *  - blocks of tuples, each a 64-bit number of tuples followed by the
+ *    values of the tuples column by column,
+ *  - the symbol segment at symbolOffset: a 64-bit number of symbols and
+ *    each symbol as a 64-bit length followed by its characters.
+ *
+ * Symbol columns and columns of enum types hold the position of the symbol
+ * in the symbol segment, such that files do not depend on the symbol table.
+ * Values are stored in the byte order of the machine.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace souffle {
+
+struct BinaryHeader {
+    char magic[8];
+    // the size of RamDomain, which also tells apart the byte order
+    uint32_t domainSize;
+    uint32_t arity;
+    uint64_t numTuples;
+    uint64_t symbolOffset;
+
+    static constexpr const char* MAGIC = "SOUFBIN1";
+
+    BinaryHeader(uint32_t arity = 0)
+            : domainSize(sizeof(RamDomain)), arity(arity), numTuples(0), symbolOffset(0) {
+        std::memcpy(magic, MAGIC, sizeof(magic));
+    }
+
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(magic)) == 0 && domainSize == sizeof(RamDomain);
+    }
+
+    /** Size of the masks following the header */
+    size_t getMaskSize() const {
+        return (2 * static_cast<size_t>(arity) + 7) & ~static_cast<size_t>(7);
+    }
+};
+
+}  // end of namespace souffle
@@ -376,6 +376,48 @@ public:
     }
 } recursiveRelationNumberProcessor;
 
+/**
+ * Lattice Relation Number Profile Event Processor
+ *
+ * Records the number of cells whose lattice element moved up in an iteration
+ */
+const class LatticeRelationNumberProcessor : public EventProcessor {
+public:
+    LatticeRelationNumberProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@n-lattice-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& srcLocator = signature[2];
+        size_t number = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        db.addTextEntry({"program", "relation", relation, "source-locator"}, srcLocator);
+        db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "num-changed-cells"}, number);
+    }
+} latticeRelationNumberProcessor;
+
+/**
+ * Narrowing Relation Number Profile Event Processor
+ *
+ * Records the number of cells whose lattice element moved down in a narrowing iteration
+ */
+const class NarrowingRelationNumberProcessor : public EventProcessor {
+public:
+    NarrowingRelationNumberProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@n-narrowing-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& srcLocator = signature[2];
+        size_t number = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        db.addTextEntry({"program", "relation", relation, "source-locator"}, srcLocator);
+        db.addSizeEntry({"program", "relation", relation, "narrowing", iteration, "num-changed-cells"}, number);
+    }
+} narrowingRelationNumberProcessor;
+
 /**
  * Recursive Relation Copy Timing Profile Event Processor
  */
@@ -535,6 +577,42 @@ public:
 
 } relationReadsProcessor;
 
+/**
+ * Index probes processor
+ */
+const class IndexProbesProcessor : public EventProcessor {
+public:
+    IndexProbesProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@index-probes", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& order = signature[2];
+        size_t probes = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "index", order, "probes"}, probes);
+    }
+
+} indexProbesProcessor;
+
+/**
+ * Index hits processor
+ */
+const class IndexHitsProcessor : public EventProcessor {
+public:
+    IndexHitsProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@index-hits", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& order = signature[2];
+        size_t hits = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "index", order, "hits"}, hits);
+    }
+
+} indexHitsProcessor;
+
 /**
  * Config entry processor
  */
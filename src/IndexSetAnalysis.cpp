@@ -278,6 +278,26 @@ const IndexSet::ChainOrderMap IndexSet::getChainsFromMatching(
     return chainToOrder;
 }
 
+bool IndexSet::isHashable(SearchColumns cols) const {
+    if (relation.isLattice() || relation.getRepresentation() == RelationRepresentation::EQREL) {
+        return false;
+    }
+    if (cols == 0 || card(cols) == relation.getArity() || orderedSearches.count(cols) > 0) {
+        return false;
+    }
+    // relations of the hash representation serve all remaining searches by hash indices
+    if (relation.getRepresentation() == RelationRepresentation::HASH) {
+        return true;
+    }
+    // otherwise the order of the search must not cover other searches
+    for (const auto& chain : chainToOrder) {
+        if (chain.count(cols) > 0) {
+            return chain.size() == 1;
+        }
+    }
+    return false;
+}
+
 /** Compute indexes */
 void IndexSetAnalysis::run(const RamTranslationUnit& translationUnit) {
     const auto* indexScanKeysAnalysis = translationUnit.getAnalysis<RamIndexScanKeysAnalysis>();
@@ -292,6 +312,14 @@ void IndexSetAnalysis::run(const RamTranslationUnit& translationUnit) {
         } else if (const auto* agg = dynamic_cast<const RamAggregate*>(&node)) {
             IndexSet& indexes = getIndexes(agg->getRelation());
             indexes.addSearch(agg->getRangeQueryColumns());
+        } else if (const auto* intersect = dynamic_cast<const RamIntersect*>(&node)) {
+            // seeks in the values of the intersected column within the range of the pattern
+            for (size_t i = 0; i < intersect->getNumRelations(); i++) {
+                IndexSet& indexes = getIndexes(intersect->getRelation(i));
+                SearchColumns keys = intersect->getRangeQueryColumns(i);
+                indexes.addSearch(keys);
+                indexes.addSearch(keys | (1UL << intersect->getColumn(i)), true);
+            }
         } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
             IndexSet& indexes = getIndexes(exists->getRelation());
             indexes.addSearch(existCheckAnalysis->getKey(exists));
@@ -328,6 +356,9 @@ void IndexSetAnalysis::print(std::ostream& os) const {
                     os << rel.getArg(i) << " ";
                 }
             }
+            if (indexes.isHashable(cols)) {
+                os << "(hash)";
+            }
             os << "\n";
         }
 
@@ -106,10 +106,13 @@ public:
 
     IndexSet(const RamRelationReference& rel) : relation(rel) {}
 
-    /** Add new key to an Index Set */
-    inline void addSearch(SearchColumns cols) {
+    /** Add new key to an Index Set; an ordered search relies on the order of the tuples it finds */
+    inline void addSearch(SearchColumns cols, bool ordered = false) {
         if (cols != 0) {
             searches.insert(cols);
+            if (ordered) {
+                orderedSearches.insert(cols);
+            }
         }
     }
     /** Get relation */
@@ -144,6 +147,13 @@ public:
         return card(cols) < orders[idx].size();
     }
 
+    /**
+     * Tests whether a search can be served by a hash index: it is neither
+     * ordered nor total, and it is the only search covered by its order
+     * unless the relation has the hash representation
+     */
+    bool isHashable(SearchColumns cols) const;
+
     /** map the keys in the key set to lexicographical order */
     void solve();
 
@@ -163,6 +173,7 @@ public:
 
 protected:
     SearchSet searches;                    // set of search patterns on table
+    SearchSet orderedSearches;             // search patterns relying on the order of tuples
     OrderCollection orders;                // collection of lexicographical orders
     ChainOrderMap chainToOrder;            // maps order index to set of searches covered by chain
     MaxMatching matching;                  // matching problem for finding minimal number of orders
@@ -21,6 +21,7 @@
 #include "Global.h"
 #include "IODirectives.h"
 #include "IOSystem.h"
+#include "IndexSetAnalysis.h"
 #include "InterpreterIndex.h"
 #include "InterpreterRecords.h"
 #include "Logger.h"
@@ -51,6 +52,7 @@
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <typeinfo>
@@ -60,6 +62,24 @@
 
 namespace souffle {
 
+/** number of chunks relations are partitioned into by parallel lattice statements */
+static const size_t LATTICE_CHUNKS = 400;
+
+/** number of chunks the outermost scan of a parallel operation is partitioned into */
+static const size_t SEARCH_CHUNKS = 400;
+
+/** minimal number of tuples for which the outermost scan of an operation is parallelised */
+static const size_t PARALLEL_SEARCH_THRESHOLD = 256;
+
+/** number of tuples buffered per projection before they are inserted by a parallel operation */
+static const size_t INSERT_BUFFER_SIZE = 1024;
+
+/** number of tuples of a scan whose filters are evaluated together, column by column */
+static const size_t BATCH_SIZE = 1024;
+
+/** number of tuples a relation of an intersection steps over before seeking from the root of its index */
+static const size_t SEEK_STEPS = 4;
+
 /** Evaluate RAM Value */
 RamDomain Interpreter::evalVal(const RamValue& value,
 		const InterpreterContext& ctxt) {
@@ -82,9 +102,9 @@ RamDomain Interpreter::evalVal(const RamValue& value,
 
 		RamDomain visitLatticeGLB(const RamLatticeGLB& latGLB) override {
 //			std::cout << "visit RamLatticeGLB here! ";
-			InterpreterContext ctxt_temp;
 			const RamLatticeBinaryFunction& glb_func =
-					interpreter.getTranslationUnit().getProgram()->getLattice()->getGLB();
+					interpreter.getTranslationUnit().getProgram()->getLattice(
+							latGLB.getLatticeAssociation())->getGLB();
 
 			const auto* refs = latGLB.getRefs();
 			auto it = refs->begin();
@@ -97,20 +117,7 @@ RamDomain Interpreter::evalVal(const RamValue& value,
 //				std::cout << "it->identifier:" << it->identifier << ",it->element:" << it->element << "\n";
 				RamDomain it_r = ctxt[it->identifier][it->element];
 //				std::cout << "last_res: " << res <<" ,it_r: " << it_r << "\n";
-				// TODO
-				// set 2 input variables
-				std::vector<RamDomain> args = { res, it_r };
-				ctxt_temp.setArguments(args);
-
-				// evaluate binary constraint
-				for (const auto& cas : glb_func.getLatCase()) {
-					if (cas.match == nullptr
-							|| interpreter.evalCond(*cas.match, ctxt_temp)) {
-						// get output if match
-						res = interpreter.evalVal(*cas.output, ctxt_temp);
-						break;
-					}
-				}
+				res = interpreter.evalLatticeFunction(glb_func, res, it_r);
 				it++;
 			}
 //			std::cout << "visit RamLatticeGLB finish, res:" << res << "\n";
@@ -316,59 +323,19 @@ RamDomain Interpreter::evalVal(const RamValue& value,
 
 		RamDomain visitLatticeUnaryFunctor(const RamLatticeUnaryFunctor& luf)
 				override {
-//			std::cout << "visitLatticeUnaryFunctor here\n";
-
-			InterpreterContext ctxt_temp;
-			const RamLatticeUnaryFunction& func = luf.getFunc();
 			RamDomain arg1 = interpreter.evalVal(*luf.getRef(), ctxt);
-
-			// set 2 input variables
-			std::vector<RamDomain> args = { arg1 };
-			ctxt_temp.setArguments(args);
-
-			// evaluate binary constraint
-			for (const auto& cas : func.getLatCase()) {
-				if (cas.constraint == nullptr
-						|| interpreter.evalCond(*cas.constraint, ctxt_temp)) {
-					// get output if match
-					return interpreter.evalVal(*cas.output, ctxt_temp);
-				}
-			}
-
-			std::cerr << "Failed to find a match for a lattice unary functor!"
-					<< std::endl;
-			exit(1);
+			return interpreter.evalLatticeFunction(luf.getFunc(), arg1);
 		}
 
 		RamDomain visitLatticeBinaryFunctor(const RamLatticeBinaryFunctor& lbf)
 				override {
 //			std::cout << "visitLatticeBinaryFunctor here\n";
 
-			InterpreterContext ctxt_temp;
 			const RamLatticeBinaryFunction& func = lbf.getFunc();
 			RamDomain arg1 = interpreter.evalVal(*lbf.getRef1(), ctxt);
 			RamDomain arg2 = interpreter.evalVal(*lbf.getRef2(), ctxt);
 
-			// set 2 input variables
-			std::vector<RamDomain> args = { arg1, arg2 };
-			ctxt_temp.setArguments(args);
-
-			// evaluate binary constraint
-			for (const auto& cas : func.getLatCase()) {
-				if (cas.match == nullptr
-						|| interpreter.evalCond(*cas.match, ctxt_temp)) {
-					// get output if match
-//					std::cout << "find a match: " << *cas.output << std::endl;
-//					if (dynamic_cast<RamQuestionMark *>(cas.output.get())!=nullptr) {
-//						std::cout << "cast to question mark!\n";
-//					}
-					return interpreter.evalVal(*cas.output, ctxt_temp);
-				}
-			}
-
-			std::cerr << "Failed to find a match for a lattice binary functor!"
-					<< std::endl;
-			exit(1);
+			return interpreter.evalLatticeFunction(func, arg1, arg2);
 		}
 
 		// -- records --
@@ -407,16 +374,10 @@ bool Interpreter::evalCond(const RamCondition& cond,
 	class ConditionEvaluator: public RamVisitor<bool> {
 		Interpreter& interpreter;
 		const InterpreterContext& ctxt;
-		RamExistenceCheckAnalysis* existCheckAnalysis;
-		RamProvenanceExistenceCheckAnalysis* provExistCheckAnalysis;
 
 	public:
 		ConditionEvaluator(Interpreter& interp, const InterpreterContext& ctxt) :
-				interpreter(interp), ctxt(ctxt), existCheckAnalysis(
-						interp.getTranslationUnit().getAnalysis<
-								RamExistenceCheckAnalysis>()), provExistCheckAnalysis(
-						interp.getTranslationUnit().getAnalysis<
-								RamProvenanceExistenceCheckAnalysis>()) {
+				interpreter(interp), ctxt(ctxt) {
 		}
 
 		// -- connectors operators --
@@ -436,19 +397,18 @@ bool Interpreter::evalCond(const RamCondition& cond,
 		}
 
 		bool visitExistenceCheck(const RamExistenceCheck& exists) override {
-			const InterpreterRelation& rel = interpreter.getRelation(
-					exists.getRelation());
+			const auto& access = interpreter.getAccess(exists);
+			const InterpreterRelation& rel = interpreter.getRelation(access);
 
 			// construct the pattern tuple
 			auto arity = rel.getArity();
 			auto values = exists.getValues();
 
-			if (Global::config().has("profile")
-					&& !exists.getRelation().isTemp()) {
-				interpreter.reads[exists.getRelation().getName()]++;
+			if (access.counted) {
+				ctxt.count(access.counter);
 			}
 			// for total we use the exists test
-			if (existCheckAnalysis->isTotal(&exists)) {
+			if (access.total) {
 				RamDomain tuple[arity];
 				for (size_t i = 0; i < arity; i++) {
 					tuple[i] =
@@ -469,16 +429,21 @@ bool Interpreter::evalCond(const RamCondition& cond,
 				high[i] = (values[i]) ? low[i] : MAX_RAM_DOMAIN;
 			}
 
+			// equality searches may probe a hash index
+			if (access.hashed) {
+				return !interpreter.getHashIndex(access)->equalRange(low).empty();
+			}
+
 			// obtain index
-			auto idx = rel.getIndex(existCheckAnalysis->getKey(&exists));
+			auto idx = interpreter.getIndex(access);
 			auto range = idx->lowerUpperBound(low, high);
 			return range.first != range.second; // if there is something => done
 		}
 
 		bool visitProvenanceExistenceCheck(
 				const RamProvenanceExistenceCheck& provExists) override {
-			const InterpreterRelation& rel = interpreter.getRelation(
-					provExists.getRelation());
+			const auto& access = interpreter.getAccess(provExists);
+			const InterpreterRelation& rel = interpreter.getRelation(access);
 
 			// construct the pattern tuple
 			auto arity = rel.getArity();
@@ -499,8 +464,7 @@ bool Interpreter::evalCond(const RamCondition& cond,
 			high[arity - 1] = MAX_RAM_DOMAIN;
 
 			// obtain index
-			auto idx = rel.getIndex(
-					provExistCheckAnalysis->getKey(&provExists));
+			auto idx = interpreter.getIndex(access);
 			auto range = idx->lowerUpperBound(low, high);
 			return range.first != range.second; // if there is something => done
 		}
@@ -590,140 +554,569 @@ bool Interpreter::evalCond(const RamCondition& cond,
 	return ConditionEvaluator(*this, ctxt)(cond);
 }
 
-/** Evaluate RAM operation */
-void Interpreter::evalOp(const RamOperation& op,
-		const InterpreterContext& args) {
-	class OperationEvaluator: public RamVisitor<void> {
-		Interpreter& interpreter;
-		InterpreterContext& ctxt;
-		RamIndexScanKeysAnalysis* keysAnalysis;
+/** Lower a RAM value to a closure */
+Interpreter::ValueClosure Interpreter::lowerVal(const RamValue& value) {
+	// values without a lowering are evaluated by visiting them
+	auto visitor = [this, &value](const InterpreterContext& ctxt) {
+		return evalVal(value, ctxt);
+	};
 
-	public:
-		OperationEvaluator(Interpreter& interp, InterpreterContext& ctxt) :
-				interpreter(interp), ctxt(ctxt), keysAnalysis(
-						interp.getTranslationUnit().getAnalysis<
-								RamIndexScanKeysAnalysis>()) {
-		}
+	switch (value.getNodeType()) {
+	case RN_Number: {
+		RamDomain num = static_cast<const RamNumber&>(value).getConstant();
+		return [num](const InterpreterContext&) {
+			return num;
+		};
+	}
 
-		// -- Operations -----------------------------
+	case RN_ElementAccess: {
+		const auto& access = static_cast<const RamElementAccess&>(value);
+		size_t id = access.getIdentifier();
+		size_t element = access.getElement();
+		return [id, element](const InterpreterContext& ctxt) {
+			return ctxt[id][element];
+		};
+	}
 
-		void visitNestedOperation(const RamNestedOperation& nested) override {
-			visit(nested.getOperation());
+	case RN_Argument: {
+		size_t arg = static_cast<const RamArgument&>(value).getArgCount();
+		return [arg](const InterpreterContext& ctxt) {
+			return ctxt.getArgument(arg);
+		};
+	}
+
+	case RN_AutoIncrement:
+		return [this](const InterpreterContext&) {
+			return incCounter();
+		};
+
+	case RN_LatticeGLB: {
+		const auto& latGLB = static_cast<const RamLatticeGLB&>(value);
+		const RamLatticeBinaryFunction& glb =
+				translationUnit.getProgram()->getLattice(
+						latGLB.getLatticeAssociation())->getGLB();
+		std::vector<std::pair<size_t, size_t>> refs;
+		for (const auto& cur : *latGLB.getRefs()) {
+			refs.push_back(std::make_pair(cur.identifier, cur.element));
 		}
+		return [this, &glb, refs](const InterpreterContext& ctxt) {
+			RamDomain res = ctxt[refs[0].first][refs[0].second];
+			for (size_t i = 1; i < refs.size(); i++) {
+				res = evalLatticeFunction(glb, res,
+						ctxt[refs[i].first][refs[i].second]);
+			}
+			return res;
+		};
+	}
 
-		void visitSearch(const RamSearch& search) override {
-			visitNestedOperation(search);
+	case RN_LatticeUnaryFunctor: {
+		const auto& luf = static_cast<const RamLatticeUnaryFunctor&>(value);
+		const RamLatticeUnaryFunction& func = luf.getFunc();
+		ValueClosure arg = lowerVal(*luf.getRef());
+		return [this, &func, arg](const InterpreterContext& ctxt) {
+			return evalLatticeFunction(func, arg(ctxt));
+		};
+	}
 
-			if (Global::config().has("profile")
-					&& !search.getProfileText().empty()) {
-				interpreter.frequencies[search.getProfileText()][interpreter.getIterationNumber()]++;
+	case RN_LatticeBinaryFunctor: {
+		const auto& lbf = static_cast<const RamLatticeBinaryFunctor&>(value);
+		const RamLatticeBinaryFunction& func = lbf.getFunc();
+		ValueClosure lhs = lowerVal(*lbf.getRef1());
+		ValueClosure rhs = lowerVal(*lbf.getRef2());
+		return [this, &func, lhs, rhs](const InterpreterContext& ctxt) {
+			RamDomain arg1 = lhs(ctxt);
+			return evalLatticeFunction(func, arg1, rhs(ctxt));
+		};
+	}
+
+	case RN_QuestionMark: {
+		const auto& qmark = static_cast<const RamQuestionMark&>(value);
+		ConditionClosure cond = lowerCond(qmark.getCondition());
+		ValueClosure first = lowerVal(qmark.getFirstRet());
+		ValueClosure second = lowerVal(qmark.getSecondRet());
+		return [cond, first, second](const InterpreterContext& ctxt) {
+			return cond(ctxt) ? first(ctxt) : second(ctxt);
+		};
+	}
+
+	case RN_Pack: {
+		std::vector<ValueClosure> args;
+		for (const RamValue* cur : static_cast<const RamPack&>(value).getArguments()) {
+			args.push_back(lowerVal(*cur));
+		}
+		return [args](const InterpreterContext& ctxt) {
+			RamDomain data[args.size()];
+			for (size_t i = 0; i < args.size(); i++) {
+				data[i] = args[i](ctxt);
 			}
+			return pack(data, args.size());
+		};
+	}
+
+	case RN_IntrinsicOperator: {
+		const auto& op = static_cast<const RamIntrinsicOperator&>(value);
+		std::vector<ValueClosure> args;
+		for (const RamValue* cur : op.getArguments()) {
+			args.push_back(lowerVal(*cur));
 		}
 
-		void visitScan(const RamScan& scan) override {
-			//std::cout << "visitScan here!\n";
-			// get the targeted relation
-			const InterpreterRelation& rel = interpreter.getRelation(
-					scan.getRelation());
+		// arithmetic and logical operators; the operators on symbols are visited
+		switch (op.getOperator()) {
+		case FunctorOp::ORD:
+			return args[0];
+		case FunctorOp::NEG:
+			return [args](const InterpreterContext& ctxt) {
+				return -args[0](ctxt);
+			};
+		case FunctorOp::BNOT:
+			return [args](const InterpreterContext& ctxt) {
+				return ~args[0](ctxt);
+			};
+		case FunctorOp::LNOT:
+			return [args](const InterpreterContext& ctxt) {
+				return RamDomain(!args[0](ctxt));
+			};
+#define BINARY_OPERATOR(Kind, Expr) \
+		case FunctorOp::Kind: { \
+			ValueClosure lhs = args[0]; \
+			ValueClosure rhs = args[1]; \
+			return [lhs, rhs](const InterpreterContext& ctxt) { \
+				RamDomain x = lhs(ctxt); \
+				RamDomain y = rhs(ctxt); \
+				return RamDomain(Expr); \
+			}; \
+		}
+		BINARY_OPERATOR(ADD, x + y)
+		BINARY_OPERATOR(SUB, x - y)
+		BINARY_OPERATOR(MUL, x * y)
+		BINARY_OPERATOR(DIV, x / y)
+		BINARY_OPERATOR(EXP, std::pow(x, y))
+		BINARY_OPERATOR(MOD, x % y)
+		BINARY_OPERATOR(BAND, x & y)
+		BINARY_OPERATOR(BOR, x | y)
+		BINARY_OPERATOR(BXOR, x ^ y)
+		BINARY_OPERATOR(LAND, x && y)
+		BINARY_OPERATOR(LOR, x || y)
+		BINARY_OPERATOR(MAX, std::max(x, y))
+		BINARY_OPERATOR(MIN, std::min(x, y))
+#undef BINARY_OPERATOR
+		default:
+			return visitor;
+		}
+	}
 
-			// use simple iterator
-			for (const RamDomain* cur : rel) {
-				ctxt[scan.getIdentifier()] = cur;
-				visitSearch(scan);
-			}
+	default:
+		return visitor;
+	}
+}
+
+/** Lower a RAM condition to a closure */
+Interpreter::ConditionClosure Interpreter::lowerCond(const RamCondition& cond) {
+	// conditions without a lowering are evaluated by visiting them
+	auto visitor = [this, &cond](const InterpreterContext& ctxt) {
+		return evalCond(cond, ctxt);
+	};
+
+	switch (cond.getNodeType()) {
+	case RN_Conjunction: {
+		const auto& conj = static_cast<const RamConjunction&>(cond);
+		ConditionClosure lhs = lowerCond(conj.getLHS());
+		ConditionClosure rhs = lowerCond(conj.getRHS());
+		return [lhs, rhs](const InterpreterContext& ctxt) {
+			return lhs(ctxt) && rhs(ctxt);
+		};
+	}
+
+	case RN_Negation: {
+		ConditionClosure operand = lowerCond(
+				static_cast<const RamNegation&>(cond).getOperand());
+		return [operand](const InterpreterContext& ctxt) {
+			return !operand(ctxt);
+		};
+	}
+
+	case RN_EmptinessCheck: {
+		size_t slot = getSlot(
+				static_cast<const RamEmptinessCheck&>(cond).getRelation().getName());
+		return [this, slot](const InterpreterContext&) {
+			return slots[slot]->empty();
+		};
+	}
+
+	case RN_ExistenceCheck: {
+		const auto& exists = static_cast<const RamExistenceCheck&>(cond);
+		const auto* access = &getAccess(exists);
+		std::vector<ValueClosure> values;
+		for (const RamValue* cur : exists.getValues()) {
+			values.push_back(cur != nullptr ? lowerVal(*cur) : ValueClosure());
 		}
+		return [this, access, values](const InterpreterContext& ctxt) {
+			const InterpreterRelation& rel = getRelation(*access);
+			size_t arity = values.size();
+			if (access->counted) {
+				ctxt.count(access->counter);
+			}
 
-		void visitIndexScan(const RamIndexScan& scan) override {
-			//std::cout << "visitIndexScan here!\n";
-			// get the targeted relation
-			const InterpreterRelation& rel = interpreter.getRelation(
-					scan.getRelation());
+			// for total we use the exists test
+			if (access->total) {
+				RamDomain tuple[arity];
+				for (size_t i = 0; i < arity; i++) {
+					tuple[i] = values[i] ? values[i](ctxt) : MIN_RAM_DOMAIN;
+				}
+				return rel.exists(tuple);
+			}
 
-			// create pattern tuple for range query
-			auto arity = rel.getArity();
+			// for partial we search for lower and upper boundaries
 			RamDomain low[arity];
-			RamDomain hig[arity];
-			auto pattern = scan.getRangePattern();
+			RamDomain high[arity];
 			for (size_t i = 0; i < arity; i++) {
-				if (pattern[i] != nullptr) {
-					low[i] = interpreter.evalVal(*pattern[i], ctxt);
-					hig[i] = low[i];
-				} else {
-					low[i] = MIN_RAM_DOMAIN;
-					hig[i] = MAX_RAM_DOMAIN;
-				}
+				low[i] = values[i] ? values[i](ctxt) : MIN_RAM_DOMAIN;
+				high[i] = values[i] ? low[i] : MAX_RAM_DOMAIN;
+			}
+			if (access->hashed) {
+				return !getHashIndex(*access)->equalRange(low).empty();
 			}
+			auto range = getIndex(*access)->lowerUpperBound(low, high);
+			return range.first != range.second;
+		};
+	}
 
-			// obtain index
-			auto idx = rel.getIndex(keysAnalysis->getRangeQueryColumns(&scan),
-					nullptr);
+	case RN_Constraint: {
+		const auto& relOp = static_cast<const RamConstraint&>(cond);
+		ValueClosure lhs = lowerVal(*relOp.getLHS());
+		ValueClosure rhs = lowerVal(*relOp.getRHS());
+
+		// numeric comparisons; the constraints on symbols are visited
+		switch (relOp.getOperator()) {
+#define COMPARISON(Kind, Op) \
+		case BinaryConstraintOp::Kind: \
+			return [lhs, rhs](const InterpreterContext& ctxt) { \
+				RamDomain x = lhs(ctxt); \
+				return x Op rhs(ctxt); \
+			};
+		COMPARISON(EQ, ==)
+		COMPARISON(NE, !=)
+		COMPARISON(LT, <)
+		COMPARISON(LE, <=)
+		COMPARISON(GT, >)
+		COMPARISON(GE, >=)
+#undef COMPARISON
+		default:
+			return visitor;
+		}
+	}
 
-			// get iterator range
-			auto range = idx->lowerUpperBound(low, hig);
+	default:
+		return visitor;
+	}
+}
 
-			// conduct range query
-			for (auto ip = range.first; ip != range.second; ++ip) {
-				const RamDomain* data = *(ip);
-				//std::cout << "scan.getIdentifier():" <<scan.getIdentifier()<<"\n";
-				ctxt[scan.getIdentifier()] = data;
-				visitSearch(scan);
-			}
+/** Lower the nested operation of a RAM search to a closure */
+Interpreter::OperationClosure Interpreter::lowerSearchBody(
+		const RamSearch& search) {
+	OperationClosure nested = lowerOp(search.getOperation());
+	if (!profiling || search.getProfileText().empty()) {
+		return nested;
+	}
+	size_t counter = addCounter(search.getProfileText(), true);
+	return [nested, counter](OperationState& state) {
+		nested(state);
+		state.ctxt.count(counter);
+	};
+}
+
+/** Lower a RAM value to a closure over a block of tuples of the scan with the given identifier */
+Interpreter::ColumnClosure Interpreter::lowerColumn(const RamValue& value,
+		size_t id) {
+	switch (value.getNodeType()) {
+	case RN_Number: {
+		RamDomain num = static_cast<const RamNumber&>(value).getConstant();
+		return [num](const InterpreterContext&, const RamDomain* const*, size_t n,
+				RamDomain* out) {
+			std::fill(out, out + n, num);
+		};
+	}
+
+	case RN_ElementAccess: {
+		const auto& access = static_cast<const RamElementAccess&>(value);
+		size_t level = access.getIdentifier();
+		size_t element = access.getElement();
+		if (level == id) {
+			return [element](const InterpreterContext&,
+					const RamDomain* const * tuples, size_t n, RamDomain* out) {
+				for (size_t i = 0; i < n; i++) {
+					out[i] = tuples[i][element];
+				}
+			};
 		}
+		// elements of outer tuples are the same for the whole block
+		return [level, element](const InterpreterContext& ctxt,
+				const RamDomain* const*, size_t n, RamDomain* out) {
+			std::fill(out, out + n, ctxt[level][element]);
+		};
+	}
 
-		void visitLookup(const RamLookup& lookup) override {
-			// get reference
-			RamDomain ref =
-					ctxt[lookup.getReferenceLevel()][lookup.getReferencePosition()];
+	case RN_Argument: {
+		size_t arg = static_cast<const RamArgument&>(value).getArgCount();
+		return [arg](const InterpreterContext& ctxt, const RamDomain* const*,
+				size_t n, RamDomain* out) {
+			std::fill(out, out + n, ctxt.getArgument(arg));
+		};
+	}
 
-			// check for null
-			if (isNull(ref)) {
-				return;
+	case RN_IntrinsicOperator: {
+		const auto& op = static_cast<const RamIntrinsicOperator&>(value);
+		std::vector<ColumnClosure> args;
+		for (const RamValue* cur : op.getArguments()) {
+			args.push_back(lowerColumn(*cur, id));
+			if (!args.back()) {
+				return ColumnClosure();
 			}
+		}
 
-			// update environment variable
-			auto arity = lookup.getArity();
-			const RamDomain* tuple = unpack(ref, arity);
+		// the operators on symbols and exponentiation are evaluated per tuple
+		switch (op.getOperator()) {
+		case FunctorOp::ORD:
+			return args[0];
+#define UNARY_COLUMN(Kind, Expr) \
+		case FunctorOp::Kind: { \
+			ColumnClosure arg = args[0]; \
+			return [arg](const InterpreterContext& ctxt, \
+					const RamDomain* const * tuples, size_t n, RamDomain* out) { \
+				arg(ctxt, tuples, n, out); \
+				for (size_t i = 0; i < n; i++) { \
+					RamDomain x = out[i]; \
+					out[i] = RamDomain(Expr); \
+				} \
+			}; \
+		}
+		UNARY_COLUMN(NEG, -x)
+		UNARY_COLUMN(BNOT, ~x)
+		UNARY_COLUMN(LNOT, !x)
+#undef UNARY_COLUMN
+#define BINARY_COLUMN(Kind, Expr) \
+		case FunctorOp::Kind: { \
+			ColumnClosure lhs = args[0]; \
+			ColumnClosure rhs = args[1]; \
+			return [lhs, rhs](const InterpreterContext& ctxt, \
+					const RamDomain* const * tuples, size_t n, RamDomain* out) { \
+				RamDomain second[n]; \
+				lhs(ctxt, tuples, n, out); \
+				rhs(ctxt, tuples, n, second); \
+				for (size_t i = 0; i < n; i++) { \
+					RamDomain x = out[i]; \
+					RamDomain y = second[i]; \
+					out[i] = RamDomain(Expr); \
+				} \
+			}; \
+		}
+		BINARY_COLUMN(ADD, x + y)
+		BINARY_COLUMN(SUB, x - y)
+		BINARY_COLUMN(MUL, x * y)
+		BINARY_COLUMN(DIV, x / y)
+		BINARY_COLUMN(MOD, x % y)
+		BINARY_COLUMN(BAND, x & y)
+		BINARY_COLUMN(BOR, x | y)
+		BINARY_COLUMN(BXOR, x ^ y)
+		BINARY_COLUMN(LAND, x && y)
+		BINARY_COLUMN(LOR, x || y)
+		BINARY_COLUMN(MAX, std::max(x, y))
+		BINARY_COLUMN(MIN, std::min(x, y))
+#undef BINARY_COLUMN
+		default:
+			return ColumnClosure();
+		}
+	}
 
-			// save reference to temporary value
-			ctxt[lookup.getIdentifier()] = tuple;
+	default:
+		return ColumnClosure();
+	}
+}
 
-			// run nested part - using base class visitor
-			visitSearch(lookup);
-		}
+/** Lower a RAM condition to a closure keeping the tuples of a block satisfying it, in order */
+Interpreter::SelectionClosure Interpreter::lowerSelection(
+		const RamCondition& cond, size_t id) {
+	if (cond.getNodeType() != RN_Constraint) {
+		return SelectionClosure();
+	}
+	const auto& relOp = static_cast<const RamConstraint&>(cond);
+	ColumnClosure lhs = lowerColumn(*relOp.getLHS(), id);
+	ColumnClosure rhs = lowerColumn(*relOp.getRHS(), id);
+	if (!lhs || !rhs) {
+		return SelectionClosure();
+	}
 
-		void visitAggregate(const RamAggregate& aggregate) override {
-			// get the targeted relation
-			const InterpreterRelation& rel = interpreter.getRelation(
-					aggregate.getRelation());
+	// the comparison is evaluated for the whole block before the block is
+	// compacted to the tuples satisfying it
+	switch (relOp.getOperator()) {
+#define SELECTION(Kind, Op) \
+	case BinaryConstraintOp::Kind: \
+		return [lhs, rhs](const InterpreterContext& ctxt, const RamDomain** tuples, \
+				size_t n) { \
+			RamDomain first[n]; \
+			RamDomain second[n]; \
+			bool keep[n]; \
+			lhs(ctxt, tuples, n, first); \
+			rhs(ctxt, tuples, n, second); \
+			for (size_t i = 0; i < n; i++) { \
+				keep[i] = first[i] Op second[i]; \
+			} \
+			size_t selected = 0; \
+			for (size_t i = 0; i < n; i++) { \
+				tuples[selected] = tuples[i]; \
+				selected += keep[i]; \
+			} \
+			return selected; \
+		};
+	SELECTION(EQ, ==)
+	SELECTION(NE, !=)
+	SELECTION(LT, <)
+	SELECTION(LE, <=)
+	SELECTION(GT, >)
+	SELECTION(GE, >=)
+#undef SELECTION
+	default:
+		return SelectionClosure();
+	}
+}
 
-			// initialize result
-			RamDomain res = 0;
-			switch (aggregate.getFunction()) {
-			case RamAggregate::MIN:
-				res = MAX_RAM_DOMAIN;
-				break;
-			case RamAggregate::MAX:
-				res = MIN_RAM_DOMAIN;
-				break;
-			case RamAggregate::COUNT:
-				res = 0;
-				break;
-			case RamAggregate::SUM:
-				res = 0;
+/** Lower the nested operation of a RAM scan to a closure over blocks of its tuples */
+Interpreter::BlockClosure Interpreter::lowerSearchBlock(
+		const RamSearch& search) {
+	size_t id = search.getIdentifier();
+
+	// the leading conjuncts of the filters directly below the scan that compare
+	// arithmetic over the tuple are evaluated column-wise, in their order
+	struct Selection {
+		SelectionClosure select;
+		/** whether the selection starts a filter counted by a profile counter */
+		bool counted;
+		size_t counter;
+	};
+	std::vector<Selection> selections;
+	OperationClosure nested;
+	const RamOperation* cur = &search.getOperation();
+	while (cur != nullptr && cur->getNodeType() == RN_Filter) {
+		const auto& filter = static_cast<const RamFilter&>(*cur);
+		std::vector<const RamCondition*> conjuncts;
+		std::vector<const RamCondition*> pending = { &filter.getCondition() };
+		while (!pending.empty()) {
+			const RamCondition* cond = pending.back();
+			pending.pop_back();
+			if (cond->getNodeType() == RN_Conjunction) {
+				const auto& conj = static_cast<const RamConjunction&>(*cond);
+				pending.push_back(&conj.getRHS());
+				pending.push_back(&conj.getLHS());
+			} else {
+				conjuncts.push_back(cond);
+			}
+		}
+
+		size_t batched = 0;
+		std::vector<SelectionClosure> selects;
+		while (batched < conjuncts.size()) {
+			SelectionClosure select = lowerSelection(*conjuncts[batched], id);
+			if (!select) {
 				break;
 			}
+			selects.push_back(select);
+			batched++;
+		}
+		if (batched == 0) {
+			break;
+		}
+		bool counted = profiling && !filter.getProfileText().empty();
+		size_t counter = counted ? addCounter(filter.getProfileText(), true) : 0;
+		for (size_t i = 0; i < selects.size(); i++) {
+			selections.push_back( { selects[i], i == 0 && counted, counter });
+		}
+		cur = &filter.getOperation();
+
+		// the remaining conjuncts are evaluated per tuple
+		if (batched < conjuncts.size()) {
+			std::vector<ConditionClosure> rest;
+			for (size_t i = batched; i < conjuncts.size(); i++) {
+				rest.push_back(lowerCond(*conjuncts[i]));
+			}
+			OperationClosure op = lowerOp(*cur);
+			nested = [rest, op](OperationState& state) {
+				for (const auto& cond : rest) {
+					if (!cond(state.ctxt)) {
+						return;
+					}
+				}
+				op(state);
+			};
+			cur = nullptr;
+		}
+	}
+	if (cur != nullptr) {
+		nested = lowerOp(*cur);
+	}
 
-			// init temporary tuple for this level
-			auto arity = rel.getArity();
+	bool counted = profiling && !search.getProfileText().empty();
+	size_t counter = counted ? addCounter(search.getProfileText(), true) : 0;
+	return [id, selections, nested, counted, counter](OperationState& state,
+			const RamDomain** tuples, size_t n) {
+		InterpreterContext& ctxt = state.ctxt;
+		if (counted) {
+			ctxt.count(counter, n);
+		}
+		for (const auto& cur : selections) {
+			if (n == 0) {
+				return;
+			}
+			if (cur.counted) {
+				ctxt.count(cur.counter, n);
+			}
+			n = cur.select(ctxt, tuples, n);
+		}
+		for (size_t i = 0; i < n; i++) {
+			ctxt[id] = tuples[i];
+			nested(state);
+		}
+	};
+}
+
+/** Lower a RAM operation to a closure */
+Interpreter::OperationClosure Interpreter::lowerOp(const RamOperation& op) {
+	switch (op.getNodeType()) {
+	case RN_Scan: {
+		const auto& scan = static_cast<const RamScan&>(op);
+		size_t slot = getSlot(scan.getRelation().getName());
+		BlockClosure body = lowerSearchBlock(scan);
+		return [this, slot, body](OperationState& state) {
+			const RamDomain* block[BATCH_SIZE];
+			size_t n = 0;
+			for (const RamDomain* cur : *slots[slot]) {
+				block[n++] = cur;
+				if (n == BATCH_SIZE) {
+					body(state, block, n);
+					n = 0;
+				}
+			}
+			if (n > 0) {
+				body(state, block, n);
+			}
+		};
+	}
 
-			// get lower and upper boundaries for iteration
-			const auto& pattern = aggregate.getPattern();
+	case RN_IndexScan: {
+		const auto& scan = static_cast<const RamIndexScan&>(op);
+		const auto* access = &getAccess(scan);
+		std::vector<ValueClosure> pattern;
+		for (const RamValue* cur : scan.getRangePattern()) {
+			pattern.push_back(cur != nullptr ? lowerVal(*cur) : ValueClosure());
+		}
+		BlockClosure body = lowerSearchBlock(scan);
+		return [this, access, pattern, body](OperationState& state) {
+			// create pattern tuple for range query
+			size_t arity = pattern.size();
 			RamDomain low[arity];
 			RamDomain hig[arity];
-
 			for (size_t i = 0; i < arity; i++) {
-				if (pattern[i] != nullptr) {
-					low[i] = interpreter.evalVal(*pattern[i], ctxt);
+				if (pattern[i]) {
+					low[i] = pattern[i](state.ctxt);
 					hig[i] = low[i];
 				} else {
 					low[i] = MIN_RAM_DOMAIN;
@@ -731,38 +1124,102 @@ void Interpreter::evalOp(const RamOperation& op,
 				}
 			}
 
-			// obtain index
-			auto idx = rel.getIndex(aggregate.getRangeQueryColumns());
-
-			// get iterator range
-			auto range = idx->lowerUpperBound(low, hig);
-
-			// check for emptiness
-			if (aggregate.getFunction() != RamAggregate::COUNT) {
-				if (range.first == range.second) {
-					return;  // no elements => no min/max
+			const RamDomain* block[BATCH_SIZE];
+			size_t n = 0;
+			auto add = [&](const RamDomain* cur) {
+				block[n++] = cur;
+				if (n == BATCH_SIZE) {
+					body(state, block, n);
+					n = 0;
+				}
+			};
+			if (access->hashed) {
+				// equality searches may probe a hash index
+				for (const RamDomain* cur : getHashIndex(*access)->equalRange(low)) {
+					add(cur);
 				}
+			} else {
+				// conduct range query
+				auto range = getIndex(*access)->lowerUpperBound(low, hig);
+				for (auto ip = range.first; ip != range.second; ++ip) {
+					add(*ip);
+				}
+			}
+			if (n > 0) {
+				body(state, block, n);
 			}
+		};
+	}
 
-			// iterate through values
-			for (auto ip = range.first; ip != range.second; ++ip) {
-				// link tuple
-				const RamDomain* data = *(ip);
-				ctxt[aggregate.getIdentifier()] = data;
+	case RN_Lookup: {
+		const auto& lookup = static_cast<const RamLookup&>(op);
+		size_t level = lookup.getReferenceLevel();
+		size_t position = lookup.getReferencePosition();
+		size_t arity = lookup.getArity();
+		size_t id = lookup.getIdentifier();
+		OperationClosure body = lowerSearchBody(lookup);
+		return [level, position, arity, id, body](OperationState& state) {
+			RamDomain ref = state.ctxt[level][position];
+			if (isNull(ref)) {
+				return;
+			}
+			state.ctxt[id] = unpack(ref, arity);
+			body(state);
+		};
+	}
 
-				// count is easy
-				if (aggregate.getFunction() == RamAggregate::COUNT) {
+	case RN_Aggregate: {
+		const auto& aggregate = static_cast<const RamAggregate&>(op);
+		const auto* access = &getAccess(aggregate);
+		size_t id = aggregate.getIdentifier();
+		auto function = aggregate.getFunction();
+		std::vector<ValueClosure> pattern;
+		for (const RamValue* cur : aggregate.getPattern()) {
+			pattern.push_back(cur != nullptr ? lowerVal(*cur) : ValueClosure());
+		}
+		ValueClosure target;
+		if (function != RamAggregate::COUNT) {
+			target = lowerVal(*aggregate.getTargetExpression());
+		}
+		OperationClosure body = lowerSearchBody(aggregate);
+		return [this, access, id, function, pattern, target, body](
+				OperationState& state) {
+			InterpreterContext& ctxt = state.ctxt;
+			size_t arity = pattern.size();
+			RamDomain low[arity];
+			RamDomain hig[arity];
+			for (size_t i = 0; i < arity; i++) {
+				if (pattern[i]) {
+					low[i] = pattern[i](ctxt);
+					hig[i] = low[i];
+				} else {
+					low[i] = MIN_RAM_DOMAIN;
+					hig[i] = MAX_RAM_DOMAIN;
+				}
+			}
+			RamDomain res = 0;
+			switch (function) {
+			case RamAggregate::MIN:
+				res = MAX_RAM_DOMAIN;
+				break;
+			case RamAggregate::MAX:
+				res = MIN_RAM_DOMAIN;
+				break;
+			case RamAggregate::COUNT:
+			case RamAggregate::SUM:
+				res = 0;
+				break;
+			}
+			bool found = false;
+			auto fold = [&](const RamDomain* tuple) {
+				found = true;
+				if (function == RamAggregate::COUNT) {
 					++res;
-					continue;
+					return;
 				}
-
-				// aggregation is a bit more difficult
-
-				// eval target expression
-				RamDomain cur = interpreter.evalVal(
-						*aggregate.getTargetExpression(), ctxt);
-
-				switch (aggregate.getFunction()) {
+				ctxt[id] = tuple;
+				RamDomain cur = target(ctxt);
+				switch (function) {
 				case RamAggregate::MIN:
 					res = std::min(res, cur);
 					break;
@@ -770,82 +1227,373 @@ void Interpreter::evalOp(const RamOperation& op,
 					res = std::max(res, cur);
 					break;
 				case RamAggregate::COUNT:
-					res = 0;
 					break;
 				case RamAggregate::SUM:
 					res += cur;
 					break;
 				}
+			};
+			if (access->hashed) {
+				for (const RamDomain* cur : getHashIndex(*access)->equalRange(low)) {
+					fold(cur);
+				}
+			} else {
+				auto range = getIndex(*access)->lowerUpperBound(low, hig);
+				for (auto ip = range.first; ip != range.second; ++ip) {
+					fold(*ip);
+				}
 			}
 
-			// write result to environment
-			RamDomain tuple[1];
-			tuple[0] = res;
-			ctxt[aggregate.getIdentifier()] = tuple;
+			// no elements => no min/max/sum
+			if (function != RamAggregate::COUNT && !found) {
+				return;
+			}
 
-			// run nested part - using base class visitor
-			visitSearch(aggregate);
-		}
+			// write result to environment and run nested part
+			RamDomain tuple[1] = { res };
+			ctxt[id] = tuple;
+			body(state);
+		};
+	}
 
-		void visitFilter(const RamFilter& filter) override {
-			//std::cout << "visitFilter here!\n";
-			// check condition
-			if (interpreter.evalCond(filter.getCondition(), ctxt)) {
-				// process nested
-				visitNestedOperation(filter);
+	case RN_Intersect: {
+		const auto& intersect = static_cast<const RamIntersect&>(op);
+		size_t id = intersect.getIdentifier();
+		size_t width = 0;
+		std::vector<Participant> participants;
+		for (size_t i = 0; i < intersect.getNumRelations(); i++) {
+			Participant cur;
+			cur.access = &getAccess(intersect.getRelation(i));
+			for (const RamValue* value : intersect.getPattern(i)) {
+				if (value != nullptr) {
+					cur.bound.push_back(cur.pattern.size());
+				}
+				cur.pattern.push_back(value != nullptr ? lowerVal(*value) : ValueClosure());
+			}
+			cur.column = intersect.getColumn(i);
+			cur.offset = width;
+			width += cur.pattern.size();
+			participants.push_back(std::move(cur));
+		}
+		OperationClosure body = lowerSearchBody(intersect);
+		return [this, id, width, participants, body](OperationState& state) {
+			InterpreterContext& ctxt = state.ctxt;
+			size_t k = participants.size();
+
+			// the lower bound of the range of each participant
+			RamDomain bounds[width];
+			InterpreterIndex* index[k];
+			InterpreterIndex::iterator cur[k];
+
+			// whether the cursor of a participant is still in its range
+			auto inRange = [&](size_t j) {
+				if (cur[j] == index[j]->end()) {
+					return false;
+				}
+				const RamDomain* tuple = *cur[j];
+				const RamDomain* low = bounds + participants[j].offset;
+				for (size_t i : participants[j].bound) {
+					if (tuple[i] != low[i]) {
+						return false;
+					}
+				}
+				return true;
+			};
+
+			RamDomain value = MIN_RAM_DOMAIN;
+			for (size_t j = 0; j < k; j++) {
+				const Participant& p = participants[j];
+				RamDomain* low = bounds + p.offset;
+				for (size_t i = 0; i < p.pattern.size(); i++) {
+					low[i] = p.pattern[i] ? p.pattern[i](ctxt) : MIN_RAM_DOMAIN;
+				}
+				index[j] = getIndex(*p.access);
+				cur[j] = index[j]->LowerBound(low);
+				if (!inRange(j)) {
+					return;
+				}
+				value = std::max(value, (*cur[j])[p.column]);
 			}
 
-			if (Global::config().has("profile")
-					&& !filter.getProfileText().empty()) {
-				interpreter.frequencies[filter.getProfileText()][interpreter.getIterationNumber()]++;
+			// leapfrog: seek each participant to the greatest value seen until all agree
+			RamDomain tuple[1];
+			size_t agreed = 0;
+			for (size_t j = 0;; j = (j + 1) % k) {
+				const Participant& p = participants[j];
+				RamDomain found = (*cur[j])[p.column];
+				if (found < value) {
+					// step over a few tuples before seeking from the root of the index
+					for (size_t step = 0; step < SEEK_STEPS && found < value; step++) {
+						++cur[j];
+						if (!inRange(j)) {
+							return;
+						}
+						found = (*cur[j])[p.column];
+					}
+					if (found < value) {
+						RamDomain* low = bounds + p.offset;
+						low[p.column] = value;
+						cur[j] = index[j]->LowerBound(low);
+						if (!inRange(j)) {
+							return;
+						}
+						found = (*cur[j])[p.column];
+					}
+				}
+				if (found == value) {
+					agreed++;
+				} else {
+					value = found;
+					agreed = 1;
+				}
+				if (agreed == k) {
+					tuple[0] = value;
+					ctxt[id] = tuple;
+					body(state);
+					if (value == MAX_RAM_DOMAIN) {
+						return;
+					}
+					value++;
+					agreed = 0;
+				}
 			}
+		};
+	}
+
+	case RN_Filter: {
+		const auto& filter = static_cast<const RamFilter&>(op);
+		ConditionClosure cond = lowerCond(filter.getCondition());
+		OperationClosure nested = lowerOp(filter.getOperation());
+		if (!profiling || filter.getProfileText().empty()) {
+			return [cond, nested](OperationState& state) {
+				if (cond(state.ctxt)) {
+					nested(state);
+				}
+			};
 		}
+		size_t counter = addCounter(filter.getProfileText(), true);
+		return [cond, nested, counter](OperationState& state) {
+			if (cond(state.ctxt)) {
+				nested(state);
+			}
+			state.ctxt.count(counter);
+		};
+	}
 
-		void visitProject(const RamProject& project) override {
+	case RN_Project: {
+		const auto& project = static_cast<const RamProject&>(op);
+		size_t slot = getSlot(project.getRelation().getName());
+		std::vector<ValueClosure> values;
+		for (const RamValue* cur : project.getValues()) {
+			assert(cur);
+			values.push_back(lowerVal(*cur));
+		}
+		return [this, &project, slot, values](OperationState& state) {
 			// create a tuple of the proper arity (also supports arity 0)
-			//std::cout << "visitProject here.\n";
-			auto arity = project.getRelation().getArity();
-			const auto& values = project.getValues();
+			size_t arity = values.size();
 			RamDomain tuple[arity];
 			for (size_t i = 0; i < arity; i++) {
-				assert(values[i]);
-				//std::cout << "visitProject -- evalVal here, arity = " << arity << ".\n";
-				tuple[i] = interpreter.evalVal(*values[i], ctxt);
+				tuple[i] = values[i](state.ctxt);
 			}
 
 			// insert in target relation
-			InterpreterRelation& rel = interpreter.getRelation(
-					project.getRelation());
-			rel.insert(tuple);
+			InterpreterRelation& rel = *slots[slot];
+			if (!state.buffered) {
+				rel.insert(tuple);
+				return;
+			}
+			InsertBuffer& buffer = state.buffers[&project];
+			buffer.rel = &rel;
+			buffer.tuples.insert(buffer.tuples.end(), tuple, tuple + arity);
+			if (++buffer.size == INSERT_BUFFER_SIZE) {
+				buffer.flush();
+			}
+		};
+	}
+
+	case RN_Return: {
+		std::vector<ValueClosure> values;
+		for (const RamValue* cur : static_cast<const RamReturn&>(op).getValues()) {
+			values.push_back(cur != nullptr ? lowerVal(*cur) : ValueClosure());
 		}
+		return [values](OperationState& state) {
+			for (const auto& val : values) {
+				if (val) {
+					state.ctxt.addReturnValue(val(state.ctxt));
+				} else {
+					state.ctxt.addReturnValue(0, true);
+				}
+			}
+		};
+	}
 
-		// -- return from subroutine --
-		void visitReturn(const RamReturn& ret) override {
-			for (auto val : ret.getValues()) {
-				if (val == nullptr) {
-					ctxt.addReturnValue(0, true);
+	default:
+		std::cerr << "Unsupported node type: " << typeid(op).name() << "\n";
+		assert(false && "Unsupported Node Type!");
+		return [](OperationState&) {
+		};
+	}
+}
+
+/** Lower the operations of all insertions of the program */
+void Interpreter::prepareOperations() {
+	auto depthAnalysis = translationUnit.getAnalysis<RamOperationDepthAnalysis>();
+	visitDepthFirst(translationUnit.getP(), [&](const RamInsert& insert) {
+		const RamOperation& op = insert.getOperation();
+		LoweredOperation& lowered = operations[&op];
+		lowered.op = lowerOp(op);
+		if (op.getNodeType() == RN_Scan || op.getNodeType() == RN_IndexScan) {
+			lowered.body = lowerSearchBlock(static_cast<const RamSearch&>(op));
+		}
+		lowered.depth = depthAnalysis->getDepth(&op);
+	});
+	counts.assign(profileCounters.size(), 0);
+}
+
+/** Allocate a profile counter, returning its slot */
+size_t Interpreter::addCounter(const std::string& text, bool iterated) {
+	profileCounters.push_back( { text, iterated });
+	return profileCounters.size() - 1;
+}
+
+/** Add the counts since the last flush to the profile totals of the current iteration */
+void Interpreter::flushCounters() {
+	for (size_t i = 0; i < counts.size(); i++) {
+		if (counts[i] == 0) {
+			continue;
+		}
+		const ProfileCounter& cur = profileCounters[i];
+		frequencies[cur.text][cur.iterated ? getIterationNumber() : 0] +=
+				counts[i];
+		counts[i] = 0;
+	}
+}
+
+/** Evaluate RAM operation */
+void Interpreter::evalOp(const RamOperation& op,
+		const InterpreterContext& args) {
+	auto pos = operations.find(&op);
+	assert(pos != operations.end() && "operation has not been lowered");
+	const LoweredOperation& lowered = pos->second;
+
+#ifdef _OPENMP
+	// the tuples of the outermost scan are partitioned into chunks, which are
+	// evaluated by threads with their own contexts; the operation does not
+	// read the relations it inserts into, so insertions can be deferred
+	if (MAX_THREADS > 1 && !omp_in_parallel() && parallelOperations.count(&op)) {
+		const auto& search = static_cast<const RamRelationSearch&>(op);
+		const InterpreterRelation& rel = getRelation(search.getRelation());
+		using iterator = InterpreterIndex::iterator;
+		std::vector<range<iterator>> chunks;
+		std::vector<const RamDomain*> tuples;
+		if (dynamic_cast<const RamScan*>(&op) != nullptr) {
+			if (rel.size() >= PARALLEL_SEARCH_THRESHOLD) {
+				chunks = rel.getTotalIndex()->getChunks(SEARCH_CHUNKS);
+			}
+		} else {
+			// the range of an outermost index scan only depends on arguments
+			const auto& scan = static_cast<const RamIndexScan&>(op);
+			const auto& access = getAccess(scan);
+			auto arity = rel.getArity();
+			RamDomain low[arity];
+			RamDomain hig[arity];
+			InterpreterContext outer(lowered.depth);
+			outer.setArguments(args.getArguments(), args.getNumArguments());
+			auto pattern = scan.getRangePattern();
+			for (size_t i = 0; i < arity; i++) {
+				if (pattern[i] != nullptr) {
+					low[i] = evalVal(*pattern[i], outer);
+					hig[i] = low[i];
 				} else {
-					ctxt.addReturnValue(interpreter.evalVal(*val, ctxt));
+					low[i] = MIN_RAM_DOMAIN;
+					hig[i] = MAX_RAM_DOMAIN;
+				}
+			}
+			if (access.hashed) {
+				tuples = getHashIndex(access)->equalRange(low);
+			} else {
+				auto range = getIndex(access)->lowerUpperBound(low, hig);
+				for (auto ip = range.first; ip != range.second; ++ip) {
+					tuples.push_back(*ip);
 				}
 			}
 		}
 
-		// -- safety net --
-		void visitNode(const RamNode& node) override {
-			std::cerr << "Unsupported node type: " << typeid(node).name()
-					<< "\n";
-			assert(false && "Unsupported Node Type!");
+		size_t numChunks = chunks.size();
+		size_t chunkSize = 0;
+		if (tuples.size() >= PARALLEL_SEARCH_THRESHOLD) {
+			chunkSize = (tuples.size() + SEARCH_CHUNKS - 1) / SEARCH_CHUNKS;
+			numChunks = (tuples.size() + chunkSize - 1) / chunkSize;
 		}
-	};
 
-	// create and run interpreter for operations
-	InterpreterContext ctxt(
-			translationUnit.getAnalysis<RamOperationDepthAnalysis>()->getDepth(
-					&op));
+		if (numChunks > 1) {
+#pragma omp parallel
+			{
+				InterpreterContext ctxt(lowered.depth);
+				ctxt.setArguments(args.getArguments(), args.getNumArguments());
+				std::vector<size_t> localCounts(counts.size());
+				ctxt.setCounters(localCounts.data());
+				OperationState state(ctxt, true);
+				const RamDomain* block[BATCH_SIZE];
+				size_t n = 0;
+				auto add = [&](const RamDomain* cur) {
+					block[n++] = cur;
+					if (n == BATCH_SIZE) {
+						lowered.body(state, block, n);
+						n = 0;
+					}
+				};
+#pragma omp for schedule(dynamic)
+				for (size_t c = 0; c < numChunks; c++) {
+					if (chunkSize == 0) {
+						for (const RamDomain* cur : chunks[c]) {
+							add(cur);
+						}
+					} else {
+						size_t end = std::min(tuples.size(), (c + 1) * chunkSize);
+						for (size_t i = c * chunkSize; i < end; i++) {
+							add(tuples[i]);
+						}
+					}
+				}
+				if (n > 0) {
+					lowered.body(state, block, n);
+				}
+				state.flush();
+
+				if (profiling) {
+#pragma omp critical(counters)
+					for (size_t i = 0; i < localCounts.size(); i++) {
+						counts[i] += localCounts[i];
+					}
+				}
+			}
+			return;
+		}
+	}
+#endif
+
+	// run the lowered operation; statements of a parallel block count into
+	// their own slots, which are added up afterwards
+	InterpreterContext ctxt(lowered.depth);
 	ctxt.setReturnValues(args.getReturnValues());
 	ctxt.setReturnErrors(args.getReturnErrors());
-	ctxt.setArguments(args.getArguments());
-	OperationEvaluator(*this, ctxt).visit(op);
+	ctxt.setArguments(args.getArguments(), args.getNumArguments());
+	std::vector<size_t> localCounts;
+#ifdef _OPENMP
+	if (profiling && omp_in_parallel()) {
+		localCounts.resize(counts.size());
+	}
+#endif
+	ctxt.setCounters(localCounts.empty() ? counts.data() : localCounts.data());
+	OperationState state(ctxt);
+	lowered.op(state);
+	if (!localCounts.empty()) {
+#pragma omp critical(counters)
+		for (size_t i = 0; i < localCounts.size(); i++) {
+			counts[i] += localCounts[i];
+		}
+	}
 }
 
 /** Evaluate RAM statement */
@@ -900,10 +1648,14 @@ void Interpreter::evalStmt(const RamStatement& stmt) {
 		}
 
 		bool visitLoop(const RamLoop& loop) override {
+			// counts are flushed whenever the iteration number changes
+			interpreter.flushCounters();
 			interpreter.resetIterationNumber();
 			while (visit(loop.getBody())) {
+				interpreter.flushCounters();
 				interpreter.incIterationNumber();
 			}
+			interpreter.flushCounters();
 			interpreter.resetIterationNumber();
 			return true;
 		}
@@ -982,16 +1734,39 @@ void Interpreter::evalStmt(const RamStatement& stmt) {
 		}
 
 		bool visitLoad(const RamLoad& load) override {
+			// tuples are read into a buffer and inserted as one batch
+			struct TupleBuffer {
+				size_t arity;
+				std::vector<RamDomain> tuples;
+				size_t size = 0;
+
+				TupleBuffer(size_t arity) :
+						arity(arity) {
+				}
+
+				void insert(const RamDomain* tuple) {
+					tuples.insert(tuples.end(), tuple, tuple + arity);
+					size++;
+				}
+
+				void insertBatch(const RamDomain* block, size_t num) {
+					tuples.insert(tuples.end(), block, block + num * arity);
+					size += num;
+				}
+			};
+
 			for (IODirectives ioDirectives : load.getIODirectives()) {
+				// the tuples read before a malformed line are inserted as well
+				InterpreterRelation& relation = interpreter.getRelation(
+						load.getRelation());
+				TupleBuffer buffer(relation.getArity());
 				try {
-					InterpreterRelation& relation = interpreter.getRelation(
-							load.getRelation());
 					IOSystem::getInstance().getReader(
 							load.getRelation().getSymbolMask(),
 							load.getRelation().getEnumTypeMask(),
 							interpreter.getSymbolTable(), ioDirectives,
 							Global::config().has("provenance"))->readAll(
-							relation);
+							buffer);
 				} catch (std::exception& e) {
 					std::cout << "symbolmask:\n";
 					load.getRelation().getSymbolMask().print(std::cout);
@@ -1001,6 +1776,7 @@ void Interpreter::evalStmt(const RamStatement& stmt) {
 					std::cout << "\n";
 					std::cerr << "Error loading data: " << e.what() << "\n";
 				}
+				relation.insertBatch(buffer.tuples.data(), buffer.size);
 			}
 			return true;
 		}
@@ -1070,199 +1846,197 @@ void Interpreter::evalStmt(const RamStatement& stmt) {
 		}
 
 		bool visitLatNorm(const RamLatNorm& latnorm) override {
-//			std::cout << "\n visit LatNorm here! relation: "
-//					<< latnorm.getRelation_IN_Rel().getName() << std::endl;
-			RamDomain lat_Top =
-					interpreter.getTranslationUnit().getProgram()->getLattice()->getTop();
-			InterpreterRelation& IN_Rel = interpreter.getRelation(
-					latnorm.getRelation_IN_Rel());
+			const RamRelationReference& relRef = latnorm.getRelation_IN_Rel();
+			InterpreterRelation& IN_Rel = interpreter.getRelation(relRef);
 			InterpreterRelation& OUT_Rel = interpreter.getRelation(
 					latnorm.getRelation_OUT_Rel());
-			//TODO
 			size_t arity = IN_Rel.getArity();
+			size_t prefix = arity - relRef.getLatticeArity();
+
+			// lattice of each lattice column
+			std::vector<const RamLatticeBinaryFunction*> lub_funcs;
+			std::vector<RamDomain> lat_Tops;
+			for (size_t i = prefix; i < arity; i++) {
+				RamLatticeAssociation* lattice =
+						interpreter.getTranslationUnit().getProgram()->getLattice(
+								relRef.getLatticeAssociation(i));
+				lub_funcs.push_back(&lattice->getLUB());
+				lat_Tops.push_back(lattice->getTop());
+			}
+
+			// obtain index
+			const InterpreterIndex* totalIndex = IN_Rel.getTotalIndex();
+
+			// join the tuples of each cell (group of tuples with equal non-lattice
+			// prefix) into a single tuple
 			RamDomain low[arity];
 			RamDomain high[arity];
 			for (size_t i = 0; i < arity; i++) {
 				low[i] = MIN_RAM_DOMAIN;
 				high[i] = MAX_RAM_DOMAIN;
 			}
-
-			InterpreterContext ctxt_temp;
-			const RamLatticeBinaryFunction& lub_func =
-					interpreter.getTranslationUnit().getProgram()->getLattice()->getLUB();
-
-			// obtain index
-			auto totalIndex = IN_Rel.getTotalIndex();
-
 			auto range = totalIndex->lowerUpperBound(low, high);
 			auto it = range.first;
 			auto itend = range.second;
 			while (it != itend) {
 				const RamDomain* data = *(it);
-				for (size_t i = 0; i < arity - 1; i++) {
+				for (size_t i = 0; i < prefix; i++) {
 					high[i] = data[i];
 				}
-				high[arity - 1] = MAX_RAM_DOMAIN; // must keep this
+				for (size_t i = prefix; i < arity; i++) {
+					high[i] = MAX_RAM_DOMAIN; // must keep this
+				}
 
 				// get iterator range
 				auto range_end = totalIndex->UpperBound(high);
-				//			RamDomain biggestLat = latAssoc->getBot();
-				RamDomain biggestLat = data[arity - 1];
+
+				// join the elements of the cell column by column
+				RamDomain* biggestLat = high + prefix;
+				std::copy(data + prefix, data + arity, biggestLat);
 				++it;
 				for (; it != range_end; ++it) {
-					// skip if obtain the top element
-					if (biggestLat == lat_Top) {
+					bool allTop = true;
+					for (size_t i = 0; i < lub_funcs.size(); i++) {
+						// skip columns which obtained the top element
+						if (biggestLat[i] == lat_Tops[i]) {
+							continue;
+						}
+						biggestLat[i] = interpreter.evalLatticeFunction(
+								*lub_funcs[i], biggestLat[i], (*it)[prefix + i]);
+						allTop = allTop && biggestLat[i] == lat_Tops[i];
+					}
+					if (allTop) {
 						it = range_end;
 						break;
 					}
-
-					RamDomain curlat = (*it)[arity - 1];
-					// set 2 input variables
-					std::vector<RamDomain> args = { biggestLat, curlat };
-					ctxt_temp.setArguments(args);
-
-					// evaluate binary constraint
-					for (const auto& cas : lub_func.getLatCase()) {
-						if (cas.match == nullptr
-								|| interpreter.evalCond(*cas.match,
-										ctxt_temp)) {
-							// get output if match
-							biggestLat = interpreter.evalVal(*cas.output,
-									ctxt_temp);
-							break;
-						}
-					}
-					//				biggestLat = latAssoc->applyLub(biggestLat, curlat);
 				}
-				high[arity - 1] = biggestLat;
-
 				OUT_Rel.insert(high);
 			}
 
 			return true;
 		}
 
-		// Plan B
-		bool visitLatClean(const RamLatClean& latclean) override {
-//			std::cout << "\n visit LatClean here! relation: "
-//					<< latclean.getRelation_IN_Origin().getName() << std::endl;
-			RamDomain lat_Top =
-					interpreter.getTranslationUnit().getProgram()->getLattice()->getTop();
+		bool visitLatMerge(const RamLatMerge& latmerge) override {
 			// get involved relation
-			InterpreterRelation& IN_Origin = interpreter.getRelation(
-					latclean.getRelation_IN_Origin());
+			auto& Origin = static_cast<InterpreterLatticeRelation&>(
+					interpreter.getRelation(latmerge.getRelation_Origin()));
 			InterpreterRelation& IN_New = interpreter.getRelation(
-					latclean.getRelation_IN_New());
-			InterpreterRelation& OUT_New = interpreter.getRelation(
-					latclean.getRelation_OUT_New());
-
-			size_t arity = IN_Origin.getArity();
-
-			// Notice: there could be several elements for each cell in in_origin lattice relation!
-			// Find biggest lattice element in the same cell. If the biggest element does not
-			// exist in in_origin, then put it in out_new
-			RamDomain low[arity];
-			RamDomain high[arity];
-			for (size_t i = 0; i < arity; i++) {
-				low[i] = MIN_RAM_DOMAIN;
-				high[i] = MAX_RAM_DOMAIN;
-			}
-
-			InterpreterContext ctxt_temp;
-			const RamLatticeBinaryFunction& lub_func =
-					interpreter.getTranslationUnit().getProgram()->getLattice()->getLUB();
-
-			// obtain index
-			auto org_totalIndex = IN_Origin.getTotalIndex();
-			auto new_totalIndex = IN_New.getTotalIndex();
-
-			auto new_range = new_totalIndex->lowerUpperBound(low, high);
-			auto new_it = new_range.first;
-			auto new_itend = new_range.second;
-
-			// Traverse the whole new lattice relation
-			while (new_it != new_itend) {
-				const RamDomain* data = *new_it;
-				RamDomain biggestLat = data[arity - 1];
-				//				std::cout << "data: ";
-				//				for (size_t i = 0; i < arity; i++) {
-				//					std::cout << data[i] << " ";
-				//				}
-				//				std::cout << std::endl;
-
-				for (size_t i = 0; i < arity - 1; i++) {
-					low[i] = data[i];
-					high[i] = data[i];
-				}
-				low[arity - 1] = MIN_RAM_DOMAIN;
-				high[arity - 1] = MAX_RAM_DOMAIN; // must keep this
-				auto cell_new_end = new_totalIndex->UpperBound(high);
-
-				// 1. traverse the new lattice relation
-				for (++new_it; new_it != cell_new_end; ++new_it) {
-					// skip if obtain the top element
-					if (biggestLat == lat_Top) {
-						new_it = cell_new_end;
-						break;
+					latmerge.getRelation_IN_New());
+			InterpreterRelation& OUT_Delta = interpreter.getRelation(
+					latmerge.getRelation_OUT_Delta());
+
+			// join each new element into its cell of the original relation; the
+			// joins are computed in parallel over chunks of the new relation and
+			// stored afterwards, since the original relation is not thread-safe
+			using Join = InterpreterLatticeRelation::Join;
+			Origin.prepareJoin();
+			auto chunks = IN_New.getTotalIndex()->getChunks(LATTICE_CHUNKS);
+			std::vector<std::vector<std::pair<const RamDomain*, Join>>> buffers(
+					chunks.size());
+#pragma omp parallel for schedule(dynamic)
+			for (size_t c = 0; c < chunks.size(); c++) {
+				Join res;
+				for (const RamDomain* cur : chunks[c]) {
+					if (Origin.join(cur, res)) {
+						buffers[c].emplace_back(cur, res);
 					}
+				}
+			}
 
-					RamDomain curlat = (*new_it)[arity - 1];
-					// set 2 input variables
-					std::vector<RamDomain> ctxt_args = { biggestLat, curlat };
-					ctxt_temp.setArguments(ctxt_args);
-					// evaluate binary constraint
-					for (const auto& cas : lub_func.getLatCase()) {
-						if (cas.match == nullptr
-								|| interpreter.evalCond(*cas.match,
-										ctxt_temp)) {
-							// get output if match
-							biggestLat = interpreter.evalVal(*cas.output,
-									ctxt_temp);
-							break;
-						}
+			// only cells whose element moved up the lattice are propagated; the
+			// indices are re-sorted once after all joins are stored
+			Origin.beginUpdates();
+			for (const auto& buffer : buffers) {
+				for (const auto& cur : buffer) {
+					if (const RamDomain* cell = Origin.commit(cur.first, cur.second)) {
+						OUT_Delta.insert(cell);
 					}
 				}
+			}
+			Origin.endUpdates();
 
+			return true;
+		}
 
-				// 2. traverse the cell in the original lattice relation
-				if (biggestLat != lat_Top) {
-					auto cell_org_range = org_totalIndex->lowerUpperBound(low,
-							high);
-					auto cell_org_it = cell_org_range.first;
-					auto cell_org_end = cell_org_range.second;
-					for (; cell_org_it != cell_org_end; ++cell_org_it) {
-						// skip if obtain the top element
-						if (biggestLat == lat_Top) {
-							break;
-						}
+		bool visitLatNarrow(const RamLatNarrow& latnarrow) override {
+			const RamRelationReference& relRef = latnarrow.getRelation_Origin();
 
-						RamDomain curlat = (*cell_org_it)[arity - 1];
-						// set 2 input variables
-						std::vector<RamDomain> ctxt_args =
-								{ biggestLat, curlat };
-						ctxt_temp.setArguments(ctxt_args);
-						// evaluate binary constraint
-						for (const auto& cas : lub_func.getLatCase()) {
-							if (cas.match == nullptr
-									|| interpreter.evalCond(*cas.match,
-											ctxt_temp)) {
-
-								// get output if match
-								biggestLat = interpreter.evalVal(*cas.output,
-										ctxt_temp);
-								break;
-							}
-						}
+			// get involved relation
+			auto& Origin = static_cast<InterpreterLatticeRelation&>(
+					interpreter.getRelation(relRef));
+			InterpreterRelation& IN_New = interpreter.getRelation(
+					latnarrow.getRelation_IN_New());
+			InterpreterRelation& OUT_Delta = interpreter.getRelation(
+					latnarrow.getRelation_OUT_Delta());
+
+			// narrowing operator of each lattice column; columns whose lattice
+			// has none keep their element
+			size_t arity = Origin.getArity();
+			size_t prefix = arity - relRef.getLatticeArity();
+			std::vector<const RamLatticeBinaryFunction*> narrow_funcs;
+			for (size_t i = prefix; i < arity; i++) {
+				RamLatticeAssociation* lattice =
+						interpreter.getTranslationUnit().getProgram()->getLattice(
+								relRef.getLatticeAssociation(i));
+				narrow_funcs.push_back(
+						lattice->hasNarrow() ? &lattice->getNarrow() : nullptr);
+			}
+
+			// narrowed tuple of a recomputed element, from the given stored cell
+			auto narrowCell = [&](const RamDomain* cur, const RamDomain* cell,
+					std::vector<RamDomain>& tuple) {
+				tuple.assign(cur, cur + arity);
+				for (size_t i = prefix; i < arity; i++) {
+					const RamLatticeBinaryFunction* narrow_func = narrow_funcs[i - prefix];
+					tuple[i] = (narrow_func == nullptr) ? cell[i] :
+							interpreter.evalLatticeFunction(*narrow_func, cell[i], cur[i]);
+				}
+			};
+
+			// narrow each cell by its recomputed elements; the narrowed tuples are
+			// computed in parallel over chunks of the new relation and stored
+			// afterwards, since the original relation is not thread-safe
+			struct Narrowing {
+				const RamDomain* cur;
+				const RamDomain* cell;
+				std::vector<RamDomain> old;
+				std::vector<RamDomain> tuple;
+			};
+			Origin.prepareJoin();
+			auto chunks = IN_New.getTotalIndex()->getChunks(LATTICE_CHUNKS);
+			std::vector<std::vector<Narrowing>> buffers(chunks.size());
+#pragma omp parallel for schedule(dynamic)
+			for (size_t c = 0; c < chunks.size(); c++) {
+				for (const RamDomain* cur : chunks[c]) {
+					const RamDomain* cell = Origin.getCell(cur);
+					if (cell == nullptr) {
+						continue;
 					}
+					buffers[c].push_back({cur, cell,
+							std::vector<RamDomain>(cell + prefix, cell + arity), {}});
+					narrowCell(cur, cell, buffers[c].back().tuple);
 				}
+			}
 
-				// 3. put element into temp new relation
-				high[arity - 1] = biggestLat;
-				if (!IN_Origin.exists(high)) {
-					OUT_New.insert(high);
+			// only cells which moved down are propagated; a cell changed by an
+			// earlier tuple of the same cell is narrowed again
+			std::vector<RamDomain> tuple;
+			Origin.beginUpdates();
+			for (const auto& buffer : buffers) {
+				for (const auto& cur : buffer) {
+					const RamDomain* cell = Origin.getCell(cur.cur);
+					const RamDomain* res = cur.tuple.data();
+					if (cell != cur.cell
+							|| !std::equal(cur.old.begin(), cur.old.end(), cell + prefix)) {
+						narrowCell(cur.cur, cell, tuple);
+						res = tuple.data();
+					}
+					if (const RamDomain* changed = Origin.replace(res)) {
+						OUT_Delta.insert(changed);
+					}
 				}
-
 			}
+			Origin.endUpdates();
 
 			return true;
 		}
@@ -1472,6 +2246,252 @@ void Interpreter::evalStmt(const RamStatement& stmt) {
 	StatementEvaluator(*this).visit(stmt);
 }
 
+/** Evaluate lattice function by its lookup table */
+RamDomain Interpreter::evalLatticeFunction(const RamLatticeFunctionTable& table,
+		const RamDomain* args) {
+	// finite domain: a single array access
+	if (const RamDomain* res = table.lookup(args)) {
+		return *res;
+	}
+
+	// otherwise the classes of the arguments select the candidate cases
+	const RamLatticeFunctionTable::Entry& entry = table.getEntry(args);
+	switch (entry.kind) {
+	case RamLatticeFunctionTable::CONSTANT:
+		return entry.value;
+	case RamLatticeFunctionTable::ARGUMENT:
+		return args[entry.value];
+	case RamLatticeFunctionTable::CASES:
+		break;
+	}
+
+	// the frame addresses the argument slots of the caller, so evaluating the
+	// cases allocates nothing and nested lattice calls get their own frames
+	InterpreterContext ctxt;
+	ctxt.setArguments(args, table.getArity());
+
+	// the first case with a matching pattern determines the output
+	for (const auto& cas : entry.cases) {
+		if (cas.match == nullptr || evalLatticeMatch(*cas.match, ctxt)) {
+			return evalLatticeOperand(*cas.output, ctxt);
+		}
+	}
+
+	std::cerr << "Failed to find a match for a lattice function!"
+			<< std::endl;
+	exit(1);
+}
+
+/** Evaluate an operand of a case of a lattice function */
+RamDomain Interpreter::evalLatticeOperand(const RamValue& value,
+		const InterpreterContext& ctxt) {
+	// arguments and constants are read directly instead of visiting them
+	switch (value.getNodeType()) {
+	case RN_Argument:
+		return ctxt.getArguments()[static_cast<const RamArgument&>(value).getArgCount()];
+	case RN_Number:
+		return static_cast<const RamNumber&>(value).getConstant();
+	default:
+		return evalVal(value, ctxt);
+	}
+}
+
+/** Evaluate the pattern of a case of a lattice function */
+bool Interpreter::evalLatticeMatch(const RamCondition& cond,
+		const InterpreterContext& ctxt) {
+	if (cond.getNodeType() == RN_Conjunction) {
+		const auto& conj = static_cast<const RamConjunction&>(cond);
+		return evalLatticeMatch(conj.getLHS(), ctxt)
+				&& evalLatticeMatch(conj.getRHS(), ctxt);
+	}
+	if (cond.getNodeType() != RN_Constraint) {
+		return evalCond(cond, ctxt);
+	}
+	const auto& constraint = static_cast<const RamConstraint&>(cond);
+	const RamValue& lhs = *constraint.getLHS();
+	const RamValue& rhs = *constraint.getRHS();
+	switch (constraint.getOperator()) {
+	case BinaryConstraintOp::EQ:
+		return evalLatticeOperand(lhs, ctxt) == evalLatticeOperand(rhs, ctxt);
+	case BinaryConstraintOp::NE:
+		return evalLatticeOperand(lhs, ctxt) != evalLatticeOperand(rhs, ctxt);
+	case BinaryConstraintOp::LT:
+		return evalLatticeOperand(lhs, ctxt) < evalLatticeOperand(rhs, ctxt);
+	case BinaryConstraintOp::LE:
+		return evalLatticeOperand(lhs, ctxt) <= evalLatticeOperand(rhs, ctxt);
+	case BinaryConstraintOp::GT:
+		return evalLatticeOperand(lhs, ctxt) > evalLatticeOperand(rhs, ctxt);
+	case BinaryConstraintOp::GE:
+		return evalLatticeOperand(lhs, ctxt) >= evalLatticeOperand(rhs, ctxt);
+	default:
+		return evalCond(cond, ctxt);
+	}
+}
+
+/** Compute lookup tables of lattice functions */
+void Interpreter::prepareLatticeFunctions() {
+	latticeFunctions = translationUnit.getAnalysis<RamLatticeFunctionAnalysis>();
+	if (Global::config().has("widening-delay")) {
+		wideningDelay = std::stoi(Global::config().get("widening-delay"));
+	}
+	for (const auto& cur : latticeFunctions->getTables()) {
+		RamLatticeFunctionTable& table = *cur.second;
+		table.tabulate([&](const RamDomain* args) {
+			return evalLatticeFunction(table, args);
+		});
+	}
+}
+
+/** Bind relation accesses to relation slots and searches */
+void Interpreter::prepareRelations() {
+	profiling = Global::config().has("profile");
+	const RamProgram& program = translationUnit.getP();
+	auto keysAnalysis = translationUnit.getAnalysis<RamIndexScanKeysAnalysis>();
+	auto existCheckAnalysis = translationUnit.getAnalysis<
+			RamExistenceCheckAnalysis>();
+	auto provExistCheckAnalysis = translationUnit.getAnalysis<
+			RamProvenanceExistenceCheckAnalysis>();
+
+	// every reference to a relation is bound to the slot of the relation
+	visitDepthFirst(program, [&](const RamRelationReference& ref) {
+		accesses[&ref].slot = getSlot(ref.getName());
+	});
+
+	// searches over the same columns share the cached index of a relation
+	std::map<std::pair<SearchColumns, int>, size_t> searchOfKey;
+	auto bind = [&](const RamNode& node, const RamRelationReference& ref,
+			SearchColumns key, bool total, int seek = -1) {
+		RelationAccess& access = accesses[&node];
+		access.slot = getSlot(ref.getName());
+		access.key = key;
+		access.total = total;
+		access.seek = seek;
+		auto pos = searchOfKey.find(std::make_pair(key, seek));
+		if (pos == searchOfKey.end()) {
+			pos = searchOfKey.insert(std::make_pair(std::make_pair(key, seek),
+					searchOfKey.size())).first;
+		}
+		access.search = pos->second;
+	};
+	// searches on the equality of columns that need no order probe hash indices
+	auto indexAnalysis = translationUnit.getAnalysis<IndexSetAnalysis>();
+	auto hash = [&](const RamNode& node, const RamRelationReference& ref) {
+		RelationAccess& access = accesses[&node];
+		access.hashed = !access.total
+				&& indexAnalysis->getIndexes(ref).isHashable(access.key);
+	};
+	visitDepthFirst(program, [&](const RamIndexScan& scan) {
+		bind(scan, scan.getRelation(), keysAnalysis->getRangeQueryColumns(&scan), false);
+		hash(scan, scan.getRelation());
+	});
+	visitDepthFirst(program, [&](const RamIntersect& intersect) {
+		for (size_t i = 0; i < intersect.getNumRelations(); i++) {
+			bind(intersect.getRelation(i), intersect.getRelation(i),
+					intersect.getRangeQueryColumns(i), false, intersect.getColumn(i));
+		}
+	});
+	visitDepthFirst(program, [&](const RamAggregate& aggregate) {
+		bind(aggregate, aggregate.getRelation(), aggregate.getRangeQueryColumns(), false);
+		hash(aggregate, aggregate.getRelation());
+	});
+	visitDepthFirst(program, [&](const RamExistenceCheck& exists) {
+		bind(exists, exists.getRelation(), existCheckAnalysis->getKey(&exists),
+				existCheckAnalysis->isTotal(&exists));
+		hash(exists, exists.getRelation());
+		// reads of relations that are not temporary are profiled
+		if (profiling && !exists.getRelation().isTemp()) {
+			RelationAccess& access = accesses[&exists];
+			access.counted = true;
+			access.counter = addCounter(
+					"@relation-reads;" + exists.getRelation().getName(), false);
+		}
+	});
+	visitDepthFirst(program, [&](const RamProvenanceExistenceCheck& provExists) {
+		bind(provExists, provExists.getRelation(),
+				provExistCheckAnalysis->getKey(&provExists), false);
+	});
+	numSearches = searchOfKey.size();
+
+	// indices may be planned up front as a minimal chain cover of the
+	// searches of each relation, completed by the remaining columns
+	if (Global::config().get("index-selection") == "chain") {
+		chainIndices = true;
+		visitDepthFirst(program, [&](const RamCreate& create) {
+			const RamRelationReference& ref = create.getRelation();
+			if (indexOrders.count(ref.getName()) > 0) {
+				return;
+			}
+			auto& orders = indexOrders[ref.getName()];
+			for (const auto& cur : indexAnalysis->getIndexes(ref).getAllOrders()) {
+				InterpreterIndexOrder order;
+				for (int column : cur) {
+					order.append(column);
+				}
+				for (size_t i = 0; i < ref.getArity(); i++) {
+					if (!order.covers(i)) {
+						order.append(i);
+					}
+				}
+				orders.push_back(order);
+			}
+		});
+	}
+
+	// the outermost scan of an insertion is evaluated in parallel unless the
+	// insertion reads a relation it inserts into or returns values
+	visitDepthFirst(program, [&](const RamInsert& insert) {
+		const RamOperation& op = insert.getOperation();
+		if (dynamic_cast<const RamScan*>(&op) == nullptr
+				&& dynamic_cast<const RamIndexScan*>(&op) == nullptr) {
+			return;
+		}
+		bool returns = false;
+		visitDepthFirst(op, [&](const RamReturn&) {
+			returns = true;
+		});
+		std::set<const RamRelationReference*> targets;
+		std::set<std::string> targetNames;
+		visitDepthFirst(op, [&](const RamProject& project) {
+			targets.insert(&project.getRelation());
+			targetNames.insert(project.getRelation().getName());
+		});
+		bool readsTarget = false;
+		visitDepthFirst(op, [&](const RamRelationReference& ref) {
+			if (targets.count(&ref) == 0 && targetNames.count(ref.getName()) > 0) {
+				readsTarget = true;
+			}
+		});
+		if (!returns && !readsTarget
+				&& static_cast<const RamRelationSearch&>(op).getRelation().getArity() > 0) {
+			parallelOperations.insert(&op);
+		}
+	});
+}
+
+/** Accumulate the index probes of a relation */
+void Interpreter::recordIndexProbes(const std::string& name,
+		const InterpreterRelation& rel) {
+	std::string origin = name;
+	if (name[0] == '@') {
+		// temporary relations of a fixpoint search the indices of their origin
+		origin.clear();
+		for (const std::string prefix : { "@delta_", "@new_lat_", "@new_" }) {
+			if (name.compare(0, prefix.size(), prefix) == 0) {
+				origin = name.substr(prefix.size());
+				break;
+			}
+		}
+		if (origin.empty()) {
+			return;
+		}
+	}
+	for (const auto& cur : rel.getProbeStatistics()) {
+		auto& stats = indexProbes[origin][cur.first];
+		stats.first += cur.second.first;
+		stats.second += cur.second.second;
+	}
+}
+
 /** Execute main program of a translation unit */
 void Interpreter::executeMain() {
 	SignalHandler::instance()->set();
@@ -1480,18 +2500,17 @@ void Interpreter::executeMain() {
 	}
 	const RamStatement& main = *translationUnit.getP().getMain();
 
+#ifdef _OPENMP
+	if (std::stoi(Global::config().get("jobs")) > 0) {
+		omp_set_num_threads(std::stoi(Global::config().get("jobs")));
+	}
+#endif
+
 	if (!Global::config().has("profile")) {
 		evalStmt(main);
 	} else {
 		ProfileEventSingleton::instance().setOutputFile(
 				Global::config().get("profile"));
-		// Prepare the frequency table for threaded use
-		visitDepthFirst(main,
-				[&](const RamSearch& node) {
-					if (!node.getProfileText().empty()) {
-						frequencies.emplace(node.getProfileText(), std::map<size_t, size_t>());
-					}
-				});
 		// Enable profiling for execution of main
 		ProfileEventSingleton::instance().startTimer();
 		ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");
@@ -1505,7 +2524,8 @@ void Interpreter::executeMain() {
 		visitDepthFirst(main, [&](const RamCreate& create) {
 			if (create.getRelation().getName()[0] != '@') {
 				++relationCount;
-				reads[create.getRelation().getName()] = 0;
+				const std::string& name = create.getRelation().getName();
+				frequencies["@relation-reads;" + name][0] = 0;
 			}
 		});
 		ProfileEventSingleton::instance().makeConfigRecord("relationCount",
@@ -1520,15 +2540,27 @@ void Interpreter::executeMain() {
 		evalStmt(main);
 
 		ProfileEventSingleton::instance().stopTimer();
+		flushCounters();
 		for (auto const& cur : frequencies) {
 			for (auto const& iter : cur.second) {
 				ProfileEventSingleton::instance().makeQuantityEvent(cur.first,
 						iter.second, iter.first);
 			}
 		}
-		for (auto const& cur : reads) {
-			ProfileEventSingleton::instance().makeQuantityEvent(
-					"@relation-reads;" + cur.first, cur.second, 0);
+		for (const auto& cur : environment) {
+			recordIndexProbes(cur.first, *cur.second);
+		}
+		for (const auto& cur : indexProbes) {
+			for (const auto& index : cur.second) {
+				std::stringstream order;
+				order << index.first;
+				ProfileEventSingleton::instance().makeQuantityEvent(
+						"@index-probes;" + cur.first + ";" + order.str(),
+						index.second.first, 0);
+				ProfileEventSingleton::instance().makeQuantityEvent(
+						"@index-hits;" + cur.first + ";" + order.str(),
+						index.second.second, 0);
+			}
 		}
 	}
 	SignalHandler::instance()->reset();
@@ -19,6 +19,8 @@
 #include "InterpreterContext.h"
 #include "InterpreterRelation.h"
 #include "RamCondition.h"
+#include "RamLatticeFunction.h"
+#include "RamLatticeFunctionAnalysis.h"
 #include "RamRelation.h"
 #include "RamStatement.h"
 #include "RamTranslationUnit.h"
@@ -28,9 +30,12 @@
 #include <atomic>
 #include <cassert>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <dlfcn.h>
@@ -40,7 +45,10 @@
 namespace souffle {
 
 class InterpreterProgInterface;
+class RamNode;
 class RamOperation;
+class RamProject;
+class RamSearch;
 class RamValue;
 class SymbolTable;
 
@@ -50,7 +58,11 @@ class SymbolTable;
 
 class Interpreter {
 public:
-    Interpreter(RamTranslationUnit& tUnit) : translationUnit(tUnit), counter(0), iteration(0), dll(nullptr) {}
+    Interpreter(RamTranslationUnit& tUnit) : translationUnit(tUnit), counter(0), iteration(0), dll(nullptr) {
+        prepareLatticeFunctions();
+        prepareRelations();
+        prepareOperations();
+    }
     virtual ~Interpreter() {
         for (auto& x : environment) {
             delete x.second;
@@ -73,6 +85,130 @@ protected:
     /** relation environment type */
     using relation_map = std::map<std::string, InterpreterRelation*>;
 
+    /** Relation accessed by a RAM node, bound to a relation slot before execution */
+    struct RelationAccess {
+        /** slot of the accessed relation */
+        size_t slot;
+        /** search of the access among all searches of the program */
+        size_t search = 0;
+        /** searched columns */
+        SearchColumns key = 0;
+        /** whether all columns are searched */
+        bool total = false;
+        /** column whose values are sorted within the searched ranges, or -1 for any order */
+        int seek = -1;
+        /** whether the search probes a hash index of the searched columns */
+        bool hashed = false;
+        /** whether the reads of the access are counted by a profile counter */
+        bool counted = false;
+        /** profile counter of the reads of the access */
+        size_t counter = 0;
+    };
+
+    /** Profile counter, resolved to a slot of the counters of each thread before execution */
+    struct ProfileCounter {
+        /** text of the profile event reporting the counter */
+        std::string text;
+        /** whether the counts are reported per iteration of a fixpoint loop */
+        bool iterated;
+    };
+
+    /** Tuples of a projection not yet inserted by a parallel operation */
+    struct InsertBuffer {
+        InterpreterRelation* rel = nullptr;
+        std::vector<RamDomain> tuples;
+        size_t size = 0;
+
+        void flush() {
+            if (size > 0) {
+                rel->insertConcurrently(tuples.data(), size);
+                tuples.clear();
+                size = 0;
+            }
+        }
+    };
+
+    /** State of a thread evaluating a lowered operation */
+    struct OperationState {
+        InterpreterContext& ctxt;
+        /** whether projected tuples are buffered, as other threads evaluate the same operation */
+        bool buffered;
+        std::unordered_map<const RamProject*, InsertBuffer> buffers;
+
+        OperationState(InterpreterContext& ctxt, bool buffered = false) : ctxt(ctxt), buffered(buffered) {}
+
+        /** Insert all buffered tuples into their relations */
+        void flush() {
+            for (auto& cur : buffers) {
+                cur.second.flush();
+            }
+        }
+    };
+
+    /** Closures of lowered RAM nodes, with relation accesses and operands already resolved */
+    using ValueClosure = std::function<RamDomain(const InterpreterContext&)>;
+    using ConditionClosure = std::function<bool(const InterpreterContext&)>;
+    using OperationClosure = std::function<void(OperationState&)>;
+
+    /** Closures of lowered RAM nodes evaluated column-wise over a block of tuples of a scan */
+    using ColumnClosure = std::function<void(const InterpreterContext&, const RamDomain* const*, size_t, RamDomain*)>;
+    using SelectionClosure = std::function<size_t(const InterpreterContext&, const RamDomain**, size_t)>;
+    using BlockClosure = std::function<void(OperationState&, const RamDomain**, size_t)>;
+
+    /** Lowered operation of an insertion */
+    struct LoweredOperation {
+        /** the whole operation */
+        OperationClosure op;
+        /** the nested operation of the outermost search, for a block of tuples of the search */
+        BlockClosure body;
+        /** depth of the tuple environment */
+        size_t depth = 0;
+    };
+
+    /** Relation of a multi-way intersection, lowered for seeking in its range */
+    struct Participant {
+        /** access of the relation */
+        const RelationAccess* access = nullptr;
+        /** values of the columns bound by the pattern of the relation */
+        std::vector<ValueClosure> pattern;
+        /** columns bound by the pattern */
+        std::vector<size_t> bound;
+        /** intersected column */
+        size_t column = 0;
+        /** offset of the lower bound of the relation among the bounds of all relations */
+        size_t offset = 0;
+    };
+
+    /** Lower a value to a closure */
+    ValueClosure lowerVal(const RamValue& value);
+
+    /** Lower a condition to a closure */
+    ConditionClosure lowerCond(const RamCondition& cond);
+
+    /** Lower an operation to a closure */
+    OperationClosure lowerOp(const RamOperation& op);
+
+    /** Lower the nested operation of a search, including its profile counter */
+    OperationClosure lowerSearchBody(const RamSearch& search);
+
+    /** Lower a value to a closure over a block of tuples of a scan, or to none if it is evaluated per tuple */
+    ColumnClosure lowerColumn(const RamValue& value, size_t id);
+
+    /** Lower a condition to a closure selecting the tuples of a block of a scan, or to none */
+    SelectionClosure lowerSelection(const RamCondition& cond, size_t id);
+
+    /** Lower the nested operation of a scan to a closure over blocks of its tuples */
+    BlockClosure lowerSearchBlock(const RamSearch& search);
+
+    /** Lower the operations of all insertions of the program */
+    void prepareOperations();
+
+    /** Allocate a profile counter, returning its slot */
+    size_t addCounter(const std::string& text, bool iterated);
+
+    /** Add the counts since the last flush to the profile totals of the current iteration */
+    void flushCounters();
+
     /** Evaluate value */
     RamDomain evalVal(const RamValue& value, const InterpreterContext& ctxt = InterpreterContext());
 
@@ -85,6 +221,42 @@ protected:
     /** Evaluate statement */
     void evalStmt(const RamStatement& stmt);
 
+    /** Evaluate lattice binary function */
+    RamDomain evalLatticeFunction(const RamLatticeBinaryFunction& func, RamDomain x, RamDomain y) {
+        const RamDomain args[2] = {x, y};
+        return evalLatticeFunction(latticeFunctions->getTable(func), args);
+    }
+
+    /** Evaluate lattice unary function */
+    RamDomain evalLatticeFunction(const RamLatticeUnaryFunction& func, RamDomain x) {
+        return evalLatticeFunction(latticeFunctions->getTable(func), &x);
+    }
+
+    /** Evaluate lattice function by its lookup table */
+    RamDomain evalLatticeFunction(const RamLatticeFunctionTable& table, const RamDomain* args);
+
+    /** Evaluate operand of a case of a lattice function */
+    RamDomain evalLatticeOperand(const RamValue& value, const InterpreterContext& ctxt);
+
+    /** Evaluate pattern of a case of a lattice function */
+    bool evalLatticeMatch(const RamCondition& cond, const InterpreterContext& ctxt);
+
+    /** Compute lookup tables of lattice functions */
+    void prepareLatticeFunctions();
+
+    /** Bind the relation accesses of the program to relation slots and searches */
+    void prepareRelations();
+
+    /** Accumulate the index probes of a relation, attributing temporary relations to their origin */
+    void recordIndexProbes(const std::string& name, const InterpreterRelation& rel);
+
+    /** Get the relation access of a node bound by prepareRelations */
+    const RelationAccess& getAccess(const RamNode& node) const {
+        auto pos = accesses.find(&node);
+        assert(pos != accesses.end() && "relation access is not bound");
+        return pos->second;
+    }
+
     /** Get symbol table */
     SymbolTable& getSymbolTable() {
         return translationUnit.getSymbolTable();
@@ -115,16 +287,63 @@ protected:
         iteration = 0;
     }
 
+    /** Get the slot of a relation, adding a slot for a relation unknown to prepareRelations */
+    size_t getSlot(const std::string& name) {
+        auto pos = slotOfName.find(name);
+        if (pos != slotOfName.end()) {
+            return pos->second;
+        }
+        slots.push_back(nullptr);
+        return slotOfName[name] = slots.size() - 1;
+    }
+
     /** Create relation */
     void createRelation(const RamRelationReference& id) {
         InterpreterRelation* res = nullptr;
         assert(environment.find(id.getName()) == environment.end());
         if (id.getRepresentation() == RelationRepresentation::EQREL) {
             res = new InterpreterEqRelation(id.getArity());
+        } else if (id.isLattice()) {
+            // each lattice column is joined in the lattice of its association
+            std::vector<InterpreterLatticeRelation::Component> components;
+            for (size_t i = id.getArity() - id.getLatticeArity(); i < id.getArity(); i++) {
+                RamLatticeAssociation* lattice =
+                        translationUnit.getProgram()->getLattice(id.getLatticeAssociation(i));
+                if (lattice->isPowerset()) {
+                    // bitsets are joined by a word-level union
+                    components.push_back(
+                            {[](RamDomain x, RamDomain y) { return x | y; }, lattice->getTop(), nullptr});
+                    continue;
+                }
+                const RamLatticeFunctionTable& lub = latticeFunctions->getTable(lattice->getLUB());
+                InterpreterLatticeRelation::lub_function widen;
+                if (lattice->hasWiden() && !id.isTemp()) {
+                    const RamLatticeFunctionTable& table = latticeFunctions->getTable(lattice->getWiden());
+                    widen = [this, &table](RamDomain x, RamDomain y) {
+                        const RamDomain args[2] = {x, y};
+                        return evalLatticeFunction(table, args);
+                    };
+                }
+                components.push_back({[this, &lub](RamDomain x, RamDomain y) {
+                                          const RamDomain args[2] = {x, y};
+                                          return evalLatticeFunction(lub, args);
+                                      },
+                        lattice->getTop(), widen});
+            }
+            res = new InterpreterLatticeRelation(id.getArity(), std::move(components), wideningDelay);
         } else {
             res = new InterpreterRelation(id.getArity());
         }
+        res->prepareSearches(numSearches);
+        auto orders = indexOrders.find(id.getName());
+        if (orders != indexOrders.end()) {
+            res->planIndices(orders->second);
+        }
+        if (chainIndices || profiling) {
+            res->trackIndices(chainIndices);
+        }
         environment[id.getName()] = res;
+        slots[getSlot(id.getName())] = res;
     }
 
     /** Get relation */
@@ -137,7 +356,26 @@ protected:
 
     /** Get relation */
     inline InterpreterRelation& getRelation(const RamRelationReference& id) {
-        return getRelation(id.getName());
+        auto pos = accesses.find(&id);
+        if (pos == accesses.end()) {
+            return getRelation(id.getName());
+        }
+        return *slots[pos->second.slot];
+    }
+
+    /** Get relation of a relation access */
+    inline InterpreterRelation& getRelation(const RelationAccess& access) {
+        return *slots[access.slot];
+    }
+
+    /** Get index of the search of a relation access */
+    inline InterpreterIndex* getIndex(const RelationAccess& access) {
+        return slots[access.slot]->getSearchIndex(access.search, access.key, access.seek);
+    }
+
+    /** Get hash index of the search of a relation access */
+    inline InterpreterHashIndex* getHashIndex(const RelationAccess& access) {
+        return slots[access.slot]->getSearchHashIndex(access.search, access.key);
     }
 
     /** Get relation map */
@@ -148,7 +386,11 @@ protected:
     /** Drop relation */
     void dropRelation(const RamRelationReference& id) {
         InterpreterRelation& rel = getRelation(id);
+        if (profiling) {
+            recordIndexProbes(id.getName(), rel);
+        }
         environment.erase(id.getName());
+        slots[getSlot(id.getName())] = nullptr;
         delete &rel;
     }
 
@@ -158,6 +400,7 @@ protected:
         InterpreterRelation* rel2 = &getRelation(ramRel2);
         environment[ramRel1.getName()] = rel2;
         environment[ramRel2.getName()] = rel1;
+        std::swap(slots[getSlot(ramRel1.getName())], slots[getSlot(ramRel2.getName())]);
     }
 
     /** Load dll */
@@ -183,20 +426,59 @@ private:
     /** relation environment */
     relation_map environment;
 
-    /** counters for atom profiling */
-    std::map<std::string, std::map<size_t, size_t>> frequencies;
+    /** relations by slot, such that relation accesses need no lookup by name */
+    std::vector<InterpreterRelation*> slots;
+
+    /** slot of each relation */
+    std::map<std::string, size_t> slotOfName;
+
+    /** relation accesses of the nodes of the program */
+    std::unordered_map<const RamNode*, RelationAccess> accesses;
 
-    /** counters for non-existence checks */
-    std::map<std::string, std::atomic<size_t>> reads;
+    /** number of distinct searches of the program */
+    size_t numSearches = 0;
+
+    /** whether the indices of relations are planned as chain covers of their searches */
+    bool chainIndices = false;
+
+    /** planned index orders of each relation */
+    std::map<std::string, std::vector<InterpreterIndexOrder>> indexOrders;
+
+    /** numbers of range probes and of probes finding tuples of the indices of each relation */
+    std::map<std::string, std::map<InterpreterIndexOrder, std::pair<size_t, size_t>>> indexProbes;
+
+    /** operations whose outermost scan may be evaluated in parallel */
+    std::unordered_set<const RamOperation*> parallelOperations;
+
+    /** lowered operations of the insertions of the program */
+    std::unordered_map<const RamOperation*, LoweredOperation> operations;
+
+    /** whether the program is profiled */
+    bool profiling = false;
+
+    /** profile counters of the searches, filters and existence checks of the program */
+    std::vector<ProfileCounter> profileCounters;
+
+    /** counts of the profile counters since they were last flushed */
+    std::vector<size_t> counts;
+
+    /** totals of the profile counters by text and iteration */
+    std::map<std::string, std::map<size_t, size_t>> frequencies;
 
     /** counter for $ operator */
-    int counter;
+    std::atomic<int> counter;
 
     /** iteration number (in a fix-point calculation) */
     size_t iteration;
 
     /** Dynamic library for user-defined functors */
     void* dll;
+
+    /** lookup tables of lattice functions */
+    RamLatticeFunctionAnalysis* latticeFunctions = nullptr;
+
+    /** number of increases of a lattice cell before it is widened */
+    size_t wideningDelay = 0;
 };
 
 }  // end of namespace souffle
@@ -30,7 +30,9 @@ class InterpreterContext {
     std::vector<const RamDomain*> data;
     std::vector<RamDomain>* returnValues = nullptr;
     std::vector<bool>* returnErrors = nullptr;
-    const std::vector<RamDomain>* args = nullptr;
+    const RamDomain* args = nullptr;
+    size_t numArgs = 0;
+    size_t* counters = nullptr;
 
 public:
     InterpreterContext(size_t size = 0) : data(size) {}
@@ -66,17 +68,39 @@ public:
         returnErrors = &retErrs;
     }
 
-    const std::vector<RamDomain>& getArguments() const {
-        return *args;
+    const RamDomain* getArguments() const {
+        return args;
+    }
+
+    size_t getNumArguments() const {
+        return numArgs;
     }
 
     void setArguments(const std::vector<RamDomain>& a) {
-        args = &a;
+        setArguments(a.data(), a.size());
+    }
+
+    /** Set argument slots; the slots are not copied and must outlive the context */
+    void setArguments(const RamDomain* a, size_t n) {
+        args = a;
+        numArgs = n;
     }
 
     RamDomain getArgument(size_t i) const {
-        assert(args != nullptr && i < args->size() && "argument out of range");
-        return (*args)[i];
+        assert(args != nullptr && i < numArgs && "argument out of range");
+        return args[i];
+    }
+
+    /** Set the profile counter slots of the thread evaluating in this context */
+    void setCounters(size_t* c) {
+        counters = c;
+    }
+
+    /** Add to a profile counter slot, unless the context counts nothing */
+    void count(size_t slot, size_t n = 1) const {
+        if (counters != nullptr) {
+            counters[slot] += n;
+        }
     }
 };
 
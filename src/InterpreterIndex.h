@@ -18,7 +18,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "BTree.h"
 #include "RamTypes.h"
@@ -216,6 +221,44 @@ public:
 		return set.find(value) != set.end();
 	}
 
+	/** hints of consecutive operations on the index */
+	using operation_hints = index_set::operation_hints;
+
+	/** check whether tuple exists in index, using the hints of previous checks */
+	bool exists(const RamDomain* value, operation_hints& hints) const {
+		return set.contains(value, hints);
+	}
+
+	/** check whether two tuples agree in the columns of the index */
+	bool equal(const RamDomain* x, const RamDomain* y) const {
+		return comparator(theOrder).equal(x, y);
+	}
+
+	/** sort tuples by the order of the index */
+	void sort(std::vector<const RamDomain*>& tuples) const {
+		comparator comp(theOrder);
+		auto less = [&](const RamDomain* x, const RamDomain* y) {
+			return comp.less(x, y);
+		};
+		if (!std::is_sorted(tuples.begin(), tuples.end(), less)) {
+			std::sort(tuples.begin(), tuples.end(), less);
+		}
+	}
+
+	/**
+	 * add tuples sorted by the order of the index; an empty index is
+	 * bulk-loaded, otherwise consecutive insertions share their hints
+	 *
+	 * precondition: the tuples do not exist in the index
+	 */
+	void insertSorted(const std::vector<const RamDomain*>& tuples) {
+		if (set.empty()) {
+			set.loadSorted(tuples.begin(), tuples.end());
+		} else {
+			set.insert(tuples.begin(), tuples.end());
+		}
+	}
+
 	/** purge all hashes of index */
 	void purge() {
 		set.clear();
@@ -254,8 +297,35 @@ public:
 	/** return start and end iterator of a range */
 	inline std::pair<iterator, iterator> lowerUpperBound(const RamDomain* low,
 			const RamDomain* high) const {
-		return std::pair<iterator, iterator>(set.lower_bound(low),
+		std::pair<iterator, iterator> res(set.lower_bound(low),
 				set.upper_bound(high));
+		if (tracking) {
+			probes.fetch_add(1, std::memory_order_relaxed);
+			if (res.first != res.second) {
+				hits.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		return res;
+	}
+
+	/** enable counting the range probes of the index and those finding tuples */
+	void trackProbes(bool enable) {
+		tracking = enable;
+	}
+
+	/** return the number of range probes of the index */
+	size_t getProbes() const {
+		return probes.load(std::memory_order_relaxed);
+	}
+
+	/** return the number of range probes of the index that found tuples */
+	size_t getHits() const {
+		return hits.load(std::memory_order_relaxed);
+	}
+
+	/** partition the index into about num ranges of consecutive tuples */
+	std::vector<range<iterator>> getChunks(size_t num) const {
+		return set.getChunks(num);
 	}
 
 private:
@@ -263,6 +333,176 @@ private:
 	const InterpreterIndexOrder theOrder;
 	// set storing tuple pointers of table
 	index_set set;
+	// whether range probes are counted
+	bool tracking = false;
+	// number of range probes
+	mutable std::atomic<size_t> probes{0};
+	// number of range probes that found tuples
+	mutable std::atomic<size_t> hits{0};
+};
+
+/**
+ * Hash index for searches on the equality of all key columns. The tuples
+ * agreeing in the key columns form a group, and the groups are found by
+ * open addressing with linear probing in a table of slots that hold the
+ * hash of a key and the number of its group.
+ */
+class InterpreterHashIndex {
+public:
+	/* tuples agreeing in the key columns */
+	using group = std::vector<const RamDomain*>;
+
+	InterpreterHashIndex(std::vector<unsigned char> columns) :
+			columns(std::move(columns)) {
+	}
+
+	/** the key columns of the index */
+	const std::vector<unsigned char>& getColumns() const {
+		return columns;
+	}
+
+	/**
+	 * add tuple to the index
+	 *
+	 * precondition: tuple does not exist in the index
+	 */
+	void insert(const RamDomain* tuple) {
+		// keep the table at most half full
+		if (2 * (groups.size() + 1) > slots.size()) {
+			rehash(std::max<size_t>(16, 2 * slots.size()));
+		}
+		size_t hash = hashOf(tuple);
+		Slot& slot = slots[find(tuple, hash)];
+		if (slot.group == 0) {
+			slot.hash = hash;
+			slot.group = groups.size() + 1;
+			groups.emplace_back();
+		}
+		groups[slot.group - 1].push_back(tuple);
+	}
+
+	/**
+	 * add tuples to the index
+	 *
+	 * precondition: the tuples do not exist in the index
+	 */
+	void insert(const std::vector<const RamDomain*>& tuples) {
+		for (const RamDomain* cur : tuples) {
+			insert(cur);
+		}
+	}
+
+	/** return the tuples agreeing with the given tuple in the key columns */
+	const group& equalRange(const RamDomain* key) const {
+		static const group none;
+		const group* res = &none;
+		if (!slots.empty()) {
+			const Slot& slot = slots[find(key, hashOf(key))];
+			if (slot.group != 0) {
+				res = &groups[slot.group - 1];
+			}
+		}
+		if (tracking) {
+			probes.fetch_add(1, std::memory_order_relaxed);
+			if (!res->empty()) {
+				hits.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		return *res;
+	}
+
+	/** purge all tuples of the index */
+	void purge() {
+		slots.clear();
+		groups.clear();
+	}
+
+	/** enable counting the probes of the index and those finding tuples */
+	void trackProbes(bool enable) {
+		tracking = enable;
+	}
+
+	/** return the number of probes of the index */
+	size_t getProbes() const {
+		return probes.load(std::memory_order_relaxed);
+	}
+
+	/** return the number of probes of the index that found tuples */
+	size_t getHits() const {
+		return hits.load(std::memory_order_relaxed);
+	}
+
+private:
+	/* a slot of the table; group 0 marks an empty slot */
+	struct Slot {
+		size_t hash = 0;
+		size_t group = 0;
+	};
+
+	// the key columns
+	const std::vector<unsigned char> columns;
+	// table of slots, whose size is a power of two
+	std::vector<Slot> slots;
+	// groups of tuples, which keep their addresses as further groups are added
+	std::deque<group> groups;
+	// whether probes are counted
+	bool tracking = false;
+	// number of probes
+	mutable std::atomic<size_t> probes{0};
+	// number of probes that found tuples
+	mutable std::atomic<size_t> hits{0};
+
+	/* hash of the key columns of a tuple, mixing all bits of each column */
+	size_t hashOf(const RamDomain* tuple) const {
+		using RamUnsigned = std::make_unsigned<RamDomain>::type;
+		uint64_t hash = 0;
+		for (unsigned char column : columns) {
+			hash = (hash ^ static_cast<uint64_t>(static_cast<RamUnsigned>(tuple[column]))) * 0x9E3779B97F4A7C15ULL;
+			hash ^= hash >> 29;
+		}
+		// the slot is taken from the low bits, which depend on the high bits of the columns
+		hash ^= hash >> 32;
+		return static_cast<size_t>(hash);
+	}
+
+	/* position of the slot of the group of a key, or of the empty slot ending its probe sequence */
+	size_t find(const RamDomain* key, size_t hash) const {
+		size_t mask = slots.size() - 1;
+		for (size_t i = hash & mask;; i = (i + 1) & mask) {
+			const Slot& slot = slots[i];
+			if (slot.group == 0
+					|| (slot.hash == hash && equal(groups[slot.group - 1].front(), key))) {
+				return i;
+			}
+		}
+	}
+
+	/* check whether two tuples agree in the key columns */
+	bool equal(const RamDomain* x, const RamDomain* y) const {
+		for (unsigned char column : columns) {
+			if (x[column] != y[column]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/* move the slots to a table of the given size */
+	void rehash(size_t size) {
+		std::vector<Slot> old(size);
+		old.swap(slots);
+		size_t mask = size - 1;
+		for (const Slot& cur : old) {
+			if (cur.group == 0) {
+				continue;
+			}
+			size_t i = cur.hash & mask;
+			while (slots[i].group != 0) {
+				i = (i + 1) & mask;
+			}
+			slots[i] = cur;
+		}
+	}
 };
 
 }  // end of namespace souffle
@@ -22,9 +22,13 @@
 
 #include "RamLatticeAssociation.h"
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace souffle {
@@ -57,12 +61,9 @@ public:
 		return num_tuples;
 	}
 
+	/** Get the total index, which is created on first use and then returned without locking */
 	const InterpreterIndex* getTotalIndex() const {
-		if (!totalIndex) {
-			totalIndex = getIndex(getTotalIndexKey());
-		}
-		assert(totalIndex != nullptr);
-		return totalIndex;
+		return totalIndexOf();
 	}
 
 	/** Insert tuple */
@@ -81,33 +82,96 @@ public:
 			return;
 		}
 
-		int blockIndex = num_tuples / (BLOCK_SIZE / arity);
-		int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
+		// update all indexes with new tuple
+		RamDomain* newTuple = store(tuple);
+		for (const auto& cur : indices) {
+			cur.second->insert(newTuple);
+		}
+		for (const auto& cur : hashIndices) {
+			cur.second->insert(newTuple);
+		}
+	}
 
-		if (tupleIndex == 0) {
-			blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
+	/**
+	 * Insert a batch of tuples. The batch is sorted once per index, duplicates
+	 * are skipped in a pass along the total order, and empty indices are
+	 * bulk-loaded.
+	 */
+	virtual void insertBatch(std::vector<const RamDomain*> batch) {
+		if (batch.empty()) {
+			return;
 		}
 
-		RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
-		for (size_t i = 0; i < arity; ++i) {
-			newTuple[i] = tuple[i];
+		// check for null-arity
+		if (arity == 0) {
+			num_tuples = 1;
+			return;
 		}
 
-		// update all indexes with new tuple
+		// skip tuples repeated in the batch or already stored
+		InterpreterIndex* total = totalIndexOf();
+		total->sort(batch);
+		InterpreterIndex::operation_hints hints;
+		std::vector<const RamDomain*> stored;
+		stored.reserve(batch.size());
+		const RamDomain* last = nullptr;
+		for (const RamDomain* cur : batch) {
+			if (last != nullptr && total->equal(last, cur)) {
+				continue;
+			}
+			last = cur;
+			if (num_tuples > 0 && total->exists(cur, hints)) {
+				continue;
+			}
+			stored.push_back(store(cur));
+		}
+		if (stored.empty()) {
+			return;
+		}
+
+		// update all indexes with the new tuples, sorted by their orders
 		for (const auto& cur : indices) {
-			cur.second->insert(newTuple);
+			if (cur.second.get() == total) {
+				cur.second->insertSorted(stored);
+				continue;
+			}
+			std::vector<const RamDomain*> sorted(stored);
+			cur.second->sort(sorted);
+			cur.second->insertSorted(sorted);
 		}
+		for (const auto& cur : hashIndices) {
+			cur.second->insert(stored);
+		}
+	}
 
-		// increment relation size
-		num_tuples++;
+	/** Insert num tuples stored consecutively as a batch */
+	void insertBatch(const RamDomain* tuples, size_t num) {
+		std::vector<const RamDomain*> batch;
+		batch.reserve(num);
+		for (size_t i = 0; i < num; i++) {
+			batch.push_back(tuples + i * arity);
+		}
+		insertBatch(std::move(batch));
 	}
 
 	/** Merge another relation into this relation */
 	void insert(const InterpreterRelation& other) {
 		assert(getArity() == other.getArity());
+		std::vector<const RamDomain*> batch;
+		batch.reserve(other.size());
 		for (const auto& cur : other) {
-			insert(cur);
+			batch.push_back(cur);
 		}
+		insertBatch(std::move(batch));
+	}
+
+	/**
+	 * Insert num tuples stored consecutively; batches may be inserted
+	 * concurrently as long as the relation is not read at the same time
+	 */
+	void insertConcurrently(const RamDomain* tuples, size_t num) {
+		auto lease = insertLock.acquire();
+		insertBatch(tuples, num);
 	}
 
 	/** Find the biggest lattice element for each cell, and insert
@@ -169,14 +233,57 @@ public:
 //		}
 //	}
 	/** Purge table */
-	void purge() {
+	virtual void purge() {
 		blockList.clear();
+		if (dropUnused) {
+			dropUnusedIndices();
+		}
 		for (const auto& cur : indices) {
 			cur.second->purge();
 		}
+		for (const auto& cur : hashIndices) {
+			cur.second->purge();
+		}
 		num_tuples = 0;
 	}
 
+	/** Plan the complete orders of the indices to be created for searches */
+	void planIndices(std::vector<InterpreterIndexOrder> orders) {
+		plannedOrders = std::move(orders);
+	}
+
+	/**
+	 * Count the range probes of all indices; if dropUnused is set, indices
+	 * other than the total index that were not probed between two purges
+	 * are dropped by the second purge and re-created on their next search
+	 */
+	void trackIndices(bool dropUnused) {
+		tracking = true;
+		this->dropUnused = dropUnused;
+		for (const auto& cur : indices) {
+			cur.second->trackProbes(true);
+		}
+		for (const auto& cur : hashIndices) {
+			cur.second->trackProbes(true);
+		}
+	}
+
+	/** Get the numbers of range probes and of probes finding tuples of each index order */
+	std::map<InterpreterIndexOrder, std::pair<size_t, size_t>> getProbeStatistics() const {
+		auto res = droppedProbes;
+		for (const auto& cur : indices) {
+			auto& stats = res[cur.first];
+			stats.first += cur.second->getProbes();
+			stats.second += cur.second->getHits();
+		}
+		for (const auto& cur : hashIndices) {
+			auto& stats = res[InterpreterIndexOrder(cur.second->getColumns())];
+			stats.first += cur.second->getProbes();
+			stats.second += cur.second->getHits();
+		}
+		return res;
+	}
+
 	/** get index for a given set of keys using a cached index as a helper. Keys are encoded as bits for each
 	 * column */
 	InterpreterIndex* getIndex(const SearchColumns& key,
@@ -220,6 +327,13 @@ public:
 			return res;
 		}
 
+		// otherwise create the planned index covering the search, if any
+		for (const auto& planned : plannedOrders) {
+			if (order.isCompatible(planned)) {
+				return getIndex(planned);
+			}
+		}
+
 		// extend index to full index
 		for (auto cur : suffix) {
 			order.append(cur);
@@ -230,6 +344,118 @@ public:
 		return getIndex(order);
 	}
 
+	/** get index for a given set of keys whose order continues with the given column, such that
+	 * the values of the column are sorted within each range of the keys */
+	InterpreterIndex* getSeekIndex(const SearchColumns& key, unsigned char next) const {
+		// suffix for order, if no matching prefix exists
+		std::vector<unsigned char> suffix;
+		suffix.reserve(getArity());
+
+		// convert to order
+		InterpreterIndexOrder order;
+		for (size_t k = 1, i = 0; i < getArity(); i++, k *= 2) {
+			if (key & k) {
+				order.append(i);
+			} else if (i != next) {
+				suffix.push_back(i);
+			}
+		}
+		auto seeks = [&](const InterpreterIndexOrder& other) {
+			return order.isCompatible(other) && order.size() < other.size()
+					&& other[order.size()] == next;
+		};
+
+		// see whether there is an order with a matching prefix
+		InterpreterIndex* res = nullptr;
+		{
+			auto lease = lock.acquire();
+			(void) lease;
+
+			for (auto it = indices.begin(); !res && it != indices.end(); ++it) {
+				if (seeks(it->first)) {
+					res = it->second.get();
+				}
+			}
+		}
+		if (res) {
+			return res;
+		}
+		for (const auto& planned : plannedOrders) {
+			if (seeks(planned)) {
+				return getIndex(planned);
+			}
+		}
+
+		// extend index to full index
+		order.append(next);
+		for (auto cur : suffix) {
+			order.append(cur);
+		}
+		assert(order.isComplete());
+		return getIndex(order);
+	}
+
+	/** Reserve the given number of searches whose indices are cached by getSearchIndex */
+	void prepareSearches(size_t numSearches) {
+		searches.reset(new std::atomic<InterpreterIndex*>[numSearches]);
+		for (size_t i = 0; i < numSearches; i++) {
+			searches[i].store(nullptr, std::memory_order_relaxed);
+		}
+		hashSearches.reset(new std::atomic<InterpreterHashIndex*>[numSearches]);
+		for (size_t i = 0; i < numSearches; i++) {
+			hashSearches[i].store(nullptr, std::memory_order_relaxed);
+		}
+		this->numSearches = numSearches;
+	}
+
+	/** get index for a search prepared by the interpreter. The index is resolved on
+	 * first use and then returned without locking. */
+	InterpreterIndex* getSearchIndex(size_t search, SearchColumns key, int next = -1) const {
+		if (search >= numSearches) {
+			return next < 0 ? getIndex(key) : getSeekIndex(key, next);
+		}
+		InterpreterIndex* res = searches[search].load(std::memory_order_acquire);
+		if (res == nullptr) {
+			res = next < 0 ? getIndex(key) : getSeekIndex(key, next);
+			searches[search].store(res, std::memory_order_release);
+		}
+		return res;
+	}
+
+	/** get the hash index of a given set of keys. Keys are encoded as bits for each column */
+	InterpreterHashIndex* getHashIndex(const SearchColumns& key) const {
+		auto lease = lock.acquire();
+		(void) lease;
+		std::unique_ptr<InterpreterHashIndex>& res = hashIndices[key];
+		if (!res) {
+			std::vector<unsigned char> columns;
+			for (size_t i = 0; i < getArity(); i++) {
+				if (key & (1UL << i)) {
+					columns.push_back(i);
+				}
+			}
+			res = std::make_unique<InterpreterHashIndex>(std::move(columns));
+			res->trackProbes(tracking);
+			for (const RamDomain* cur : *this) {
+				res->insert(cur);
+			}
+		}
+		return res.get();
+	}
+
+	/** get the hash index for a search prepared by the interpreter, resolved on first use */
+	InterpreterHashIndex* getSearchHashIndex(size_t search, SearchColumns key) const {
+		if (search >= numSearches) {
+			return getHashIndex(key);
+		}
+		InterpreterHashIndex* res = hashSearches[search].load(std::memory_order_acquire);
+		if (res == nullptr) {
+			res = getHashIndex(key);
+			hashSearches[search].store(res, std::memory_order_release);
+		}
+		return res;
+	}
+
 	/** get index for a given order. Keys are encoded as bits for each column */
 	InterpreterIndex* getIndex(const InterpreterIndexOrder& order) const {
 		// TODO: improve index usage by re-using indices with common prefix
@@ -241,8 +467,12 @@ public:
 			if (pos == indices.end()) {
 				std::unique_ptr<InterpreterIndex>& newIndex = indices[order];
 				newIndex = std::make_unique<InterpreterIndex>(order);
-				newIndex->insert(this->begin(), this->end());
+				newIndex->trackProbes(tracking);
+				std::vector<const RamDomain*> tuples(this->begin(), this->end());
+				newIndex->sort(tuples);
+				newIndex->insertSorted(tuples);
 				res = newIndex.get();
+				unorderedPrefix = unorderedPrefix || !startsWithPrefix(order, orderedPrefix);
 			} else {
 				res = pos->second.get();
 			}
@@ -263,10 +493,7 @@ public:
 		}
 
 		// handle all other arities
-		if (!totalIndex) {
-			totalIndex = getIndex(getTotalIndexKey());
-		}
-		return totalIndex->exists(tuple);
+		return totalIndexOf()->exists(tuple);
 	}
 
 	// --- iterator ---
@@ -352,6 +579,48 @@ public:
 	virtual void extend(const InterpreterRelation& rel) {
 	}
 
+protected:
+	/** Re-sort all indices whose order is not preserved by an in-place
+	 *  update of the columns following the given unique prefix, i.e. whose
+	 *  order does not start with the prefix columns */
+	void reorderIndices(size_t prefix) {
+		auto lease = lock.acquire();
+		(void) lease;
+		for (const auto& cur : indices) {
+			if (!startsWithPrefix(cur.first, prefix)) {
+				cur.second->purge();
+				cur.second->insert(this->begin(), this->end());
+			}
+		}
+	}
+
+	/** Check whether all indices start with the columns of the given prefix */
+	bool isPrefixOfAllIndices(size_t prefix) const {
+		// answered without locking for the prefix tracked on index creation
+		if (prefix == orderedPrefix) {
+			return !unorderedPrefix;
+		}
+		auto lease = lock.acquire();
+		(void) lease;
+		for (const auto& cur : indices) {
+			if (!startsWithPrefix(cur.first, prefix)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Track whether all indices start with the columns of the given prefix */
+	void trackPrefix(size_t prefix) {
+		auto lease = lock.acquire();
+		(void) lease;
+		orderedPrefix = prefix;
+		unorderedPrefix = false;
+		for (const auto& cur : indices) {
+			unorderedPrefix = unorderedPrefix || !startsWithPrefix(cur.first, prefix);
+		}
+	}
+
 private:
 	/** Arity of relation */
 	const size_t arity;
@@ -367,11 +636,115 @@ private:
 	/** List of indices */
 	mutable std::map<InterpreterIndexOrder, std::unique_ptr<InterpreterIndex>> indices;
 
-	/** Total index for existence checks */
-	mutable InterpreterIndex* totalIndex;
+	/** Total index for existence checks, created by getTotalIndex() */
+	mutable std::atomic<InterpreterIndex*> totalIndex;
+
+	/** Indices of the searches prepared by the interpreter */
+	std::unique_ptr<std::atomic<InterpreterIndex*>[]> searches;
+
+	/** Hash indices of the searches on the equality of their columns, by searched columns */
+	mutable std::map<SearchColumns, std::unique_ptr<InterpreterHashIndex>> hashIndices;
+
+	/** Hash indices of the searches prepared by the interpreter */
+	std::unique_ptr<std::atomic<InterpreterHashIndex*>[]> hashSearches;
+
+	/** Number of prepared searches */
+	size_t numSearches = 0;
+
+	/** Prefix tracked by isPrefixOfAllIndices */
+	size_t orderedPrefix = 0;
+
+	/** Whether some index does not start with the columns of the tracked prefix */
+	mutable std::atomic<bool> unorderedPrefix{false};
+
+	/** Complete orders of the indices planned for the searches of the relation */
+	std::vector<InterpreterIndexOrder> plannedOrders;
+
+	/** Whether the range probes of the indices are counted */
+	bool tracking = false;
+
+	/** Whether indices not probed between two purges are dropped */
+	bool dropUnused = false;
+
+	/** Number of range probes of each index at the last purge */
+	std::map<InterpreterIndexOrder, size_t> probesAtPurge;
+
+	/** Numbers of range probes and of probes finding tuples of dropped indices */
+	std::map<InterpreterIndexOrder, std::pair<size_t, size_t>> droppedProbes;
 
 	/** Lock for parallel execution */
 	mutable Lock lock;
+
+	/** Lock for concurrent insertions */
+	Lock insertLock;
+
+	/** Drop the indices other than the total index that were not probed since the last purge */
+	void dropUnusedIndices() {
+		bool dropped = false;
+		for (auto it = indices.begin(); it != indices.end();) {
+			const InterpreterIndex* index = it->second.get();
+			size_t& seen = probesAtPurge[it->first];
+			if (index == totalIndex.load(std::memory_order_relaxed) || index->getProbes() != seen) {
+				seen = index->getProbes();
+				++it;
+				continue;
+			}
+			auto& stats = droppedProbes[it->first];
+			stats.first += index->getProbes();
+			stats.second += index->getHits();
+			probesAtPurge.erase(it->first);
+			it = indices.erase(it);
+			dropped = true;
+		}
+		// searches resolve their indices again on their next use
+		if (dropped) {
+			for (size_t i = 0; i < numSearches; i++) {
+				searches[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/** Get the total index, creating it if needed; safe in parallel operations */
+	InterpreterIndex* totalIndexOf() const {
+		InterpreterIndex* res = totalIndex.load(std::memory_order_acquire);
+		if (res == nullptr) {
+			// threads racing to create it keep the index published first
+			InterpreterIndex* created = getIndex(getTotalIndexKey());
+			res = totalIndex.compare_exchange_strong(res, created, std::memory_order_acq_rel)
+					? created : res;
+		}
+		assert(res != nullptr);
+		return res;
+	}
+
+	/** Copy a tuple into the blocks of the relation, without indexing it */
+	RamDomain* store(const RamDomain* tuple) {
+		int blockIndex = num_tuples / (BLOCK_SIZE / arity);
+		int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
+
+		if (tupleIndex == 0) {
+			blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
+		}
+
+		RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
+		for (size_t i = 0; i < arity; ++i) {
+			newTuple[i] = tuple[i];
+		}
+
+		// increment relation size
+		num_tuples++;
+		return newTuple;
+	}
+
+	/** Check whether the first columns of an index order are those of the given prefix */
+	static bool startsWithPrefix(const InterpreterIndexOrder& order, size_t prefix) {
+		for (size_t i = 0; i < prefix && i < order.size(); i++) {
+			if (order[i] >= prefix) {
+				return false;
+			}
+		}
+		return true;
+	}
 };
 
 /**
@@ -404,6 +777,13 @@ public:
 		}
 	}
 
+	/** Insert a batch of tuples, each of them extended by its new knowledge */
+	void insertBatch(std::vector<const RamDomain*> batch) override {
+		for (const RamDomain* cur : batch) {
+			insert(cur);
+		}
+	}
+
 	/** Find the new knowledge generated by inserting a tuple */
 	std::vector<RamDomain*> extend(const RamDomain* tuple) override {
 		std::vector<RamDomain*> newTuples;
@@ -443,11 +823,312 @@ public:
 				newTuples.push_back(newTuple);
 			}
 		}
+		InterpreterRelation::insertBatch(
+				std::vector<const RamDomain*>(newTuples.begin(), newTuples.end()));
 		for (const auto* newTuple : newTuples) {
-			InterpreterRelation::insert(newTuple);
 			delete[] newTuple;
 		}
 	}
 };
 
+/**
+ * Interpreter Lattice Relation
+ *
+ * A lattice relation stores at most one tuple per cell, where a cell is
+ * identified by the non-lattice prefix columns and the trailing lattice
+ * columns hold one lattice element each. Inserting a tuple into an occupied
+ * cell joins each new element into the stored one with the least upper bound
+ * of the lattice of its column, so the relation never holds intermediate
+ * lattice elements.
+ */
+class InterpreterLatticeRelation: public InterpreterRelation {
+public:
+	/** Least upper bound of two lattice elements */
+	using lub_function = std::function<RamDomain(RamDomain, RamDomain)>;
+
+	/** Lattice of a lattice column */
+	struct Component {
+		/** least upper bound */
+		lub_function lub;
+		/** top element */
+		RamDomain top;
+		/** widening operator, or empty if the lattice has none */
+		lub_function widen;
+	};
+
+	InterpreterLatticeRelation(size_t relArity, std::vector<Component> components,
+			size_t widenDelay = 0) :
+			InterpreterRelation(relArity), components(std::move(components)), prefix(
+					relArity - this->components.size()), widenDelay(widenDelay), cellIndex(
+					nullptr) {
+		assert(!this->components.empty() && this->components.size() <= relArity
+				&& "lattice relation requires a lattice column");
+		for (const auto& cur : this->components) {
+			widening = widening || cur.widen;
+		}
+		trackPrefix(prefix);
+	}
+
+	InterpreterLatticeRelation(size_t relArity, lub_function lub, RamDomain top,
+			lub_function widen = nullptr, size_t widenDelay = 0) :
+			InterpreterLatticeRelation(relArity,
+					{ Component { std::move(lub), top, std::move(widen) } },
+					widenDelay) {
+	}
+
+	/** Purge table */
+	void purge() override {
+		InterpreterRelation::purge();
+		increases.clear();
+		// the cell index may have been dropped by the purge
+		cellIndex.store(nullptr, std::memory_order_relaxed);
+	}
+
+	/** Insert tuple, joining its lattice elements into the stored cell */
+	void insert(const RamDomain* tuple) override {
+		update(tuple);
+	}
+
+	/** Insert a batch of tuples, joining each into its cell */
+	void insertBatch(std::vector<const RamDomain*> batch) override {
+		beginUpdates();
+		for (const RamDomain* cur : batch) {
+			update(cur);
+		}
+		endUpdates();
+	}
+
+	/**
+	 * Defer re-sorting the indices not starting with the non-lattice prefix
+	 * until endUpdates(); until then only the cell index may be searched
+	 */
+	void beginUpdates() {
+		deferReorder = true;
+	}
+
+	/** Re-sort, once, the indices left unsorted by the updates since beginUpdates() */
+	void endUpdates() {
+		deferReorder = false;
+		if (reorderPending) {
+			reorderPending = false;
+			reorderIndices(prefix);
+		}
+	}
+
+	/** Get the number of trailing lattice columns */
+	size_t getLatticeArity() const {
+		return components.size();
+	}
+
+	/** Join of a tuple into its cell, computed without modifying the relation */
+	struct Join {
+		/** stored tuple of the cell, or nullptr if the cell is empty */
+		RamDomain* cell = nullptr;
+		/** stored elements of the cell when the join was computed */
+		std::vector<RamDomain> old;
+		/** joined elements */
+		std::vector<RamDomain> element;
+	};
+
+	/**
+	 * Insert tuple, joining its lattice elements into the stored cell; returns
+	 * the stored tuple if the cell is new or one of its elements moved up the
+	 * lattice, and nullptr otherwise
+	 */
+	const RamDomain* update(const RamDomain* tuple) {
+		assert(tuple);
+		if (!join(tuple, scratch)) {
+			return nullptr;
+		}
+		return apply(tuple, scratch, false);
+	}
+
+	/**
+	 * Compute the join of the given tuple into its cell; returns false if the
+	 * stored elements already absorb the new ones. The relation is not
+	 * modified, so joins may be computed concurrently after prepareJoin().
+	 */
+	bool join(const RamDomain* tuple, Join& res) const {
+		const size_t latArity = components.size();
+		res.cell = findCell(tuple);
+		res.element.assign(tuple + prefix, tuple + prefix + latArity);
+		if (res.cell == nullptr) {
+			return true;
+		}
+
+		// each column is joined in its own lattice; skip columns whose stored
+		// element already absorbs the new one
+		res.old.assign(res.cell + prefix, res.cell + prefix + latArity);
+		bool changed = false;
+		for (size_t i = 0; i < latArity; i++) {
+			const RamDomain old = res.old[i];
+			if (old == components[i].top || old == res.element[i]) {
+				res.element[i] = old;
+				continue;
+			}
+			res.element[i] = components[i].lub(old, res.element[i]);
+			changed = changed || res.element[i] != old;
+		}
+		return changed;
+	}
+
+	/** Create the cell index, so that concurrent calls of join() and getCell() only read the relation */
+	void prepareJoin() const {
+		getCellIndex();
+	}
+
+	/**
+	 * Store a join computed by join() in the fixpoint, widening cells which
+	 * keep increasing; the join is recomputed if the cell has changed since.
+	 * Returns the stored tuple if the cell is new or one of its elements moved
+	 * up the lattice, and nullptr otherwise
+	 */
+	const RamDomain* commit(const RamDomain* tuple, const Join& res) {
+		const RamDomain* cell = findCell(tuple);
+		if (cell != res.cell
+				|| (cell != nullptr
+						&& !std::equal(res.old.begin(), res.old.end(), cell + prefix))) {
+			if (!join(tuple, scratch)) {
+				return nullptr;
+			}
+			return apply(tuple, scratch, true);
+		}
+		return apply(tuple, res, true);
+	}
+
+	/**
+	 * Overwrite the lattice elements of the stored cell of the given tuple;
+	 * returns the stored tuple if one of its elements changed, and nullptr
+	 * otherwise
+	 */
+	const RamDomain* replace(const RamDomain* tuple) {
+		assert(tuple);
+		RamDomain* cell = findCell(tuple);
+		if (cell == nullptr
+				|| std::equal(tuple + prefix, tuple + getArity(), cell + prefix)) {
+			return nullptr;
+		}
+		setElements(cell, tuple + prefix);
+		return cell;
+	}
+
+	/** Get the stored tuple of the cell of the given tuple, or nullptr if the cell is empty */
+	const RamDomain* getCell(const RamDomain* tuple) const {
+		return findCell(tuple);
+	}
+
+private:
+	/** Store a join which is known to be up to date, widening the cell if requested */
+	const RamDomain* apply(const RamDomain* tuple, const Join& res, bool widen) {
+		if (res.cell == nullptr) {
+			InterpreterRelation::insert(tuple);
+			return findCell(tuple);
+		}
+		const size_t latArity = components.size();
+		RamDomain joined[latArity];
+		std::copy(res.element.begin(), res.element.end(), joined);
+
+		// cells which keep increasing are widened to bound the ascending chain
+		if (widen && widening) {
+			size_t& count = increases[res.cell];
+			if (count >= widenDelay) {
+				for (size_t i = 0; i < latArity; i++) {
+					if (components[i].widen && joined[i] != res.old[i]) {
+						joined[i] = components[i].widen(res.old[i], joined[i]);
+					}
+				}
+			}
+			count++;
+		}
+
+		setElements(res.cell, joined);
+		return res.cell;
+	}
+
+	/** Set the lattice elements of a stored cell */
+	void setElements(RamDomain* cell, const RamDomain* elements) {
+		// update in place; indices starting with the non-lattice prefix stay
+		// sorted since the prefix is unique in the relation
+		std::copy(elements, elements + components.size(), cell + prefix);
+		if (isPrefixOfAllIndices(prefix)) {
+			return;
+		}
+		if (deferReorder) {
+			reorderPending = true;
+		} else {
+			reorderIndices(prefix);
+		}
+	}
+
+	/** Get index over the natural column order, creating it if needed; safe in parallel operations */
+	InterpreterIndex* getCellIndex() const {
+		InterpreterIndex* res = cellIndex.load(std::memory_order_acquire);
+		if (res == nullptr) {
+			// natural column order starts with the non-lattice prefix
+			InterpreterIndexOrder order;
+			for (size_t i = 0; i < getArity(); i++) {
+				order.append(i);
+			}
+			// getIndex creates the index under the lock, so racing threads publish the same one
+			res = getIndex(order);
+			cellIndex.store(res, std::memory_order_release);
+		}
+		return res;
+	}
+
+	/** Find the stored tuple with the same non-lattice prefix */
+	RamDomain* findCell(const RamDomain* tuple) const {
+		if (empty()) {
+			return nullptr;
+		}
+		const size_t arity = getArity();
+		const InterpreterIndex* cellIndex = getCellIndex();
+
+		RamDomain low[arity];
+		RamDomain high[arity];
+		for (size_t i = 0; i < prefix; i++) {
+			low[i] = tuple[i];
+			high[i] = tuple[i];
+		}
+		for (size_t i = prefix; i < arity; i++) {
+			low[i] = MIN_RAM_DOMAIN;
+			high[i] = MAX_RAM_DOMAIN;
+		}
+
+		auto range = cellIndex->lowerUpperBound(low, high);
+		if (range.first == range.second) {
+			return nullptr;
+		}
+		// tuples are owned by this relation; indices only hold const views
+		return const_cast<RamDomain*>(*range.first);
+	}
+
+	/** Lattices of the trailing lattice columns */
+	const std::vector<Component> components;
+
+	/** Number of non-lattice prefix columns identifying a cell */
+	const size_t prefix;
+
+	/** Whether the lattice of some column has a widening operator */
+	bool widening = false;
+
+	/** Number of increases of a cell before it is widened */
+	const size_t widenDelay;
+
+	/** Number of increases of each cell */
+	std::unordered_map<const RamDomain*, size_t> increases;
+
+	/** Join buffer of sequential updates */
+	Join scratch;
+
+	/** Index over the natural column order used to locate cells */
+	mutable std::atomic<InterpreterIndex*> cellIndex;
+
+	/** Whether re-sorting the indices is deferred until endUpdates() */
+	bool deferReorder = false;
+
+	/** Whether some index has been left unsorted by a deferred update */
+	bool reorderPending = false;
+};
+
 }  // end of namespace souffle
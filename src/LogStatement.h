@@ -112,6 +112,22 @@ public:
         return line.str();
     }
 
+    static const std::string nLatticeRelation(
+            const std::string& relationName, const SrcLocation& srcLocation) {
+        const char* messageType = "@n-lattice-relation";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << srcLocation << ";";
+        return line.str();
+    }
+
+    static const std::string nNarrowingRelation(
+            const std::string& relationName, const SrcLocation& srcLocation) {
+        const char* messageType = "@n-narrowing-relation";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << srcLocation << ";";
+        return line.str();
+    }
+
     static const std::string pProofCounter(
             const std::string& relationName, const SrcLocation& srcLocation, const std::string& datalogText) {
         // TODO (#590): the profiler should be modified to use this type of log message, as currently these
@@ -41,6 +41,28 @@ extern void yyset_in(FILE* in_str, yyscan_t scanner);
 
 namespace souffle {
 
+namespace {
+
+using symbol_type = yy::parser::symbol_type;
+
+/** Whether two tokens are of the same type */
+bool isA(const symbol_type& token, const symbol_type& other) {
+	return token.type_get() == other.type_get();
+}
+
+/** Whether a token is a relation qualifier */
+bool isQualifier(const symbol_type& token) {
+	const SrcLocation& loc = token.location;
+	return isA(token, yy::parser::make_OUTPUT_QUALIFIER(loc)) || isA(token, yy::parser::make_INPUT_QUALIFIER(loc)) ||
+			isA(token, yy::parser::make_PRINTSIZE_QUALIFIER(loc)) ||
+			isA(token, yy::parser::make_OVERRIDABLE_QUALIFIER(loc)) ||
+			isA(token, yy::parser::make_INLINE_QUALIFIER(loc)) || isA(token, yy::parser::make_BRIE_QUALIFIER(loc)) ||
+			isA(token, yy::parser::make_BTREE_QUALIFIER(loc)) || isA(token, yy::parser::make_EQREL_QUALIFIER(loc)) ||
+			isA(token, yy::parser::make_HASH_QUALIFIER(loc));
+}
+
+}  // namespace
+
 ParserDriver::ParserDriver() = default;
 
 ParserDriver::~ParserDriver() = default;
@@ -51,6 +73,8 @@ std::unique_ptr<AstTranslationUnit> ParserDriver::parse(
 	translationUnit = std::make_unique<AstTranslationUnit>(
 			std::unique_ptr<AstProgram>(new AstProgram()), symbolTable,
 			errorReport, debugReport);
+	peeked.reset();
+	qualifiable = false;
 	yyscan_t scanner;
 	scanner_data data;
 	data.yyfilename = filename.c_str();
@@ -85,6 +109,8 @@ std::unique_ptr<AstTranslationUnit> ParserDriver::parse(const std::string& code,
 	translationUnit = std::make_unique<AstTranslationUnit>(
 			std::unique_ptr<AstProgram>(new AstProgram()), symbolTable,
 			errorReport, debugReport);
+	peeked.reset();
+	qualifiable = false;
 
 	scanner_data data;
 	data.yyfilename = "<in-memory>";
@@ -154,7 +180,7 @@ void ParserDriver::addLatticeFunction(
 
 void ParserDriver::addLatticeAssociation(
 		std::unique_ptr<AstLatticeAssociation> f) {
-	const auto pt = translationUnit->getProgram()->getLatticeAssociation();
+	const auto pt = translationUnit->getProgram()->getLatticeAssociation(f->getName());
 	if (pt != nullptr) {
 		Diagnostic err(Diagnostic::ERROR,
 				DiagnosticMessage("Dual definition of Lattice Association ",
@@ -250,6 +276,35 @@ souffle::SymbolTable& ParserDriver::getSymbolTable() {
 	return translationUnit->getSymbolTable();
 }
 
+yy::parser::symbol_type ParserDriver::takeToken(yyscan_t yyscanner) {
+	if (peeked) {
+		symbol_type token = std::move(*peeked);
+		peeked.reset();
+		return token;
+	}
+	return yyscan(*this, yyscanner);
+}
+
+yy::parser::symbol_type ParserDriver::nextToken(yyscan_t yyscanner) {
+	symbol_type token = takeToken(yyscanner);
+	const SrcLocation loc = token.location;
+	bool identifier = false;
+	if (isA(token, yy::parser::make_HASH_QUALIFIER(loc))) {
+		identifier = !qualifiable;
+		if (!identifier) {
+			// qualifiers follow the attributes of a declaration, which may be followed by a clause on hash
+			peeked = std::make_unique<symbol_type>(yyscan(*this, yyscanner));
+			identifier = isA(*peeked, yy::parser::make_LPAREN(loc)) || isA(*peeked, yy::parser::make_DOT(loc));
+		}
+	}
+	if (identifier) {
+		qualifiable = false;
+		return yy::parser::make_IDENT("hash", loc);
+	}
+	qualifiable = isA(token, yy::parser::make_RPAREN(loc)) || isQualifier(token);
+	return token;
+}
+
 void ParserDriver::error(const SrcLocation& loc, const std::string& msg) {
 	translationUnit->getErrorReport().addError(msg, loc);
 }
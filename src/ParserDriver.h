@@ -91,9 +91,28 @@ public:
 
 	void error(const SrcLocation& loc, const std::string& msg);
 	void error(const std::string& msg);
+
+	/**
+	 * Get the next token of the scanner. The keyword hash is only a relation
+	 * qualifier where one may follow, elsewhere it is read as an identifier.
+	 */
+	yy::parser::symbol_type nextToken(yyscan_t yyscanner);
+
+private:
+	yy::parser::symbol_type takeToken(yyscan_t yyscanner);
+
+	// the token read ahead of the current one, if any
+	std::unique_ptr<yy::parser::symbol_type> peeked;
+
+	// whether a relation qualifier may follow the last token
+	bool qualifiable = false;
 };
 
 }  // end of namespace souffle
 
-#define YY_DECL yy::parser::symbol_type yylex(souffle::ParserDriver& driver, yyscan_t yyscanner)
+#define YY_DECL yy::parser::symbol_type yyscan(souffle::ParserDriver& driver, yyscan_t yyscanner)
 YY_DECL;
+
+inline yy::parser::symbol_type yylex(souffle::ParserDriver& driver, yyscan_t yyscanner) {
+	return driver.nextToken(yyscanner);
+}
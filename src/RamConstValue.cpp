@@ -15,6 +15,8 @@
  ***********************************************************************/
 
 #include "RamConstValue.h"
+#include "RamLatticeFunctor.h"
+#include "RamQuestionMark.h"
 #include "RamValue.h"
 #include "RamVisitor.h"
 #include <vector>
@@ -36,6 +38,25 @@ bool RamConstValueAnalysis::isConstant(const RamValue* value) const {
             return false;
         }
 
+        // greatest lower bound of lattice elements of tuples
+        bool visitLatticeGLB(const RamLatticeGLB& glb) override {
+            return false;
+        }
+
+        // lattice functors
+        bool visitLatticeUnaryFunctor(const RamLatticeUnaryFunctor& op) override {
+            return visit(op.getRef());
+        }
+
+        bool visitLatticeBinaryFunctor(const RamLatticeBinaryFunctor& op) override {
+            return visit(op.getRef1()) && visit(op.getRef2());
+        }
+
+        // question mark
+        bool visitQuestionMark(const RamQuestionMark& qmark) override {
+            return false;
+        }
+
         // auto increment
         bool visitAutoIncrement(const RamAutoIncrement& increment) override {
             return false;
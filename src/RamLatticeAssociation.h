@@ -24,6 +24,7 @@
 #include <string>
 
 #include <iostream>
+#include <limits>
 
 #include <vector>
 #include "RamLatticeFunction.h"
@@ -38,12 +39,21 @@ private:
 	/* Greatest lower bound */
 	std::shared_ptr<RamLatticeBinaryFunction> glb = nullptr;
 
+	/* Widening operator, optional */
+	std::shared_ptr<RamLatticeBinaryFunction> widen = nullptr;
+
+	/* Narrowing operator, optional */
+	std::shared_ptr<RamLatticeBinaryFunction> narrow = nullptr;
+
 	/* lattice Bottom element */
 	RamDomain bottom;
 
 	/* lattice Top element */
 	RamDomain top;
 
+	/* Whether this is the built-in powerset lattice over bitsets */
+	bool powerset = false;
+
 public:
 	RamLatticeAssociation() :
 			RamNode(RN_LatticeAssociation) {
@@ -57,10 +67,21 @@ public:
 	/** Print */
 	void print(std::ostream& out) const override {
 		out << "LATTICE ASSOCIATION DEFINITION. " << std::endl;
+		if (powerset) {
+			out << "powerset" << std::endl;
+		}
 		out << "lub: " << std::endl;
 		lub->print(out);
 		out << "glb: " << std::endl;
 		glb->print(out);
+		if (widen) {
+			out << "widen: " << std::endl;
+			widen->print(out);
+		}
+		if (narrow) {
+			out << "narrow: " << std::endl;
+			narrow->print(out);
+		}
 	}
 
 	/** set lub function */
@@ -81,8 +102,52 @@ public:
 		return *glb;
 	}
 
+	/** set widening operator */
+	void setWiden(std::shared_ptr<RamLatticeBinaryFunction> w) {
+		widen = w;
+	}
+
+	/** set narrowing operator */
+	void setNarrow(std::shared_ptr<RamLatticeBinaryFunction> n) {
+		narrow = n;
+	}
+
+	bool hasWiden() const {
+		return widen != nullptr;
+	}
+
+	const RamLatticeBinaryFunction& getWiden() {
+		assert(widen);
+		return *widen;
+	}
+
+	bool hasNarrow() const {
+		return narrow != nullptr;
+	}
+
+	const RamLatticeBinaryFunction& getNarrow() {
+		assert(narrow);
+		return *narrow;
+	}
+
+	/** mark as the built-in powerset lattice */
+	void setPowerset() {
+		powerset = true;
+	}
+
+	/** Check whether the elements are bitsets joined by union and met by intersection */
+	bool isPowerset() const {
+		return powerset;
+	}
+
+	/** Get the full bitset of the powerset lattice, all bits but the sign bit;
+	 * a powerset thus holds up to 31 elements, or 63 with a 64-bit domain */
+	static RamDomain getPowersetTop() {
+		return std::numeric_limits<RamDomain>::max();
+	}
+
 	void setBotTop(RamDomain b, RamDomain t) {
-		assert(b != 0 && t != 0);
+		assert(powerset || (b != 0 && t != 0));
 		bottom = b;
 		top = t;
 		//std::cout << "bottom: "<<*b << " top:"<< *t << std::endl;
@@ -128,7 +193,8 @@ protected:
 	bool equal(const RamNode& node) const override {
 		assert(nullptr != dynamic_cast<const RamLatticeAssociation*>(&node));
 		const auto& other = static_cast<const RamLatticeAssociation&>(node);
-		return lub == other.lub && glb == other.glb;
+		return lub == other.lub && glb == other.glb && widen == other.widen
+				&& narrow == other.narrow;
 	}
 };
 
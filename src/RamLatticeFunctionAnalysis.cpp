@@ -0,0 +1,276 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamLatticeFunctionAnalysis.cpp
+ *
+ * Implementation of the lookup tables of lattice functions
+ *
+ ***********************************************************************/
+
+#include "RamLatticeFunctionAnalysis.h"
+#include "BinaryConstraintOps.h"
+#include "RamCondition.h"
+#include "RamLatticeAssociation.h"
+#include "RamLatticeFunctor.h"
+#include "RamProgram.h"
+#include "RamTranslationUnit.h"
+#include "RamValue.h"
+#include "RamVisitor.h"
+#include "SymbolTable.h"
+
+#include <set>
+#include <utility>
+
+namespace souffle {
+
+namespace {
+
+/** maximal number of tested constants for which a decision table is built */
+const size_t MAX_CONSTANTS = 64;
+
+/** maximal number of enum symbols over which a function is tabulated densely */
+const size_t MAX_DOMAIN = 256;
+
+/** Check whether a condition is a test arg_k = c, and return k and c if it is */
+bool isConstantTest(const RamCondition& cond, size_t& pos, RamDomain& value) {
+    const auto* constraint = dynamic_cast<const RamConstraint*>(&cond);
+    if (constraint == nullptr || constraint->getOperator() != BinaryConstraintOp::EQ) {
+        return false;
+    }
+    const RamValue* lhs = constraint->getLHS();
+    const RamValue* rhs = constraint->getRHS();
+    if (dynamic_cast<const RamArgument*>(lhs) == nullptr) {
+        std::swap(lhs, rhs);
+    }
+    const auto* arg = dynamic_cast<const RamArgument*>(lhs);
+    const auto* num = dynamic_cast<const RamNumber*>(rhs);
+    if (arg == nullptr || num == nullptr) {
+        return false;
+    }
+    pos = arg->getArgCount();
+    value = num->getConstant();
+    return true;
+}
+
+/** Split a condition into its conjuncts */
+void getConjuncts(const RamCondition& cond, std::vector<const RamCondition*>& conjuncts) {
+    if (const auto* conj = dynamic_cast<const RamConjunction*>(&cond)) {
+        getConjuncts(conj->getLHS(), conjuncts);
+        getConjuncts(conj->getRHS(), conjuncts);
+    } else {
+        conjuncts.push_back(&cond);
+    }
+}
+
+/** Check whether evaluating a node has no side effects */
+bool isPure(const RamNode& node) {
+    bool pure = true;
+    visitDepthFirst(node, [&](const RamAutoIncrement&) { pure = false; });
+    return pure;
+}
+
+}  // namespace
+
+RamLatticeFunctionTable::RamLatticeFunctionTable(
+        const std::vector<Case>& cases, size_t arity, RamDomain enumBase, size_t enumSize)
+        : arity(arity) {
+    // the constant tests of each case, and whether it has further conditions
+    struct Pattern {
+        std::vector<std::pair<size_t, RamDomain>> tests;
+        bool residual = false;
+    };
+    std::vector<Pattern> patterns(cases.size());
+    std::set<RamDomain> tested;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        if (cases[i].match == nullptr) {
+            continue;
+        }
+        std::vector<const RamCondition*> conjuncts;
+        getConjuncts(*cases[i].match, conjuncts);
+        for (const RamCondition* cur : conjuncts) {
+            size_t pos;
+            RamDomain value;
+            if (isConstantTest(*cur, pos, value) && pos < arity) {
+                patterns[i].tests.emplace_back(pos, value);
+                tested.insert(value);
+            } else {
+                patterns[i].residual = true;
+            }
+        }
+    }
+
+    // too many constants: a single entry evaluating all matches in order
+    if (tested.size() <= MAX_CONSTANTS) {
+        constants.assign(tested.begin(), tested.end());
+    } else {
+        for (auto& pattern : patterns) {
+            pattern.residual = pattern.residual || !pattern.tests.empty();
+            pattern.tests.clear();
+        }
+    }
+
+    // compute the candidate cases for every combination of argument classes
+    size_t numEntries = 1;
+    for (size_t i = 0; i < arity; ++i) {
+        numEntries *= constants.size() + 1;
+    }
+    entries.resize(numEntries);
+    std::vector<size_t> classes(arity);
+    for (size_t e = 0; e < numEntries; ++e) {
+        for (size_t i = arity, rest = e; i-- > 0; rest /= constants.size() + 1) {
+            classes[i] = rest % (constants.size() + 1);
+        }
+        Entry& entry = entries[e];
+        for (size_t i = 0; i < cases.size(); ++i) {
+            bool consistent = true;
+            for (const auto& test : patterns[i].tests) {
+                consistent = consistent && classes[test.first] == getClass(test.second);
+            }
+            if (!consistent) {
+                continue;
+            }
+            if (patterns[i].residual) {
+                entry.cases.push_back(cases[i]);
+            } else {
+                // matches definitely, later cases are unreachable
+                entry.cases.push_back({nullptr, cases[i].output});
+                break;
+            }
+        }
+        if (!entry.cases.empty() && entry.cases.front().match == nullptr) {
+            const RamValue* output = entry.cases.front().output;
+            if (const auto* num = dynamic_cast<const RamNumber*>(output)) {
+                entry.kind = CONSTANT;
+                entry.value = num->getConstant();
+            } else if (const auto* arg = dynamic_cast<const RamArgument*>(output)) {
+                entry.kind = ARGUMENT;
+                entry.value = arg->getArgCount();
+            }
+        }
+    }
+
+    // functions discriminating on enum symbols are tabulated over the enum symbols, provided that
+    // evaluating them cannot fail for any arguments
+    if (enumSize == 0 || enumSize > MAX_DOMAIN) {
+        return;
+    }
+    for (const Entry& entry : entries) {
+        if (entry.cases.empty() || entry.cases.back().match != nullptr) {
+            return;
+        }
+    }
+    for (RamDomain value : constants) {
+        if (value >= enumBase && static_cast<size_t>(value - enumBase) < enumSize) {
+            domainBase = enumBase;
+            domainSize = enumSize;
+            break;
+        }
+    }
+}
+
+void RamLatticeFunctionTable::tabulate(const std::function<RamDomain(const RamDomain*)>& eval) {
+    if (!isFinite() || !table.empty()) {
+        return;
+    }
+    size_t size = 1;
+    for (size_t i = 0; i < arity; ++i) {
+        size *= domainSize;
+    }
+    std::vector<RamDomain> dense(size);
+    std::vector<RamDomain> args(arity);
+    for (size_t e = 0; e < size; ++e) {
+        for (size_t i = arity, rest = e; i-- > 0; rest /= domainSize) {
+            args[i] = domainBase + static_cast<RamDomain>(rest % domainSize);
+        }
+        dense[e] = eval(args.data());
+    }
+    table.swap(dense);
+}
+
+void RamLatticeFunctionAnalysis::run(const RamTranslationUnit& translationUnit) {
+    const RamProgram& program = translationUnit.getP();
+
+    // the enum symbols of the program, in the window at the end of the domain
+    size_t enumMin = SymbolTable::enumEnd();
+    size_t enumMax = SymbolTable::enumStart();
+    for (size_t index : translationUnit.getSymbolTable().getIndices()) {
+        if (SymbolTable::isEnumSymbol(index)) {
+            enumMin = std::min(enumMin, index);
+            enumMax = std::max(enumMax, index + 1);
+        }
+    }
+    const auto enumBase = static_cast<RamDomain>(enumMin);
+    const size_t enumSize = (enumMin < enumMax) ? enumMax - enumMin : 0;
+
+    auto addBinary = [&](const RamLatticeBinaryFunction& func) {
+        if (tables.find(&func) != tables.end()) {
+            return;
+        }
+        std::vector<RamLatticeFunctionTable::Case> cases;
+        bool pure = true;
+        for (const auto& cur : func.getLatCase()) {
+            cases.push_back({cur.match.get(), cur.output.get()});
+            pure = pure && (cur.match == nullptr || isPure(*cur.match)) && isPure(*cur.output);
+        }
+        tables[&func] = std::make_unique<RamLatticeFunctionTable>(cases, 2, enumBase, pure ? enumSize : 0);
+    };
+    auto addUnary = [&](const RamLatticeUnaryFunction& func) {
+        if (tables.find(&func) != tables.end()) {
+            return;
+        }
+        std::vector<RamLatticeFunctionTable::Case> cases;
+        bool pure = true;
+        for (const auto& cur : func.getLatCase()) {
+            cases.push_back({cur.constraint.get(), cur.output.get()});
+            pure = pure && (cur.constraint == nullptr || isPure(*cur.constraint)) && isPure(*cur.output);
+        }
+        tables[&func] = std::make_unique<RamLatticeFunctionTable>(cases, 1, enumBase, pure ? enumSize : 0);
+    };
+
+    for (const auto& cur : program.getLattices()) {
+        RamLatticeAssociation& lattice = *cur.second;
+        addBinary(lattice.getLUB());
+        addBinary(lattice.getGLB());
+        if (lattice.hasWiden()) {
+            addBinary(lattice.getWiden());
+        }
+        if (lattice.hasNarrow()) {
+            addBinary(lattice.getNarrow());
+        }
+    }
+    for (const auto& cur : program.getLBFs()) {
+        addBinary(*cur.second);
+    }
+    for (const auto& cur : program.getLUFs()) {
+        addUnary(*cur.second);
+    }
+
+    // functions referenced by functors of the program
+    auto addFunctors = [&](const RamNode& node) {
+        visitDepthFirst(node, [&](const RamLatticeBinaryFunctor& functor) { addBinary(functor.getFunc()); });
+        visitDepthFirst(node, [&](const RamLatticeUnaryFunctor& functor) { addUnary(functor.getFunc()); });
+    };
+    if (program.getMain() != nullptr) {
+        addFunctors(*program.getMain());
+    }
+    for (const auto& cur : program.getSubroutines()) {
+        addFunctors(*cur.second);
+    }
+}
+
+void RamLatticeFunctionAnalysis::print(std::ostream& os) const {
+    for (const auto& cur : tables) {
+        const RamLatticeFunctionTable& table = *cur.second;
+        os << "arity " << table.getArity() << ": ";
+        os << (table.isFinite() ? "tabulated" : "decision table") << std::endl;
+    }
+}
+
+}  // end of namespace souffle
@@ -0,0 +1,173 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamLatticeFunctionAnalysis.h
+ *
+ * Compile the case lists of lattice functions into lookup tables
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+#include "RamLatticeFunction.h"
+#include "RamTypes.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Lookup table of a lattice function.
+ *
+ * The arguments of the function are classified by the constants the cases of
+ * the function test them against; every combination of classes selects an
+ * entry holding the cases which may match for such arguments (a decision tree
+ * of depth one per argument). Entries whose first case matches
+ * unconditionally and yields a constant or an argument are resolved without
+ * evaluating any RAM node.
+ *
+ * If the function discriminates on enum symbols, the function is in
+ * addition tabulated densely over the (finite) window of enum symbols.
+ */
+class RamLatticeFunctionTable {
+public:
+    /** Kind of a table entry */
+    enum Kind { CONSTANT, ARGUMENT, CASES };
+
+    /** A case of the function; the match is null if it holds for the whole entry */
+    struct Case {
+        const RamCondition* match;
+        const RamValue* output;
+    };
+
+    /** Entry of the table */
+    struct Entry {
+        Kind kind = CASES;
+        /** constant for CONSTANT entries, argument position for ARGUMENT entries */
+        RamDomain value = 0;
+        /** candidate cases in order for CASES entries */
+        std::vector<Case> cases;
+    };
+
+    RamLatticeFunctionTable(const std::vector<Case>& cases, size_t arity, RamDomain enumBase,
+            size_t enumSize);
+
+    /** Get arity of function */
+    size_t getArity() const {
+        return arity;
+    }
+
+    /** Get class of a value, i.e., its position among the tested constants */
+    size_t getClass(RamDomain value) const {
+        auto pos = std::lower_bound(constants.begin(), constants.end(), value);
+        return (pos != constants.end() && *pos == value) ? pos - constants.begin() : constants.size();
+    }
+
+    /** Get entry for the given arguments */
+    const Entry& getEntry(const RamDomain* args) const {
+        size_t pos = 0;
+        for (size_t i = 0; i < arity; ++i) {
+            pos = pos * (constants.size() + 1) + getClass(args[i]);
+        }
+        return entries[pos];
+    }
+
+    /** Whether a dense table ought to be computed by tabulate() */
+    bool isFinite() const {
+        return domainSize > 0;
+    }
+
+    /** Look up the dense table; returns nullptr if an argument lies outside the tabulated domain */
+    const RamDomain* lookup(const RamDomain* args) const {
+        if (table.empty()) {
+            return nullptr;
+        }
+        size_t pos = 0;
+        for (size_t i = 0; i < arity; ++i) {
+            // unsigned wrap-around maps values below the base past the end of the domain
+            size_t offset = static_cast<size_t>(args[i]) - static_cast<size_t>(domainBase);
+            if (offset >= domainSize) {
+                return nullptr;
+            }
+            pos = pos * domainSize + offset;
+        }
+        return &table[pos];
+    }
+
+    /** Compute the dense table from an evaluator of the function */
+    void tabulate(const std::function<RamDomain(const RamDomain*)>& eval);
+
+private:
+    /** arity of function */
+    size_t arity;
+
+    /** sorted constants the arguments are tested against */
+    std::vector<RamDomain> constants;
+
+    /** entries indexed by the classes of the arguments */
+    std::vector<Entry> entries;
+
+    /** first value of the densely tabulated domain */
+    RamDomain domainBase = 0;
+
+    /** number of values of the densely tabulated domain, zero if not tabulated */
+    size_t domainSize = 0;
+
+    /** dense table indexed by the offsets of the arguments */
+    std::vector<RamDomain> table;
+};
+
+/**
+ * Analysis compiling lattice functions into lookup tables
+ */
+class RamLatticeFunctionAnalysis : public RamAnalysis {
+public:
+    /** name of analysis */
+    static constexpr const char* name = "lattice-function-analysis";
+
+    /** run lattice function analysis for a RAM translation unit */
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    /** print the analysis result in HTML format */
+    void print(std::ostream& os) const override;
+
+    /** get table of a lattice function */
+    RamLatticeFunctionTable& getTable(const RamLatticeBinaryFunction& func) const {
+        return getTable(&func);
+    }
+
+    /** get table of a lattice function */
+    RamLatticeFunctionTable& getTable(const RamLatticeUnaryFunction& func) const {
+        return getTable(&func);
+    }
+
+    /** get all tables */
+    const std::map<const RamNode*, std::unique_ptr<RamLatticeFunctionTable>>& getTables() const {
+        return tables;
+    }
+
+private:
+    RamLatticeFunctionTable& getTable(const RamNode* func) const {
+        auto pos = tables.find(func);
+        assert(pos != tables.end() && "lattice function has not been analysed");
+        return *pos->second;
+    }
+
+    /** tables of lattice functions */
+    std::map<const RamNode*, std::unique_ptr<RamLatticeFunctionTable>> tables;
+};
+
+}  // end of namespace souffle
@@ -69,18 +69,20 @@ public:
 
 	/** Obtain list of child nodes */
 	std::vector<const RamNode*> getChildNodes() const override {
-		return std::vector<const RamNode*>();  // no child nodes
+		return std::vector<const RamNode*>( { ref.get() });
 	}
 
 	/** Create clone */
 	RamLatticeUnaryFunctor* clone() const override {
-		return new RamLatticeUnaryFunctor(name,
+		auto* res = new RamLatticeUnaryFunctor(name,
 				std::unique_ptr<RamValue>(ref->clone()));
+		res->func = func;
+		return res;
 	}
 
 	/** Apply mapper */
 	void apply(const RamNodeMapper& map) override {
-		//TODO
+		ref = map(std::move(ref));
 	}
 
 protected:
@@ -88,7 +90,7 @@ protected:
 	bool equal(const RamNode& node) const override {
 		assert(nullptr != dynamic_cast<const RamLatticeUnaryFunctor*>(&node));
 		const auto& other = static_cast<const RamLatticeUnaryFunctor&>(node);
-		return name == other.name && ref.get() == other.ref.get();
+		return name == other.name && *ref == *other.ref;
 	}
 };
 
@@ -213,19 +215,22 @@ public:
 
 	/** Obtain list of child nodes */
 	std::vector<const RamNode*> getChildNodes() const override {
-		return std::vector<const RamNode*>();  // no child nodes
+		return std::vector<const RamNode*>( { ref1.get(), ref2.get() });
 	}
 
 	/** Create clone */
 	RamLatticeBinaryFunctor* clone() const override {
-		return new RamLatticeBinaryFunctor(name,
+		auto* res = new RamLatticeBinaryFunctor(name,
 				std::unique_ptr<RamValue>(ref1->clone()),
 				std::unique_ptr<RamValue>(ref2->clone()));
+		res->func = func;
+		return res;
 	}
 
 	/** Apply mapper */
 	void apply(const RamNodeMapper& map) override {
-		//TODO
+		ref1 = map(std::move(ref1));
+		ref2 = map(std::move(ref2));
 	}
 
 protected:
@@ -233,8 +238,8 @@ protected:
 	bool equal(const RamNode& node) const override {
 		assert(nullptr != dynamic_cast<const RamLatticeBinaryFunctor*>(&node));
 		const auto& other = static_cast<const RamLatticeBinaryFunctor&>(node);
-		return name == other.name && ref1.get() == other.ref1.get()
-				&& ref2.get() == other.ref2.get();
+		return name == other.name && *ref1 == *other.ref1
+				&& *ref2 == *other.ref2;
 	}
 };
 
@@ -64,6 +64,7 @@ enum RamNodeType {
     RN_Scan,
     RN_IndexScan,
     RN_Aggregate,
+    RN_Intersect,
     RN_Filter,
 
     // Statements
@@ -79,7 +80,8 @@ enum RamNodeType {
 
     RN_Merge,
 	RN_LatNorm,
-	RN_LatClean,
+	RN_LatMerge,
+	RN_LatNarrow,
 //	RN_LatExt,
     RN_Swap,
 
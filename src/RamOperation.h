@@ -515,6 +515,156 @@ protected:
 	}
 };
 
+/**
+ * Multi-way intersection
+ *
+ * Enumerate the values that the given columns of several relations have in
+ * common, each under a pattern binding some of the other columns. A value is
+ * bound as element 0 of the tuple of this search. The relations are searched
+ * in the style of a leapfrog triejoin: the participants seek one another's
+ * current value in their sorted indices until all of them agree.
+ */
+class RamIntersect : public RamSearch {
+	/** Intersected relations */
+	std::vector<std::unique_ptr<RamRelationReference>> relations;
+
+	/** Patterns binding the columns of each relation (if indexable) */
+	std::vector<std::vector<std::unique_ptr<RamValue>>> patterns;
+
+	/** Intersected column of each relation */
+	std::vector<size_t> columns;
+
+public:
+	RamIntersect(std::vector<std::unique_ptr<RamRelationReference>> rels,
+			std::vector<std::vector<std::unique_ptr<RamValue>>> patterns, std::vector<size_t> columns,
+			size_t ident, std::unique_ptr<RamOperation> nested, std::string profileText = "")
+: RamSearch(RN_Intersect, ident, std::move(nested), std::move(profileText)), relations(std::move(rels)),
+  patterns(std::move(patterns)), columns(std::move(columns)) {
+		assert(relations.size() == this->patterns.size() && relations.size() == this->columns.size());
+		for (size_t i = 0; i < relations.size(); ++i) {
+			assert(this->patterns[i].size() == relations[i]->getArity());
+			assert(this->columns[i] < relations[i]->getArity() && !this->patterns[i][this->columns[i]]);
+		}
+	}
+
+	/** Get number of intersected relations */
+	size_t getNumRelations() const {
+		return relations.size();
+	}
+
+	/** Get intersected relation */
+	const RamRelationReference& getRelation(size_t i) const {
+		return *relations[i];
+	}
+
+	/** Get pattern of intersected relation */
+	std::vector<RamValue*> getPattern(size_t i) const {
+		return toPtrVector(patterns[i]);
+	}
+
+	/** Get intersected column of relation */
+	size_t getColumn(size_t i) const {
+		return columns[i];
+	}
+
+	/** Get columns of relation bound by its pattern */
+	SearchColumns getRangeQueryColumns(size_t i) const {
+		SearchColumns keys = 0;
+		for (size_t j = 0; j < patterns[i].size(); ++j) {
+			if (patterns[i][j] != nullptr) {
+				keys |= (1UL << j);
+			}
+		}
+		return keys;
+	}
+
+	/** Print */
+	void print(std::ostream& os, int tabpos) const override {
+		os << times('\t', tabpos);
+		os << "INTERSECT t" << getIdentifier() << ".0 IN ";
+		for (size_t i = 0; i < relations.size(); ++i) {
+			if (i > 0) {
+				os << " and ";
+			}
+			os << relations[i]->getName() << "(";
+			for (size_t j = 0; j < patterns[i].size(); ++j) {
+				if (j > 0) {
+					os << ",";
+				}
+				if (j == columns[i]) {
+					os << "t" << getIdentifier() << ".0";
+				} else if (patterns[i][j] != nullptr) {
+					os << *patterns[i][j];
+				} else {
+					os << "_";
+				}
+			}
+			os << ")";
+		}
+		os << '\n';
+		RamSearch::print(os, tabpos + 1);
+	}
+
+	/** Obtain list of child nodes */
+	std::vector<const RamNode*> getChildNodes() const override {
+		auto res = RamSearch::getChildNodes();
+		for (const auto& pattern : patterns) {
+			for (const auto& cur : pattern) {
+				if (cur) {
+					res.push_back(cur.get());
+				}
+			}
+		}
+		return res;
+	}
+
+	/** Create clone */
+	RamIntersect* clone() const override {
+		std::vector<std::unique_ptr<RamRelationReference>> resRelations;
+		std::vector<std::vector<std::unique_ptr<RamValue>>> resPatterns(patterns.size());
+		for (size_t i = 0; i < relations.size(); ++i) {
+			resRelations.emplace_back(relations[i]->clone());
+			for (const auto& cur : patterns[i]) {
+				resPatterns[i].emplace_back(cur == nullptr ? nullptr : cur->clone());
+			}
+		}
+		return new RamIntersect(std::move(resRelations), std::move(resPatterns), columns, getIdentifier(),
+				std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+	}
+
+	/** Apply mapper */
+	void apply(const RamNodeMapper& map) override {
+		RamSearch::apply(map);
+		for (auto& rel : relations) {
+			rel = map(std::move(rel));
+		}
+		for (auto& pattern : patterns) {
+			for (auto& cur : pattern) {
+				if (cur) {
+					cur = map(std::move(cur));
+				}
+			}
+		}
+	}
+
+protected:
+	/** Check equality */
+	bool equal(const RamNode& node) const override {
+		assert(nullptr != dynamic_cast<const RamIntersect*>(&node));
+		const auto& other = static_cast<const RamIntersect&>(node);
+		if (!RamSearch::equal(other) || relations.size() != other.relations.size() ||
+				columns != other.columns) {
+			return false;
+		}
+		for (size_t i = 0; i < relations.size(); ++i) {
+			if (*relations[i] != *other.relations[i] || !equal_targets(patterns[i], other.patterns[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
 /**
  * Filter statement
  */
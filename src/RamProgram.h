@@ -31,8 +31,8 @@ private:
 	/** Subroutines for querying computed relations */
 	std::map<std::string, std::unique_ptr<RamStatement>> subroutines;
 
-	/** Lattice association **/
-	std::unique_ptr<RamLatticeAssociation> lattice;
+	/** Lattice associations, indexed by their names **/
+	std::map<std::string, std::unique_ptr<RamLatticeAssociation>> lattices;
 
 	/** all lattice unary functions **/
 	std::map<std::string, std::shared_ptr<RamLatticeUnaryFunction>> LUFs;
@@ -73,8 +73,8 @@ public:
 		for (const auto& rel : relations) {
 			rel.second->print(out);
 		}
-		if (lattice != nullptr) {
-			lattice->print(out);
+		for (const auto& lattice : lattices) {
+			lattice.second->print(out);
 		}
 		out << "END DECLARATION " << std::endl;
 		out << "PROGRAM" << std::endl;
@@ -133,15 +133,28 @@ public:
 		return *subroutines.at(name);
 	}
 
-	/** Set lattice */
-	void setLattice(std::unique_ptr<RamLatticeAssociation> lat) {
-		lattice = std::move(lat);
+	/** Add lattice association */
+	void addLattice(const std::string& name,
+			std::unique_ptr<RamLatticeAssociation> lat) {
+		assert(lattices.find(name) == lattices.end());
+		lattices.insert(std::make_pair(name, std::move(lat)));
 	}
 
-	/** Get lattice */
-	RamLatticeAssociation* getLattice() const {
-		assert(lattice);
-		return lattice.get();
+	/** Get lattice association from its name */
+	RamLatticeAssociation* getLattice(const std::string& name) const {
+		auto it = lattices.find(name);
+		assert(it != lattices.end());
+		return it->second.get();
+	}
+
+	/** Get all lattice associations */
+	const std::map<std::string, std::unique_ptr<RamLatticeAssociation>>& getLattices() const {
+		return lattices;
+	}
+
+	/** Check whether the program defines a lattice */
+	bool hasLattice() const {
+		return !lattices.empty();
 	}
 
 	/** add lattice binary function **/
@@ -157,6 +170,11 @@ public:
 		return it == LUFs.end() ? nullptr : it->second;
 	}
 
+	/** Get all lattice unary functions */
+	const std::map<std::string, std::shared_ptr<RamLatticeUnaryFunction>>& getLUFs() const {
+		return LUFs;
+	}
+
 	/** add lattice binary function **/
 	void addLBF(std::string name,
 			std::shared_ptr<RamLatticeBinaryFunction> lbf) {
@@ -175,6 +193,11 @@ public:
 		return it == LBFs.end() ? nullptr : it->second;
 	}
 
+	/** Get all lattice binary functions */
+	const std::map<std::string, std::shared_ptr<RamLatticeBinaryFunction>>& getLBFs() const {
+		return LBFs;
+	}
+
 	/** Create clone */
 	RamProgram* clone() const override {
 		RamProgram* res = new RamProgram(
@@ -54,8 +54,7 @@ public:
 
 	/** Obtain list of child nodes */
 	std::vector<const RamNode*> getChildNodes() const override {
-		// TODO
-		return std::vector<const RamNode*>();
+		return std::vector<const RamNode*>( { cond.get(), ret1.get(), ret2.get() });
 	}
 
 	/** Create clone */
@@ -67,7 +66,9 @@ public:
 
 	/** Apply mapper */
 	void apply(const RamNodeMapper& map) override {
-		//todo
+		cond = map(std::move(cond));
+		ret1 = map(std::move(ret1));
+		ret2 = map(std::move(ret2));
 	}
 
 protected:
@@ -75,8 +76,8 @@ protected:
 	bool equal(const RamNode& node) const override {
 		assert(nullptr != dynamic_cast<const RamQuestionMark*>(&node));
 		const auto& other = static_cast<const RamQuestionMark&>(node);
-		return cond.get() == other.cond.get() && ret1.get() == other.ret1.get()
-				&& ret2.get() == other.ret2.get();
+		return *cond == *other.cond && *ret1 == *other.ret1
+				&& *ret2 == *other.ret2;
 	}
 };
 
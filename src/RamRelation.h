@@ -62,18 +62,25 @@ protected:
 	/** If the relation is a lattice relation **/
 	bool LatticeFlag;
 
+	/** Lattice associations of the trailing lattice columns of a lattice relation */
+	const std::vector<std::string> latticeAssociations;
+
 public:
 	RamRelation(const std::string name, const size_t arity,
 			const std::vector<std::string> attributeNames,
 			const std::vector<std::string> attributeTypeQualifiers,
 			const SymbolMask mask, const EnumTypeMask enumTypeMask,
 			const RelationRepresentation representation,
-			const bool latticeFlag = false) :
+			const bool latticeFlag = false,
+			const std::vector<std::string> latticeAssociations = { }) :
 			RamNode(RN_Relation), name(std::move(name)), arity(arity), attributeNames(
 					std::move(attributeNames)), attributeTypeQualifiers(
 					std::move(attributeTypeQualifiers)), mask(std::move(mask)), enumTypeMask(
 					std::move(enumTypeMask)), representation(representation), LatticeFlag(
-					latticeFlag) {
+					latticeFlag), latticeAssociations(std::move(latticeAssociations)) {
+		assert(
+				this->latticeAssociations.size() <= arity
+						&& (latticeFlag || this->latticeAssociations.empty()));
 		assert(
 				this->attributeNames.size() == arity
 						|| this->attributeNames.empty());
@@ -143,6 +150,17 @@ public:
 		return LatticeFlag;
 	}
 
+	/** Get the number of trailing lattice columns */
+	size_t getLatticeArity() const {
+		return latticeAssociations.size();
+	}
+
+	/** Get the name of the lattice association of the given lattice column */
+	const std::string& getLatticeAssociation(size_t column) const {
+		assert(column + getLatticeArity() >= arity && column < arity);
+		return latticeAssociations[column + getLatticeArity() - arity];
+	}
+
 	/* Compare two relations via their name */
 	bool operator<(const RamRelation& other) const {
 		return name < other.name;
@@ -170,7 +188,7 @@ public:
 	RamRelation* clone() const override {
 		RamRelation* res = new RamRelation(name, arity, attributeNames,
 				attributeTypeQualifiers, mask, enumTypeMask, representation,
-				LatticeFlag);
+				LatticeFlag, latticeAssociations);
 		return res;
 	}
 
@@ -188,6 +206,7 @@ protected:
 				&& attributeTypeQualifiers == other.attributeTypeQualifiers
 				&& mask == other.mask && enumTypeMask == other.enumTypeMask
 				&& representation == other.representation
+				&& latticeAssociations == other.latticeAssociations
 				&& isTemp() == other.isTemp();
 	}
 };
@@ -225,6 +244,16 @@ public:
 		return relation->isLattice();
 	}
 
+	/** Get the number of trailing lattice columns */
+	size_t getLatticeArity() const {
+		return relation->getLatticeArity();
+	}
+
+	/** Get the name of the lattice association of the given lattice column */
+	const std::string& getLatticeAssociation(size_t column) const {
+		return relation->getLatticeAssociation(column);
+	}
+
 	/** Is nullary relation */
 	const bool isNullary() const {
 		return relation->isNullary();
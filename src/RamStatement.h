@@ -378,31 +378,31 @@ protected:
 };
 
 /**
- * Clean the (temporary) new lattice relation using the original one,
- * so that only the real new elements are kept
+ * Merge the (temporary) new lattice relation into the original one,
+ * and keep the cells whose lattice element moved up as the next delta
  */
-class RamLatClean: public RamStatement {
+class RamLatMerge: public RamStatement {
 protected:
-	std::unique_ptr<RamRelationReference> IN_Origin;
+	std::unique_ptr<RamRelationReference> Origin;
 	std::unique_ptr<RamRelationReference> IN_New;
-	std::unique_ptr<RamRelationReference> OUT_New;
+	std::unique_ptr<RamRelationReference> OUT_Delta;
 
 public:
-	RamLatClean(std::unique_ptr<RamRelationReference> I_Org,
+	RamLatMerge(std::unique_ptr<RamRelationReference> org,
 			std::unique_ptr<RamRelationReference> I_n,
-			std::unique_ptr<RamRelationReference> O_n) :
-			RamStatement(RN_LatClean), IN_Origin(std::move(I_Org)), IN_New(
-					std::move(I_n)), OUT_New(std::move(O_n)) {
+			std::unique_ptr<RamRelationReference> O_d) :
+			RamStatement(RN_LatMerge), Origin(std::move(org)), IN_New(
+					std::move(I_n)), OUT_Delta(std::move(O_d)) {
 		// TODO (#541): check not just for arity also for correct type!!
 		// Introduce an equivalence type-check for two ram relations
-		assert(IN_Origin->getArity() == IN_New->getArity());
-		assert(IN_Origin->getArity() == OUT_New->getArity());
-		assert(IN_Origin->isLattice());
+		assert(Origin->getArity() == IN_New->getArity());
+		assert(Origin->getArity() == OUT_Delta->getArity());
+		assert(Origin->isLattice());
 	}
 
-	/** Get source original relation */
-	const RamRelationReference& getRelation_IN_Origin() const {
-		return *IN_Origin;
+	/** Get original relation, which is updated in place */
+	const RamRelationReference& getRelation_Origin() const {
+		return *Origin;
 	}
 
 	/** Get source "new" relation */
@@ -410,52 +410,133 @@ public:
 		return *IN_New;
 	}
 
-	/** Get target "new" relation */
-	const RamRelationReference& getRelation_OUT_New() const {
-		return *OUT_New;
+	/** Get target delta relation */
+	const RamRelationReference& getRelation_OUT_Delta() const {
+		return *OUT_Delta;
 	}
 
 	/** Pretty print */
 	void print(std::ostream& os, int tabpos) const override {
 		os << std::string(tabpos, '\t');
-		os << "LATCLEAN ";
+		os << "LATMERGE ";
 		os << IN_New->getName();
 		os << " INTO ";
-		os << OUT_New->getName();
-		os << " USING ";
-		os << IN_Origin->getName();
+		os << Origin->getName();
+		os << " DELTA ";
+		os << OUT_Delta->getName();
 	}
 
 	/** Obtain list of child nodes */
 	std::vector<const RamNode*> getChildNodes() const override {
-		return std::vector<const RamNode*>( { IN_Origin.get(), IN_New.get(),
-				OUT_New.get() });
+		return std::vector<const RamNode*>( { Origin.get(), IN_New.get(),
+				OUT_Delta.get() });
 	}
 
 	/** Create clone */
-	RamLatClean* clone() const override {
-		RamLatClean* res = new RamLatClean(
-				std::unique_ptr<RamRelationReference>(IN_Origin->clone()),
+	RamLatMerge* clone() const override {
+		RamLatMerge* res = new RamLatMerge(
+				std::unique_ptr<RamRelationReference>(Origin->clone()),
 				std::unique_ptr<RamRelationReference>(IN_New->clone()),
-				std::unique_ptr<RamRelationReference>(OUT_New->clone()));
+				std::unique_ptr<RamRelationReference>(OUT_Delta->clone()));
 		return res;
 	}
 
 	/** Apply mapper */
 	void apply(const RamNodeMapper& map) override {
-		IN_Origin = map(std::move(IN_Origin));
+		Origin = map(std::move(Origin));
 		IN_New = map(std::move(IN_New));
-		OUT_New = map(std::move(OUT_New));
+		OUT_Delta = map(std::move(OUT_Delta));
 	}
 
 protected:
 	/** Check equality */
 	bool equal(const RamNode& node) const override {
-		assert(nullptr != dynamic_cast<const RamLatClean*>(&node));
-		const auto& other = static_cast<const RamLatClean&>(node);
-		return getRelation_IN_Origin() == other.getRelation_IN_Origin()
+		assert(nullptr != dynamic_cast<const RamLatMerge*>(&node));
+		const auto& other = static_cast<const RamLatMerge&>(node);
+		return getRelation_Origin() == other.getRelation_Origin()
 				&& getRelation_IN_New() == other.getRelation_IN_New()
-				&& getRelation_OUT_New() == other.getRelation_OUT_New();
+				&& getRelation_OUT_Delta() == other.getRelation_OUT_Delta();
+	}
+};
+
+/**
+ * Narrow the original lattice relation by the (temporary) new lattice
+ * relation recomputed from it, and keep the cells whose lattice element
+ * moved down as the next delta
+ */
+class RamLatNarrow: public RamStatement {
+protected:
+	std::unique_ptr<RamRelationReference> Origin;
+	std::unique_ptr<RamRelationReference> IN_New;
+	std::unique_ptr<RamRelationReference> OUT_Delta;
+
+public:
+	RamLatNarrow(std::unique_ptr<RamRelationReference> org,
+			std::unique_ptr<RamRelationReference> I_n,
+			std::unique_ptr<RamRelationReference> O_d) :
+			RamStatement(RN_LatNarrow), Origin(std::move(org)), IN_New(
+					std::move(I_n)), OUT_Delta(std::move(O_d)) {
+		assert(Origin->getArity() == IN_New->getArity());
+		assert(Origin->getArity() == OUT_Delta->getArity());
+		assert(Origin->isLattice());
+	}
+
+	/** Get original relation, which is updated in place */
+	const RamRelationReference& getRelation_Origin() const {
+		return *Origin;
+	}
+
+	/** Get source "new" relation */
+	const RamRelationReference& getRelation_IN_New() const {
+		return *IN_New;
+	}
+
+	/** Get target delta relation */
+	const RamRelationReference& getRelation_OUT_Delta() const {
+		return *OUT_Delta;
+	}
+
+	/** Pretty print */
+	void print(std::ostream& os, int tabpos) const override {
+		os << std::string(tabpos, '\t');
+		os << "LATNARROW ";
+		os << Origin->getName();
+		os << " BY ";
+		os << IN_New->getName();
+		os << " DELTA ";
+		os << OUT_Delta->getName();
+	}
+
+	/** Obtain list of child nodes */
+	std::vector<const RamNode*> getChildNodes() const override {
+		return std::vector<const RamNode*>( { Origin.get(), IN_New.get(),
+				OUT_Delta.get() });
+	}
+
+	/** Create clone */
+	RamLatNarrow* clone() const override {
+		RamLatNarrow* res = new RamLatNarrow(
+				std::unique_ptr<RamRelationReference>(Origin->clone()),
+				std::unique_ptr<RamRelationReference>(IN_New->clone()),
+				std::unique_ptr<RamRelationReference>(OUT_Delta->clone()));
+		return res;
+	}
+
+	/** Apply mapper */
+	void apply(const RamNodeMapper& map) override {
+		Origin = map(std::move(Origin));
+		IN_New = map(std::move(IN_New));
+		OUT_Delta = map(std::move(OUT_Delta));
+	}
+
+protected:
+	/** Check equality */
+	bool equal(const RamNode& node) const override {
+		assert(nullptr != dynamic_cast<const RamLatNarrow*>(&node));
+		const auto& other = static_cast<const RamLatNarrow&>(node);
+		return getRelation_Origin() == other.getRelation_Origin()
+				&& getRelation_IN_New() == other.getRelation_IN_New()
+				&& getRelation_OUT_Delta() == other.getRelation_OUT_Delta();
 	}
 };
 
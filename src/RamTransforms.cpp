@@ -25,6 +25,7 @@
 #include "RamTypes.h"
 #include "RamValue.h"
 #include "RamVisitor.h"
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -32,6 +33,11 @@ namespace souffle {
 
 namespace {
 
+/**
+ * Get the conjuncts of a condition from left to right. Conditions rebuilt
+ * from them keep their order, such that a guard stays ahead of the lattice
+ * functions it protects (e.g. a divisor checked to be non-zero).
+ */
 std::vector<std::unique_ptr<RamCondition>> getConditions(const RamCondition* condition) {
     std::vector<std::unique_ptr<RamCondition>> conditions;
     while (condition != nullptr) {
@@ -43,6 +49,7 @@ std::vector<std::unique_ptr<RamCondition>> getConditions(const RamCondition* con
             break;
         }
     }
+    std::reverse(conditions.begin(), conditions.end());
     return conditions;
 }
 
@@ -121,7 +128,9 @@ bool LevelConditionsTransformer::levelConditions(RamProgram& program) {
         }
 
         std::unique_ptr<RamNode> operator()(std::unique_ptr<RamNode> node) const override {
-            if (auto* scan = dynamic_cast<RamScan*>(node.get())) {
+            if (nullptr != dynamic_cast<RamScan*>(node.get()) ||
+                    nullptr != dynamic_cast<RamIntersect*>(node.get())) {
+                auto* scan = static_cast<RamSearch*>(node.get());
                 RamFilterCapturer filterUpdate(context, scan->getIdentifier());
                 node->apply(filterUpdate);
 
@@ -327,91 +336,29 @@ bool ConvertExistenceChecksTransformer::convertExistenceChecks(RamProgram& progr
             return modified;
         }
 
-        bool dependsOn(const RamValue* value, const size_t identifier) const {
-            std::vector<const RamValue*> queue = {value};
-            while (!queue.empty()) {
-                const RamValue* val = queue.back();
-                queue.pop_back();
-                if (const auto* elemAccess = dynamic_cast<const RamElementAccess*>(val)) {
-                    if (context->rvla->getLevel(elemAccess) == identifier) {
-                        return true;
-                    }
-                } else if (const auto* intrinsicOp = dynamic_cast<const RamIntrinsicOperator*>(val)) {
-                    for (const RamValue* arg : intrinsicOp->getArguments()) {
-                        queue.push_back(arg);
-                    }
-                } else if (const auto* userDefinedOp = dynamic_cast<const RamUserDefinedOperator*>(val)) {
-                    for (const RamValue* arg : userDefinedOp->getArguments()) {
-                        queue.push_back(arg);
+        /** Whether a node refers to an element of the tuple of the given level */
+        bool dependsOn(const RamNode& node, const size_t identifier) const {
+            bool depends = false;
+            visitDepthFirst(node, [&](const RamElementAccess& elemAccess) {
+                if (context->rvla->getLevel(&elemAccess) == identifier) {
+                    depends = true;
+                }
+            });
+            // lattice glbs refer to the elements of tuples without child nodes
+            visitDepthFirst(node, [&](const RamLatticeGLB& glb) {
+                for (const auto& ref : *glb.getRefs()) {
+                    if (static_cast<size_t>(ref.identifier) == identifier) {
+                        depends = true;
                     }
                 }
-            }
-            return false;
-        }
-
-        bool dependsOn(const RamCondition* condition, const size_t identifier) const {
-            if (const auto* binRel = dynamic_cast<const RamConstraint*>(condition)) {
-                return dependsOn(binRel->getLHS(), identifier) || dependsOn(binRel->getRHS(), identifier);
-            }
-            return false;
+            });
+            return depends;
         }
 
         std::unique_ptr<RamNode> operator()(std::unique_ptr<RamNode> node) const override {
             if (auto* scan = dynamic_cast<RamRelationSearch*>(node.get())) {
                 const size_t identifier = scan->getIdentifier();
-                bool isExistCheck = true;
-                visitDepthFirst(scan->getOperation(), [&](const RamFilter& filter) {
-                    if (isExistCheck) {
-                        for (auto& c : getConditions(&filter.getCondition())) {
-                            if (dependsOn(c.get(), identifier)) {
-                                isExistCheck = false;
-                                break;
-                            }
-                        }
-                    }
-                });
-                if (isExistCheck) {
-                    visitDepthFirst(scan->getOperation(), [&](const RamIndexScan& indexScan) {
-                        if (isExistCheck) {
-                            for (const RamValue* value : indexScan.getRangePattern()) {
-                                if (value != nullptr && !context->rcva->isConstant(value) &&
-                                        dependsOn(value, identifier)) {
-                                    isExistCheck = false;
-                                    break;
-                                }
-                            }
-                        }
-                    });
-                }
-                if (isExistCheck) {
-                    visitDepthFirst(scan->getOperation(), [&](const RamProject& project) {
-                        if (isExistCheck) {
-                            std::vector<const RamValue*> values;
-                            // TODO: function to extend vectors
-                            const std::vector<RamValue*> initialVals = project.getValues();
-                            values.insert(values.end(), initialVals.begin(), initialVals.end());
-
-                            while (!values.empty()) {
-                                const RamValue* value = values.back();
-                                values.pop_back();
-
-                                if (const auto* pack = dynamic_cast<const RamPack*>(value)) {
-                                    const std::vector<RamValue*> args = pack->getArguments();
-                                    values.insert(values.end(), args.begin(), args.end());
-                                } else if (const auto* intrinsicOp =
-                                                   dynamic_cast<const RamIntrinsicOperator*>(value)) {
-                                    for (auto* arg : intrinsicOp->getArguments()) {
-                                        values.push_back(arg);
-                                    }
-                                } else if (value != nullptr && !context->rcva->isConstant(value) &&
-                                           context->rvla->getLevel(value) == identifier) {
-                                    isExistCheck = false;
-                                    break;
-                                }
-                            }
-                        }
-                    });
-                }
+                bool isExistCheck = !dependsOn(scan->getOperation(), identifier);
                 if (isExistCheck) {
                     visitDepthFirst(scan->getOperation(), [&](const RamLookup& lookup) {
                         if (isExistCheck) {
@@ -421,19 +368,6 @@ bool ConvertExistenceChecksTransformer::convertExistenceChecks(RamProgram& progr
                         }
                     });
                 }
-                if (isExistCheck) {
-                    visitDepthFirst(scan->getOperation(), [&](const RamExistenceCheck& exists) {
-                        if (isExistCheck) {
-                            for (const RamValue* value : exists.getValues()) {
-                                if (value != nullptr && !context->rcva->isConstant(value) &&
-                                        dependsOn(value, identifier)) {
-                                    isExistCheck = false;
-                                    break;
-                                }
-                            }
-                        }
-                    });
-                }
                 if (isExistCheck) {
                     // create constraint
                     std::unique_ptr<RamCondition> constraint;
@@ -458,6 +392,7 @@ bool ConvertExistenceChecksTransformer::convertExistenceChecks(RamProgram& progr
                     node = std::make_unique<RamFilter>(std::move(constraint),
                             std::unique_ptr<RamOperation>(scan->getOperation().clone()),
                             scan->getProfileText());
+                    modified = true;
                 }
             }
             node->apply(*this);
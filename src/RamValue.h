@@ -384,13 +384,14 @@ public:
 	/** Print */
 	void print(std::ostream& os) const override {
 		os << "glb( ";
-		auto it = references.begin();
-		os << "t" << it->identifier << "." << it->relation->getArg(it->element);
-		it++;
-		while (it != references.end()) {
-			os << ", t" << it->identifier << "."
-					<< it->relation->getArg(it->element);
-			it++;
+		for (auto it = references.begin(); it != references.end(); it++) {
+			os << (it == references.begin() ? "t" : ", t") << it->identifier << ".";
+			// the elements of unpacked records have no relation
+			if (it->relation != nullptr) {
+				os << it->relation->getArg(it->element);
+			} else {
+				os << it->element;
+			}
 		}
 		os << " )";
 
@@ -405,6 +406,13 @@ public:
 		return &references;
 	}
 
+	/** Get the name of the lattice association of the referenced elements */
+	const std::string& getLatticeAssociation() const {
+		assert(!references.empty() && references[0].relation != nullptr);
+		return references[0].relation->getLatticeAssociation(
+				references[0].element);
+	}
+
 //	const RamLatticeAssociation* getLatticeAssociation() const {
 //		return lattice.get();
 //	}
@@ -428,7 +436,7 @@ protected:
 	bool equal(const RamNode& node) const override {
 		assert(nullptr != dynamic_cast<const RamLatticeGLB*>(&node));
 		const auto& other = static_cast<const RamLatticeGLB&>(node);
-		return getRefs() == other.getRefs();
+		return references == other.references;
 	}
 };
 
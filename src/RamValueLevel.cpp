@@ -15,6 +15,8 @@
  ***********************************************************************/
 
 #include "RamValueLevel.h"
+#include "RamLatticeFunctor.h"
+#include "RamQuestionMark.h"
 #include "RamVisitor.h"
 #include <algorithm>
 
@@ -35,6 +37,32 @@ size_t RamValueLevelAnalysis::getLevel(const RamValue* value) const {
             return elem.getIdentifier();
         }
 
+        // greatest lower bound of lattice elements of tuples
+        size_t visitLatticeGLB(const RamLatticeGLB& glb) override {
+            size_t level = 0;
+            for (const auto& ref : *glb.getRefs()) {
+                level = std::max(level, static_cast<size_t>(ref.identifier));
+            }
+            return level;
+        }
+
+        // lattice functors
+        size_t visitLatticeUnaryFunctor(const RamLatticeUnaryFunctor& op) override {
+            return visit(op.getRef());
+        }
+
+        size_t visitLatticeBinaryFunctor(const RamLatticeBinaryFunctor& op) override {
+            return std::max(visit(op.getRef1()), visit(op.getRef2()));
+        }
+
+        // question mark, leveled by the values of its condition and its results
+        size_t visitQuestionMark(const RamQuestionMark& qmark) override {
+            size_t level = std::max(visit(qmark.getFirstRet()), visit(qmark.getSecondRet()));
+            visitDepthFirst(qmark.getCondition(),
+                    [&](const RamValue& value) { level = std::max(level, visit(value)); });
+            return level;
+        }
+
         // auto increment
         size_t visitAutoIncrement(const RamAutoIncrement& increment) override {
             return 0;
@@ -116,6 +116,7 @@ struct RamVisitor : public ram_visitor_tag {
             FORWARD(Scan);
             FORWARD(IndexScan);
             FORWARD(Aggregate);
+            FORWARD(Intersect);
 
             // statements
             FORWARD(Create);
@@ -129,7 +130,8 @@ struct RamVisitor : public ram_visitor_tag {
 
             FORWARD(Merge);
             FORWARD(LatNorm);
-            FORWARD(LatClean);
+            FORWARD(LatMerge);
+            FORWARD(LatNarrow);
 //            FORWARD(LatExt);
             FORWARD(Swap);
 
@@ -185,7 +187,8 @@ protected:
 
     LINK(Merge, Statement);
     LINK(LatNorm, Statement);
-    LINK(LatClean, Statement);
+    LINK(LatMerge, Statement);
+    LINK(LatNarrow, Statement);
 //    LINK(LatExt, Statement);
     LINK(Swap, Statement);
 
@@ -207,6 +210,7 @@ protected:
     LINK(IndexScan, RelationSearch);
     LINK(RelationSearch, Search);
     LINK(Aggregate, Search);
+    LINK(Intersect, Search);
     LINK(Search, NestedOperation);
     LINK(Filter, NestedOperation);
     LINK(NestedOperation, Operation);
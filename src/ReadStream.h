@@ -20,7 +20,9 @@
 #include "EnumTypeMask.h"
 #include "SymbolTable.h"
 
+#include <exception>
 #include <memory>
+#include <vector>
 
 namespace souffle {
 
@@ -33,9 +35,9 @@ public:
     void readAll(T& relation) {
         auto lease = symbolTable.acquireLock();
         (void)lease;
-        while (const auto next = readNextTuple()) {
-            const RamDomain* ramDomain = next.get();
-            relation.insert(ramDomain);
+        std::vector<RamDomain> tuples;
+        while (size_t num = readNextTuples(tuples)) {
+            insertTuples(relation, tuples.data(), num, 0);
         }
     }
 
@@ -43,11 +45,71 @@ public:
 
 protected:
     virtual std::unique_ptr<RamDomain[]> readNextTuple() = 0;
+
+    /**
+     * Read the next block of tuples, stored consecutively in the given vector.
+     *
+     * Returns the number of tuples read, which is zero at the end of the input.
+     * An error of the input is thrown once the tuples read before it are returned.
+     */
+    virtual size_t readNextTuples(std::vector<RamDomain>& tuples) {
+        throwError();
+        const size_t width = symbolMask.getArity();
+        tuples.clear();
+        size_t num = 0;
+        while (num < 1024) {
+            std::unique_ptr<RamDomain[]> next;
+            try {
+                next = readNextTuple();
+            } catch (...) {
+                if (num == 0) {
+                    throw;
+                }
+                error = std::current_exception();
+                break;
+            }
+            if (!next) {
+                break;
+            }
+            tuples.insert(tuples.end(), next.get(), next.get() + width);
+            ++num;
+        }
+        return num;
+    }
+
+    /** Throw the error deferred by readNextTuples, if any */
+    void throwError() {
+        if (error) {
+            std::exception_ptr pending = error;
+            error = nullptr;
+            std::rethrow_exception(pending);
+        }
+    }
+
     const SymbolMask& symbolMask;
     const EnumTypeMask& enumTypeMask;
     SymbolTable& symbolTable;
     const bool isProvenance;
     const uint8_t arity;
+    // error of the input deferred until the tuples read before it are returned
+    std::exception_ptr error;
+
+private:
+    /** Insert a block of tuples into a relation accepting batches */
+    template <typename T>
+    static auto insertTuples(T& relation, const RamDomain* tuples, size_t num, int)
+            -> decltype(relation.insertBatch(tuples, num), void()) {
+        relation.insertBatch(tuples, num);
+    }
+
+    /** Insert a block of tuples into a relation one by one */
+    template <typename T>
+    void insertTuples(T& relation, const RamDomain* tuples, size_t num, long) {
+        const size_t width = symbolMask.getArity();
+        for (size_t i = 0; i < num; ++i) {
+            relation.insert(tuples + i * width);
+        }
+    }
 };
 
 class ReadStreamFactory {
@@ -0,0 +1,247 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BinaryFormat.h"
+#include "EnumTypeMask.h"
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "ReadStream.h"
+#include "SymbolMask.h"
+#include "SymbolTable.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace souffle {
+
+class ReadFileBinary : public ReadStream {
+public:
+    ReadFileBinary(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask, SymbolTable& symbolTable,
+            const IODirectives& ioDirectives, const bool provenance = false)
+            : ReadStream(symbolMask, enumTypeMask, symbolTable, provenance),
+              baseName(souffle::baseName(ioDirectives.getFileName())) {
+        int fd = open(ioDirectives.getFileName().c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (ioDirectives.has("intermediate")) {
+                return;
+            }
+            throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(BinaryHeader)) {
+            mappedSize = info.st_size;
+            void* data = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                mapped = static_cast<const char*>(data);
+            }
+        }
+        close(fd);
+        if (mapped == nullptr) {
+            throw std::invalid_argument("Cannot read binary fact file " + baseName + "\n");
+        }
+        try {
+            readHeader();
+        } catch (...) {
+            munmap(const_cast<char*>(mapped), mappedSize);
+            throw;
+        }
+    }
+
+    ~ReadFileBinary() override {
+        if (mapped != nullptr) {
+            munmap(const_cast<char*>(mapped), mappedSize);
+        }
+    }
+
+protected:
+    /**
+     * Read and return the next tuple.
+     *
+     * Returns nullptr if no tuple was readable.
+     * @return
+     */
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        if (nextBuffered == numBuffered) {
+            numBuffered = readNextTuples(buffer);
+            nextBuffered = 0;
+            if (numBuffered == 0) {
+                return nullptr;
+            }
+        }
+        const size_t width = symbolMask.getArity();
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(width);
+        std::copy_n(buffer.data() + nextBuffered * width, width, tuple.get());
+        ++nextBuffered;
+        return tuple;
+    }
+
+    /** Read the next block of the file, mapping the symbols of the file to the symbol table */
+    size_t readNextTuples(std::vector<RamDomain>& tuples) override {
+        if (mapped == nullptr) {
+            return 0;
+        }
+        if (position == symbolSegment) {
+            if (numRead != header.numTuples) {
+                invalid();
+            }
+            return 0;
+        }
+        if (symbolIDs.size() != numSymbols) {
+            readSymbols();
+        }
+        const size_t width = header.arity;
+        const uint64_t num = readValue(position, symbolSegment);
+        // the number of tuples is checked against the rest of the file before it is multiplied
+        const size_t tupleSize = width * sizeof(RamDomain);
+        if (num > header.numTuples - numRead ||
+                (tupleSize > 0 && num > static_cast<size_t>(symbolSegment - position) / tupleSize)) {
+            invalid();
+        }
+        const size_t columnSize = num * sizeof(RamDomain);
+        numRead += num;
+        tuples.resize(std::max<size_t>(num * width, 1));
+        for (size_t col = 0; col < width; ++col) {
+            const auto* values = reinterpret_cast<const RamDomain*>(position + col * columnSize);
+            if (symbolMask.isSymbol(col) || enumTypeMask.isEnumType(col)) {
+                for (size_t i = 0; i < num; ++i) {
+                    if (static_cast<uint64_t>(values[i]) >= numSymbols) {
+                        invalid();
+                    }
+                    tuples[i * width + col] = symbolIDs[values[i]];
+                }
+                // elements of enum types are stored as symbols and must be elements in this program
+                if (enumTypeMask.isEnumType(col)) {
+                    for (size_t i = 0; i < num; ++i) {
+                        if (!symbolTable.isEnumSymbol(tuples[i * width + col])) {
+                            throw std::invalid_argument("Binary fact file " + baseName + " holds <" +
+                                                        symbolTable.unsafeResolve(tuples[i * width + col]) +
+                                                        ">, which is not an element of the enum type of column " +
+                                                        std::to_string(col + 1) + "\n");
+                        }
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < num; ++i) {
+                    tuples[i * width + col] = values[i];
+                }
+            }
+        }
+        position += width * columnSize;
+        return num;
+    }
+
+    /** Check the header and the masks of the file against the relation */
+    void readHeader() {
+        std::memcpy(&header, mapped, sizeof(header));
+        if (!header.isValid() || header.symbolOffset > mappedSize ||
+                sizeof(header) + header.getMaskSize() > header.symbolOffset) {
+            invalid();
+        }
+        if (header.arity != symbolMask.getArity()) {
+            throw std::invalid_argument("Binary fact file " + baseName + " has arity " +
+                                        std::to_string(header.arity) + " instead of " +
+                                        std::to_string(symbolMask.getArity()) + "\n");
+        }
+        const char* masks = mapped + sizeof(header);
+        for (size_t col = 0; col < header.arity; ++col) {
+            if ((masks[col] != 0) != symbolMask.isSymbol(col)) {
+                throw std::invalid_argument("Symbol columns of binary fact file " + baseName +
+                                            " do not match the relation\n");
+            }
+            if ((masks[header.arity + col] != 0) != enumTypeMask.isEnumType(col)) {
+                throw std::invalid_argument("Enum columns of binary fact file " + baseName +
+                                            " do not match the relation\n");
+            }
+        }
+        position = masks + header.getMaskSize();
+        symbolSegment = mapped + header.symbolOffset;
+        const char* segment = symbolSegment;
+        numSymbols = readValue(segment, mapped + mappedSize);
+    }
+
+    /** Insert the symbols of the file into the symbol table, in the order of the file */
+    void readSymbols() {
+        const char* end = mapped + mappedSize;
+        const char* cur = symbolSegment + sizeof(uint64_t);
+        symbolIDs.reserve(numSymbols);
+        for (uint64_t i = 0; i < numSymbols; ++i) {
+            uint64_t length = readValue(cur, end);
+            if (static_cast<uint64_t>(end - cur) < length) {
+                invalid();
+            }
+            symbolIDs.push_back(symbolTable.unsafeLookup(std::string(cur, length)));
+            cur += length;
+        }
+    }
+
+    /** Read a 64-bit value and advance the position past it */
+    uint64_t readValue(const char*& cur, const char* end) const {
+        uint64_t value;
+        if (static_cast<size_t>(end - cur) < sizeof(value)) {
+            invalid();
+        }
+        std::memcpy(&value, cur, sizeof(value));
+        cur += sizeof(value);
+        return value;
+    }
+
+    [[noreturn]] void invalid() const {
+        throw std::invalid_argument("Invalid binary fact file " + baseName + "\n");
+    }
+
+    std::string baseName;
+    BinaryHeader header;
+    // the mapped file, the next block and the symbol segment
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    const char* position = nullptr;
+    const char* symbolSegment = nullptr;
+    // the number of tuples of the blocks read so far
+    uint64_t numRead = 0;
+    // the indices in the symbol table of the symbols of the file
+    uint64_t numSymbols = 0;
+    std::vector<RamDomain> symbolIDs;
+    // a block buffered for readNextTuple
+    std::vector<RamDomain> buffer;
+    size_t numBuffered = 0;
+    size_t nextBuffered = 0;
+};
+
+class ReadFileBinaryFactory : public ReadStreamFactory {
+public:
+    std::unique_ptr<ReadStream> getReader(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask,
+            SymbolTable& symbolTable, const IODirectives& ioDirectives, const bool provenance) override {
+        return std::make_unique<ReadFileBinary>(symbolMask, enumTypeMask, symbolTable, ioDirectives, provenance);
+    }
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+    ~ReadFileBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -28,11 +28,25 @@
 #include <fstream>
 #endif
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <exception>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace souffle {
 
@@ -92,8 +106,7 @@ protected:
                 continue;
             }
             ++columnsFilled;
-            // Qing Gong: TODO -- not correct!
-            if (symbolMask.isSymbol(column)) {
+            if (symbolMask.isSymbol(inputMap[column])) {
                 tuple[inputMap[column]] = symbolTable.unsafeLookup(element);
             } else {
                 try {
@@ -160,16 +173,20 @@ public:
             : ReadStreamCSV(fileHandle, symbolMask, enumTypeMask, symbolTable, ioDirectives, provenance),
               baseName(souffle::baseName(getFileName(ioDirectives))),
               fileHandle(getFileName(ioDirectives), std::ios::in | std::ios::binary) {
+        bool headers = ioDirectives.has("headers") && ioDirectives.get("headers") == "true";
         if (!ioDirectives.has("intermediate")) {
             if (!fileHandle.is_open()) {
                 throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
             }
             // Strip headers if we're using them
-            if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
+            if (headers) {
                 std::string line;
                 getline(file, line);
             }
         }
+        if (fileHandle.is_open()) {
+            mapFile(getFileName(ioDirectives), headers);
+        }
     }
     /**
      * Read and return the next tuple.
@@ -188,9 +205,244 @@ public:
         }
     }
 
-    ~ReadFileCSV() override = default;
+    ~ReadFileCSV() override {
+        if (mapped != nullptr) {
+            munmap(const_cast<char*>(mapped), mappedSize);
+        }
+    }
 
 protected:
+    /** Number of bytes of the file parsed by a task */
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    /** Tuples parsed from a line-aligned chunk of the file */
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        // the parsed tuples, stored consecutively
+        std::vector<RamDomain> tuples;
+        // symbols in the order of their fields and the positions of their fields in the tuples
+        std::vector<std::string> symbols;
+        std::vector<size_t> symbolFields;
+        size_t numTuples = 0;
+        // error message of the first malformed line, and the line within the chunk
+        std::string error;
+        size_t errorLine = 0;
+    };
+
+    /**
+     * Read the next block of tuples. A plain file is mapped into memory and
+     * parsed by threads in line-aligned chunks; compressed files and other
+     * streams are read line by line.
+     */
+    size_t readNextTuples(std::vector<RamDomain>& tuples) override {
+        if (mapped == nullptr) {
+            return ReadStreamCSV::readNextTuples(tuples);
+        }
+        while (true) {
+            while (nextChunk == chunks.size()) {
+                if (position == mapped + mappedSize) {
+                    throwError();
+                    return 0;
+                }
+                parseChunks();
+            }
+            Chunk& chunk = chunks[nextChunk++];
+            if (chunk.numTuples > 0) {
+                tuples.swap(chunk.tuples);
+                std::vector<RamDomain>().swap(chunk.tuples);
+                return chunk.numTuples;
+            }
+        }
+    }
+
+    /** Map a plain file into memory, unless it is empty or compressed */
+    void mapFile(const std::string& fileName, bool headers) {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            mappedSize = info.st_size;
+            void* data = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                mapped = static_cast<const char*>(data);
+            }
+        }
+        close(fd);
+        if (mapped == nullptr) {
+            return;
+        }
+        // gzip streams start with the bytes 0x1f 0x8b and are decompressed by the file stream
+        if (mappedSize >= 2 && mapped[0] == '\x1f' && mapped[1] == '\x8b') {
+            munmap(const_cast<char*>(mapped), mappedSize);
+            mapped = nullptr;
+            return;
+        }
+        madvise(const_cast<char*>(mapped), mappedSize, MADV_SEQUENTIAL);
+        position = mapped;
+        if (headers) {
+            const char* eol = static_cast<const char*>(std::memchr(position, '\n', mappedSize));
+            position = (eol != nullptr) ? eol + 1 : mapped + mappedSize;
+        }
+    }
+
+    /** Parse the chunks of the next part of the file in parallel, interning their symbols in file order */
+    void parseChunks() {
+        size_t numThreads = 1;
+#ifdef _OPENMP
+        numThreads = omp_get_max_threads();
+#endif
+        const char* fileEnd = mapped + mappedSize;
+        chunks.clear();
+        nextChunk = 0;
+        while (position != fileEnd && chunks.size() < 4 * numThreads) {
+            const char* end = position + std::min<size_t>(CHUNK_SIZE, fileEnd - position);
+            if (end != fileEnd) {
+                const char* eol = static_cast<const char*>(std::memchr(end, '\n', fileEnd - end));
+                end = (eol != nullptr) ? eol + 1 : fileEnd;
+            }
+            chunks.emplace_back();
+            chunks.back().begin = position;
+            chunks.back().end = end;
+            position = end;
+        }
+
+#ifndef USE_MPI
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t i = 0; i < chunks.size(); i++) {
+            parseChunk(chunks[i]);
+        }
+
+        // symbols are numbered in the order of the file; the first malformed line is
+        // reported once the tuples of the lines before it are read
+        for (size_t i = 0; i < chunks.size(); i++) {
+            Chunk& chunk = chunks[i];
+            symbolTable.insert(chunk.symbols);
+            if (!chunk.error.empty()) {
+                std::stringstream errorMessage;
+                errorMessage << chunk.error << " in line " << lineNumber + chunk.errorLine << "; ";
+                errorMessage << "cannot parse fact file " << baseName << "!\n";
+                error = std::make_exception_ptr(std::invalid_argument(errorMessage.str()));
+                chunks.resize(i + 1);
+                position = fileEnd;
+                break;
+            }
+            lineNumber += chunk.numTuples;
+        }
+
+#ifndef USE_MPI
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t i = 0; i < chunks.size(); i++) {
+            Chunk& chunk = chunks[i];
+            for (size_t j = 0; j < chunk.symbolFields.size(); j++) {
+                chunk.tuples[chunk.symbolFields[j]] = symbolTable.lookupExisting(chunk.symbols[j]);
+            }
+            std::vector<std::string>().swap(chunk.symbols);
+        }
+    }
+
+    /** Parse the lines of a chunk, in the way readNextTuple parses a line */
+    void parseChunk(Chunk& chunk) const {
+        const size_t width = symbolMask.getArity();
+        const char* line = chunk.begin;
+        while (line != chunk.end) {
+            const char* eol = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+            const char* next = (eol != nullptr) ? eol + 1 : chunk.end;
+            const char* lineEnd = (eol != nullptr) ? eol : chunk.end;
+            // Handle Windows line endings on non-Windows systems
+            if (lineEnd != line && lineEnd[-1] == '\r') {
+                --lineEnd;
+            }
+            size_t base = chunk.tuples.size();
+            size_t fields = chunk.symbolFields.size();
+            chunk.tuples.resize(base + width, 0);
+
+            const char* start = line;
+            size_t columnsFilled = 0;
+            for (uint32_t column = 0; columnsFilled < arity; column++) {
+                if (start > lineEnd) {
+                    discardLine(chunk, "Values missing", base, fields);
+                    return;
+                }
+                const char* end = findDelimiter(start, lineEnd);
+                const char* element = start;
+                start = end + delimiter.size();
+                auto target = inputMap.find(column);
+                if (target == inputMap.end()) {
+                    continue;
+                }
+                ++columnsFilled;
+                if (symbolMask.isSymbol(target->second)) {
+                    chunk.symbols.emplace_back(element, end);
+                    chunk.symbolFields.push_back(base + target->second);
+                } else if (!parseNumber(element, end, chunk.tuples[base + target->second])) {
+                    std::stringstream errorMessage;
+                    errorMessage << "Error converting number <" << std::string(element, end) << "> in column "
+                                 << column + 1;
+                    discardLine(chunk, errorMessage.str(), base, fields);
+                    return;
+                }
+            }
+            ++chunk.numTuples;
+            line = next;
+        }
+    }
+
+    /**
+     * Record the error of a malformed line and drop its tuple; the symbols of the line
+     * are still interned, like the stream parser does before it fails
+     */
+    static void discardLine(Chunk& chunk, const std::string& error, size_t base, size_t fields) {
+        chunk.error = error;
+        chunk.errorLine = chunk.numTuples + 1;
+        chunk.tuples.resize(base);
+        chunk.symbolFields.resize(fields);
+    }
+
+    /** Find the next delimiter of a line, or the end of the line */
+    const char* findDelimiter(const char* start, const char* lineEnd) const {
+        if (delimiter.size() == 1) {
+            const void* pos = std::memchr(start, delimiter[0], lineEnd - start);
+            return (pos != nullptr) ? static_cast<const char*>(pos) : lineEnd;
+        }
+        return std::search(start, lineEnd, delimiter.begin(), delimiter.end());
+    }
+
+    /**
+     * Parse a number from the start of a field like std::stoll (std::stoi for 32-bit domains): leading
+     * white space is skipped, at least one digit is required, and characters after the digits are
+     * ignored. Returns false if there is no number or it is out of the range of the domain.
+     */
+    static bool parseNumber(const char* pos, const char* end, RamDomain& result) {
+        while (pos != end && std::isspace(static_cast<unsigned char>(*pos))) {
+            ++pos;
+        }
+        bool negative = false;
+        if (pos != end && (*pos == '+' || *pos == '-')) {
+            negative = (*pos == '-');
+            ++pos;
+        }
+        if (pos == end || *pos < '0' || *pos > '9') {
+            return false;
+        }
+        // accumulate the negated value, which covers the minimum of the domain
+        const int64_t min = negative ? MIN_RAM_DOMAIN : -static_cast<int64_t>(MAX_RAM_DOMAIN);
+        int64_t value = 0;
+        for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos) {
+            int digit = *pos - '0';
+            if (value < (min + digit) / 10) {
+                return false;
+            }
+            value = value * 10 - digit;
+        }
+        result = static_cast<RamDomain>(negative ? value : -value);
+        return true;
+    }
+
     std::string getFileName(const IODirectives& ioDirectives) const {
         if (ioDirectives.has("filename")) {
             return ioDirectives.get("filename");
@@ -203,6 +455,14 @@ protected:
 #else
     std::ifstream fileHandle;
 #endif
+    // the mapped file, or nullptr if the file is read from the stream
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    // the start of the part of the file not parsed yet
+    const char* position = nullptr;
+    // the chunks parsed last and the next one to be returned
+    std::vector<Chunk> chunks;
+    size_t nextChunk = 0;
 };
 
 class ReadCinCSVFactory : public ReadStreamFactory {
@@ -25,7 +25,9 @@
 #include "AstTranslationUnit.h"
 #include "AstVisitor.h"
 #include "Global.h"
+#include <algorithm>
 #include <cmath>
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -353,6 +355,102 @@ bool reorderClauseWithSips(sips_t sipsFunction, AstClause* clause) {
     return false;
 }
 
+/**
+ * Determines whether the body atoms of a clause should be joined by a multi-way
+ * join rather than by nested loops. This is the case if the hypergraph with the
+ * variables as vertices and the atoms as edges is cyclic (e.g. a triangle
+ * a(x,y), b(y,z), c(x,z)), where any order of nested loops may enumerate far
+ * more partial bindings than there are results.
+ *
+ * Only clauses of three or more atoms with plain, pairwise distinct variables
+ * as arguments, without aggregates, records and lattice relations, and with
+ * every variable bound by some atom qualify.
+ */
+bool isCyclicJoin(const AstClause* clause, const AstProgram& program) {
+    if (!clause->isRule() || clause->hasFixedExecutionPlan() || clause->getExecutionPlan() != nullptr) {
+        return false;
+    }
+
+    const auto& atoms = clause->getAtoms();
+    if (atoms.size() < 3) {
+        return false;
+    }
+
+    // collect the variables of each atom
+    std::vector<std::set<std::string>> edges;
+    for (const AstAtom* atom : atoms) {
+        std::set<std::string> edge;
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                if (!edge.insert(var->getName()).second) {
+                    return false;
+                }
+            } else if (dynamic_cast<const AstUnnamedVariable*>(arg) == nullptr) {
+                return false;
+            }
+        }
+        if (edge.empty()) {
+            return false;
+        }
+        edges.push_back(edge);
+    }
+
+    // all variables must be bound by the atoms
+    bool supported = true;
+    visitDepthFirst(*clause, [&](const AstVariable& var) {
+        if (std::none_of(edges.begin(), edges.end(),
+                    [&](const std::set<std::string>& edge) { return edge.count(var.getName()) > 0; })) {
+            supported = false;
+        }
+    });
+    visitDepthFirst(*clause, [&](const AstAggregator&) { supported = false; });
+    visitDepthFirst(*clause, [&](const AstRecordInit&) { supported = false; });
+    visitDepthFirst(*clause, [&](const AstAtom& atom) {
+        const AstRelation* rel = program.getRelation(atom.getName());
+        if (rel == nullptr || rel->isLattice()) {
+            supported = false;
+        }
+    });
+    if (!supported) {
+        return false;
+    }
+
+    // GYO reduction: remove variables of a single atom and atoms contained in others
+    bool reduced = true;
+    while (reduced && edges.size() > 1) {
+        reduced = false;
+        std::map<std::string, int> occurrences;
+        for (const auto& edge : edges) {
+            for (const auto& var : edge) {
+                occurrences[var]++;
+            }
+        }
+        for (auto& edge : edges) {
+            for (auto it = edge.begin(); it != edge.end();) {
+                if (occurrences[*it] == 1) {
+                    it = edge.erase(it);
+                    reduced = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (size_t i = 0; i < edges.size(); i++) {
+            for (size_t j = 0; j < edges.size(); j++) {
+                if (i != j && std::includes(edges[j].begin(), edges[j].end(), edges[i].begin(),
+                                      edges[i].end())) {
+                    edges.erase(edges.begin() + i);
+                    reduced = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // the hypergraph is cyclic iff the reduction gets stuck
+    return edges.size() > 1;
+}
+
 bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit) {
     bool changed = false;
     AstProgram& program = *translationUnit.getProgram();
@@ -425,6 +523,20 @@ bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit)
         }
     }
 
+    // --- multi-way joins for cyclic clauses ---
+    // (provenance relies on the nested loops of the atoms)
+    if (!Global::config().has("provenance")) {
+        for (const AstRelation* rel : program.getRelations()) {
+            for (AstClause* clause : rel->getClauses()) {
+                bool cyclic = isCyclicJoin(clause, program);
+                if (cyclic != clause->usesMultiwayJoin()) {
+                    clause->setMultiwayJoin(cyclic);
+                    changed = true;
+                }
+            }
+        }
+    }
+
     return changed;
 }
 
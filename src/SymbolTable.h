@@ -27,10 +27,12 @@
 #include <thread>
 #endif
 
+#include <atomic>
 #include <cassert>
-#include <deque>
+#include <cstring>
 #include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -180,35 +182,209 @@ private:
 	/** A lock to synchronize parallel accesses */
 	mutable Lock access;
 
-	/** Map indices to strings. */
-	//std::deque<std::string> numToStr;
-	std::unordered_map<size_t, std::string> numToStr;
+	/** Number of strings in the first segment of the dense storage, a power of two */
+	static constexpr size_t FIRST_SEGMENT_BITS = 10;
 
-	/** Map strings to indices. */
-	std::unordered_map<std::string, size_t> strToNum;
+	/** Number of segments of the dense storage, each twice as big as the previous one */
+	static constexpr size_t NUM_SEGMENTS = 64 - FIRST_SEGMENT_BITS;
 
-	/** Convenience method to place a new symbol in the table, if it does not exist, and return the index of
-	 * it. */
-	inline size_t newSymbolOfIndex(const std::string& symbol) {
-		size_t index;
-		auto it = strToNum.find(symbol);
-		if (it == strToNum.end()) {
-			index = numToStr.size();
-			strToNum[symbol] = index;
-			//numToStr.push_back(symbol);
-			numToStr[index] = symbol;
-		} else {
+	/** Number of shards of the map from strings to indices */
+	static constexpr size_t NUM_SHARDS = 64;
+
+	/** A string in the map to indices; keys of the map point into the dense storage */
+	struct Key {
+		const char* data;
+		size_t length;
+		size_t hash;
+
+		Key(const std::string& symbol) :
+				data(symbol.data()), length(symbol.size()), hash(hashOf(data, length)) {
+		}
+
+		bool operator==(const Key& other) const {
+			return hash == other.hash && length == other.length
+					&& std::memcmp(data, other.data, length) == 0;
+		}
+
+		/** FNV-1a hash of the characters of a string */
+		static size_t hashOf(const char* data, size_t length) {
+			uint64_t hash = 14695981039346656037ULL;
+			for (size_t i = 0; i < length; i++) {
+				hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+			}
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			return key.hash;
+		}
+	};
+
+	/** A part of the map from strings to indices, guarded by its own lock */
+	struct Shard {
+		Lock lock;
+		std::unordered_map<Key, size_t, KeyHash> strToNum;
+	};
+
+	/** A string of the dense storage */
+	struct Slot {
+		std::string symbol;
+		/** Set once the string is written; an index is only resolved to a ready slot */
+		std::atomic<bool> ready{false};
+	};
+
+	/**
+	 * The symbols of the table. Strings are appended to segments that are never
+	 * moved, such that indices are resolved without locking; the map from strings
+	 * to indices is split into shards, such that insertions of different strings
+	 * rarely wait for each other.
+	 */
+	struct Store {
+		/** Segments of the dense storage of strings by index */
+		std::atomic<Slot*> segments[NUM_SEGMENTS];
+
+		/** Number of strings in the dense storage */
+		std::atomic<size_t> next{0};
+
+		/** Shards of the map from strings to indices */
+		Shard shards[NUM_SHARDS];
+
+		/** Strings of the enum symbols by their offset in the window of enum symbols, which is
+		 * the dense index they were inserted at */
+		std::vector<const std::string*> enumToStr;
+
+		Store() {
+			for (auto& cur : segments) {
+				cur.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~Store() {
+			for (auto& cur : segments) {
+				delete[] cur.load(std::memory_order_relaxed);
+			}
+		}
+
+		/** Get the shard of a string */
+		Shard& shardOf(const Key& key) {
+			return shards[(key.hash >> 7) % NUM_SHARDS];
+		}
+
+		/** Get the slot of an index in the dense storage, allocating its segment if needed */
+		Slot& slot(size_t index) {
+			size_t pos = index + (1UL << FIRST_SEGMENT_BITS);
+			size_t bits = 63 - __builtin_clzll(pos);
+			std::atomic<Slot*>& segment = segments[bits - FIRST_SEGMENT_BITS];
+			Slot* strings = segment.load(std::memory_order_acquire);
+			if (strings == nullptr) {
+				auto* fresh = new Slot[1UL << bits];
+				if (segment.compare_exchange_strong(strings, fresh, std::memory_order_acq_rel)) {
+					strings = fresh;
+				} else {
+					delete[] fresh;
+				}
+			}
+			return strings[pos - (1UL << bits)];
+		}
+
+		/** Get the string of an index, or nullptr if there is no such symbol */
+		const std::string* find(RamDomain index) {
+			if (index >= enumStart() && index < enumEnd()) {
+				auto offset = static_cast<size_t>(index - enumStart());
+				return (offset < enumToStr.size()) ? enumToStr[offset] : nullptr;
+			}
+			if (index < 0 || static_cast<size_t>(index) >= next.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+			// a moved symbol is only found by its index in the window of enum symbols
+			if (isMoved(static_cast<size_t>(index))) {
+				return nullptr;
+			}
+			// the index is taken before the string is written by a concurrent insertion
+			const Slot& stored = slot(static_cast<size_t>(index));
+			return stored.ready.load(std::memory_order_acquire) ? &stored.symbol : nullptr;
+		}
+
+		/** Find the index of a string, inserting it if it does not exist */
+		size_t lookup(const std::string& symbol) {
+			Key key(symbol);
+			Shard& shard = shardOf(key);
+			auto lease = shard.lock.acquire();
+			(void) lease;  // avoid warning;
+			auto it = shard.strToNum.find(key);
+			if (it != shard.strToNum.end()) {
+				return it->second;
+			}
+			size_t index = next.fetch_add(1, std::memory_order_acq_rel);
+			Slot& stored = slot(index);
+			stored.symbol = symbol;
+			stored.ready.store(true, std::memory_order_release);
+			// the key refers to the stored copy, whose characters do not move
+			key.data = stored.symbol.data();
+			shard.strToNum.emplace(key, index);
+			return index;
+		}
+
+		/** Find the index of a string, returning false if it does not exist */
+		bool lookupExisting(const std::string& symbol, size_t& index) {
+			Key key(symbol);
+			Shard& shard = shardOf(key);
+			auto lease = shard.lock.acquire();
+			(void) lease;  // avoid warning;
+			auto it = shard.strToNum.find(key);
+			if (it == shard.strToNum.end()) {
+				return false;
+			}
 			index = it->second;
+			return true;
 		}
-		return index;
-	}
 
-	/** Convenience method to place a new symbol in the table, if it does not exist. */
-	inline void newSymbol(const std::string& symbol) {
-		if (strToNum.find(symbol) == strToNum.end()) {
-			strToNum[symbol] = numToStr.size();
-			//numToStr.push_back(symbol);
-			numToStr[numToStr.size()] = symbol;
+		/**
+		 * Move the index of an inserted string to the window of enum symbols. This
+		 * grows the enum table, which find() reads without locking, so it must not
+		 * run concurrently with find(); see SymbolTable::moveToEnd().
+		 */
+		void moveToEnd(const std::string& symbol) {
+			Key key(symbol);
+			Shard& shard = shardOf(key);
+			auto lease = shard.lock.acquire();
+			(void) lease;  // avoid warning;
+			auto it = shard.strToNum.find(key);
+			assert(it != shard.strToNum.end()
+					&& "It's not in the symbol table when moving to the end!");
+			size_t org_index = it->second;
+			// move to the end, and avoid using the maximum value, which may be used in numeric variable
+			assert(org_index < 60000);
+			it->second = enumStart() + org_index;
+
+			// the string stays in the dense storage, the enum table refers to it
+			if (enumToStr.size() <= org_index) {
+				enumToStr.resize(org_index + 1, nullptr);
+			}
+			enumToStr[org_index] = &slot(org_index).symbol;
+		}
+
+		/** Whether a dense index belongs to a symbol moved to the window of enum symbols */
+		bool isMoved(size_t index) const {
+			return index < enumToStr.size() && enumToStr[index] != nullptr;
+		}
+	};
+
+	std::unique_ptr<Store> store = std::make_unique<Store>();
+
+	/** Copy the symbols of another table, keeping their indices */
+	void copy(const SymbolTable& other) {
+		store = std::make_unique<Store>();
+		size_t num = other.store->next.load(std::memory_order_acquire);
+		for (size_t i = 0; i < num; i++) {
+			store->lookup(other.store->slot(i).symbol);
+		}
+		for (const std::string* symbol : other.store->enumToStr) {
+			if (symbol != nullptr) {
+				store->moveToEnd(*symbol);
+			}
 		}
 	}
 
@@ -217,20 +393,18 @@ public:
 	SymbolTable() = default;
 
 	/** Copy constructor, performs a deep copy. */
-	SymbolTable(const SymbolTable& other) :
-			numToStr(other.numToStr), strToNum(other.strToNum) {
+	SymbolTable(const SymbolTable& other) {
+		copy(other);
 	}
 
 	/** Copy constructor for r-value reference. */
 	SymbolTable(SymbolTable&& other) noexcept {
-		numToStr.swap(other.numToStr);
-		strToNum.swap(other.strToNum);
+		store.swap(other.store);
 	}
 
 	SymbolTable(std::initializer_list<std::string> symbols) {
-		strToNum.reserve(symbols.size());
 		for (const auto& symbol : symbols) {
-			newSymbol(symbol);
+			store->lookup(symbol);
 		}
 	}
 
@@ -242,15 +416,13 @@ public:
 		if (this == &other) {
 			return *this;
 		}
-		numToStr = other.numToStr;
-		strToNum = other.strToNum;
+		copy(other);
 		return *this;
 	}
 
 	/** Assignment operator for r-value references. */
 	SymbolTable& operator=(SymbolTable&& other) noexcept {
-		numToStr.swap(other.numToStr);
-		strToNum.swap(other.strToNum);
+		store.swap(other.store);
 		return *this;
 	}
 
@@ -262,11 +434,7 @@ public:
 			return cacheLookup(symbol, LOOKUP);
 		} else
 #endif
-		{
-			auto lease = access.acquire();
-			(void) lease;  // avoid warning;
-			return static_cast<RamDomain>(newSymbolOfIndex(symbol));
-		}
+		return static_cast<RamDomain>(store->lookup(symbol));
 	}
 
 	/** Finds the index of a symbol in the table, giving an error if it's not found */
@@ -277,24 +445,20 @@ public:
 		} else
 #endif
 		{
-			auto lease = access.acquire();
-			(void) lease;  // avoid warning;
-			auto result = strToNum.find(symbol);
-			if (result == strToNum.end()) {
+			size_t result;
+			if (!store->lookupExisting(symbol, result)) {
 				std::cerr
 						<< "Error string not found in call to SymbolTable::lookupExisting.\n";
 				exit(1);
 			}
-			return static_cast<RamDomain>(result->second);
+			return static_cast<RamDomain>(result);
 		}
 	}
 
 	bool exist(const std::string& symbol) const {
 		// TODO: MPI
-		auto lease = access.acquire();
-		(void) lease;  // avoid warning;
-		auto result = strToNum.find(symbol);
-		return result != strToNum.end();
+		size_t index;
+		return store->lookupExisting(symbol, index);
 	}
 
 	/** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
@@ -305,7 +469,7 @@ public:
 			return cacheLookup(symbol, UNSAFE_LOOKUP);
 		} else
 #endif
-		return newSymbolOfIndex(symbol);
+		return static_cast<RamDomain>(store->lookup(symbol));
 	}
 
 	/*
@@ -313,8 +477,16 @@ public:
 	 */
 	std::vector<size_t> getIndices() const {
 		std::vector<size_t> indices;
-		for (const auto& p : numToStr) {
-			indices.push_back(p.first);
+		size_t num = store->next.load(std::memory_order_acquire);
+		for (size_t i = 0; i < num; i++) {
+			if (!store->isMoved(i)) {
+				indices.push_back(i);
+			}
+		}
+		for (size_t i = 0; i < store->enumToStr.size(); i++) {
+			if (store->enumToStr[i] != nullptr) {
+				indices.push_back(enumStart() + i);
+			}
 		}
 		return indices;
 	}
@@ -329,16 +501,14 @@ public:
 		} else
 #endif
 		{
-			auto lease = access.acquire();
-			(void) lease;  // avoid warning;
-			auto pos = static_cast<size_t>(index);
-			if (numToStr.find(pos) == numToStr.end()) { //pos >= size()
-					// TODO: use different error reporting here!!
+			const std::string* symbol = store->find(index);
+			if (symbol == nullptr) {
+				// TODO: use different error reporting here!!
 				std::cerr
 						<< "Error index out of bounds in call to SymbolTable::resolve.\n";
 				exit(1);
 			}
-			return numToStr.at(pos);
+			return *symbol;
 		}
 	}
 
@@ -349,8 +519,11 @@ public:
 			return cacheResolve(index, UNSAFE_RESOLVE);
 		} else
 #endif
-
-		return numToStr.at(static_cast<size_t>(index));
+		{
+			const std::string* symbol = store->find(index);
+			assert(symbol != nullptr && "index out of bounds in call to SymbolTable::unsafeResolve");
+			return *symbol;
+		}
 	}
 
 	// added by Qing Gong, MPI not finished
@@ -363,8 +536,22 @@ public:
 		} else
 #endif
 
-		return (index >= MAX_RAM_DOMAIN - 65536 && index < MAX_RAM_DOMAIN - 5536) ?
-				numToStr.at(static_cast<size_t>(index)) : std::to_string(index);
+		return isEnumSymbol(index) ? unsafeResolve(index) : std::to_string(index);
+	}
+
+	/** First index of the window of lattice enum symbols at the end of the domain */
+	static RamDomain enumStart() {
+		return MAX_RAM_DOMAIN - 65536;
+	}
+
+	/** End of the window of lattice enum symbols */
+	static RamDomain enumEnd() {
+		return MAX_RAM_DOMAIN - 5536;
+	}
+
+	/** Whether an index belongs to a symbol of an enum type */
+	static bool isEnumSymbol(const RamDomain index) {
+		return index >= enumStart() && index < enumEnd();
 	}
 
 	/* Return the size of the symbol table, being the number of symbols it currently holds. */
@@ -377,7 +564,7 @@ public:
 			return size;
 		} else
 #endif
-		return numToStr.size();
+		return store->next.load(std::memory_order_acquire);
 	}
 
 	/** Bulk insert symbols into the table, note that this operation is more efficient than repeated
@@ -390,11 +577,8 @@ public:
 		} else
 #endif
 		{
-			auto lease = access.acquire();
-			(void) lease;  // avoid warning;
-			strToNum.reserve(size() + symbols.size());
 			for (auto& symbol : symbols) {
-				newSymbol(symbol);
+				store->lookup(symbol);
 			}
 		}
 	}
@@ -408,34 +592,21 @@ public:
 			mpi::send(symbol, 0, INSERT_STRING);
 		} else
 #endif
-		{
-			auto lease = access.acquire();
-			(void) lease;  // avoid warning;
-			newSymbol(symbol);
-		}
+		store->lookup(symbol);
 	}
 
 	// added by Qing Gong
-	/** Move the index for a symbol to the end */
+	/**
+	 * Move the index for a symbol to the end, after which its old index no longer
+	 * resolves. Symbols are only moved while parsing the enum declarations, or by
+	 * a synthesised program while it sets up its symbol table; both happen before
+	 * the evaluation starts to resolve indices, which is done without locking.
+	 */
 	void moveToEnd(const std::string& symbol) {
 		// TODO: MPI
 		auto lease = access.acquire();
 		(void) lease;  // avoid warning;
-		auto it = strToNum.find(symbol);
-		assert(
-				it != strToNum.end()
-						&& "It's not in the symbol table when moving to the end!");
-		size_t org_index = it->second;
-		// move to the end, and avoid using the maximum value, which may be used in numeric variable
-		assert(org_index >= 0 && org_index < 60000);
-		it->second = MAX_RAM_DOMAIN - 65536 + org_index;
-
-		auto it2 = numToStr.find(org_index);
-		assert(
-				it2 != numToStr.end()
-						&& "Fail to locate the original index when moving to the end!");
-		numToStr.erase(it2);
-		numToStr[it->second] = symbol;
+		store->moveToEnd(symbol);
 	}
 
 	/** Print the symbol table to the given stream. */
@@ -448,9 +619,9 @@ public:
 		{
 			out << "SymbolTable: {\n\t";
 			out
-					<< join(strToNum, "\n\t",
-							[](std::ostream& out, const std::pair<std::string, std::size_t>& entry) {
-								out << entry.first << "\t => " << entry.second;
+					<< join(getIndices(), "\n\t",
+							[&](std::ostream& out, size_t index) {
+								out << resolve(index) << "\t => " << index;
 							}) << "\n";
 			out << "}\n";
 		}
@@ -23,6 +23,9 @@
 #include "RamCondition.h"
 #include "RamExistenceCheckAnalysis.h"
 #include "RamIndexScanKeys.h"
+#include "RamLatticeAssociation.h"
+#include "RamLatticeFunction.h"
+#include "RamLatticeFunctor.h"
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamProgram.h"
@@ -137,6 +140,137 @@ const std::string Synthesiser::getOpContextName(
 	return getRelationName(rel) + "_op_ctxt";
 }
 
+/** Get name of a generated lattice function */
+const std::string& Synthesiser::getLatticeFunctionName(
+		const RamLatticeFunction& func) {
+	auto pos = latticeFunctions.find(&func);
+	assert(pos != latticeFunctions.end() && "lattice function not generated");
+	return pos->second;
+}
+
+/** Generate lattice constants and functions */
+void Synthesiser::generateLatticeFunctions(std::ostream& out) {
+	const RamProgram& prog = translationUnit.getP();
+	if (!prog.hasLattice()) {
+		return;
+	}
+
+	// name all functions first as the cases of a function may call others;
+	// the operators of each lattice association are suffixed by its name
+	std::vector<const RamLatticeBinaryFunction*> binaryFunctions;
+	std::vector<const RamLatticeUnaryFunction*> unaryFunctions;
+	for (const auto& cur : prog.getLattices()) {
+		RamLatticeAssociation* lattice = cur.second.get();
+		const std::string id = SynthesiserRelation::getLatticeIdentifier(
+				cur.first);
+		binaryFunctions.push_back(&lattice->getLUB());
+		latticeFunctions[&lattice->getLUB()] = "lattice_lub_" + id;
+		binaryFunctions.push_back(&lattice->getGLB());
+		latticeFunctions[&lattice->getGLB()] = "lattice_glb_" + id;
+		if (lattice->hasWiden()) {
+			binaryFunctions.push_back(&lattice->getWiden());
+			latticeFunctions[&lattice->getWiden()] = "lattice_widen_" + id;
+		}
+		if (lattice->hasNarrow()) {
+			binaryFunctions.push_back(&lattice->getNarrow());
+			latticeFunctions[&lattice->getNarrow()] = "lattice_narrow_" + id;
+		}
+	}
+	for (const auto& cur : prog.getLBFs()) {
+		binaryFunctions.push_back(cur.second.get());
+		latticeFunctions[cur.second.get()] = "lattice_"
+				+ convertRamIdent(cur.first);
+	}
+	for (const auto& cur : prog.getLUFs()) {
+		unaryFunctions.push_back(cur.second.get());
+		latticeFunctions[cur.second.get()] = "lattice_"
+				+ convertRamIdent(cur.first);
+	}
+
+	out << "// -- lattice --\n";
+	for (const auto& cur : prog.getLattices()) {
+		RamLatticeAssociation* lattice = cur.second.get();
+		const std::string id = SynthesiserRelation::getLatticeIdentifier(
+				cur.first);
+		out << "static const RamDomain lattice_bottom_" << id << " = "
+				<< lattice->getBot() << ";\n";
+		out << "static const RamDomain lattice_top_" << id << " = "
+				<< lattice->getTop() << ";\n";
+
+		// original lattice relations widen cells after a number of increases
+		out << "static const bool lattice_widening_" << id << " = "
+				<< lattice->hasWiden() << ";\n";
+		if (!lattice->hasWiden()) {
+			out << "static inline RamDomain lattice_widen_" << id
+					<< "(RamDomain, RamDomain y) { return y; }\n";
+		}
+	}
+	out << "static const std::size_t lattice_widening_delay = "
+			<< (Global::config().has("widening-delay") ?
+					std::stoi(Global::config().get("widening-delay")) : 0)
+			<< ";\n";
+	for (const auto* func : binaryFunctions) {
+		out << "static inline RamDomain " << getLatticeFunctionName(*func)
+				<< "(RamDomain, RamDomain);\n";
+	}
+	for (const auto* func : unaryFunctions) {
+		out << "static inline RamDomain " << getLatticeFunctionName(*func)
+				<< "(RamDomain);\n";
+	}
+
+	// the cases of a function become a chain of guarded returns
+	auto emitCase = [&](const RamCondition* match, const RamValue& output) {
+		if (match != nullptr) {
+			out << "if (";
+			emitCode(out, *match);
+			out << ") ";
+		}
+		out << "return ";
+		emitCode(out, output);
+		out << ";\n";
+	};
+
+	for (const auto* func : binaryFunctions) {
+		out << "static inline RamDomain " << getLatticeFunctionName(*func)
+				<< "(RamDomain x, RamDomain y) {\n";
+		out << "const RamDomain args[2] = {x, y};\n";
+		bool total = false;
+		for (const auto& cas : func->getLatCase()) {
+			emitCase(cas.match.get(), *cas.output);
+			if (cas.match == nullptr) {
+				total = true;
+				break;
+			}
+		}
+		if (!total) {
+			out
+					<< "std::cerr << \"Failed to find a match for a lattice binary functor!\\n\";\n";
+			out << "exit(1);\n";
+		}
+		out << "}\n";
+	}
+	for (const auto* func : unaryFunctions) {
+		out << "static inline RamDomain " << getLatticeFunctionName(*func)
+				<< "(RamDomain x) {\n";
+		out << "const RamDomain args[1] = {x};\n";
+		bool total = false;
+		for (const auto& cas : func->getLatCase()) {
+			emitCase(cas.constraint.get(), *cas.output);
+			if (cas.constraint == nullptr) {
+				total = true;
+				break;
+			}
+		}
+		if (!total) {
+			out
+					<< "std::cerr << \"Failed to find a match for a lattice unary functor!\\n\";\n";
+			out << "exit(1);\n";
+		}
+		out << "}\n";
+	}
+	out << "\n";
+}
+
 /** Get relation type struct */
 void Synthesiser::generateRelationTypeStruct(std::ostream& out,
 		std::unique_ptr<SynthesiserRelation> relationType) {
@@ -180,6 +314,10 @@ std::set<RamRelationReference> Synthesiser::getReferencedRelations(
 					res.insert(scan->getRelation());
 				} else if (auto agg = dynamic_cast<const RamAggregate*>(&node)) {
 					res.insert(agg->getRelation());
+				} else if (auto intersect = dynamic_cast<const RamIntersect*>(&node)) {
+					for (size_t i = 0; i < intersect->getNumRelations(); i++) {
+						res.insert(intersect->getRelation(i));
+					}
 				} else if (auto exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
 					res.insert(exists->getRelation());
 				} else if (auto provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
@@ -191,7 +329,7 @@ std::set<RamRelationReference> Synthesiser::getReferencedRelations(
 	return res;
 }
 
-void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
+void Synthesiser::emitCode(std::ostream& out, const RamNode& node) {
 	class CodeEmitter: public RamVisitor<void, std::ostream&> {
 	private:
 		Synthesiser& synthesiser;
@@ -251,7 +389,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 				out << "std::map<std::string, std::string> directiveMap(";
 				out << ioDirectives << ");\n";
 				out
-						<< R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+						<< R"_(if (!inputDirectory.empty() && (directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
 				out << "directiveMap[\"filename\"].front() != '/') {";
 				out
 						<< R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
@@ -260,6 +398,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 				out << "IOSystem::getInstance().getReader(";
 				out << "SymbolMask({" << load.getRelation().getSymbolMask()
 						<< "})";
+				out << ", EnumTypeMask({"
+						<< load.getRelation().getEnumTypeMask() << "})";
 				out << ", symTable, ioDirectives";
 				out << ", " << Global::config().has("provenance");
 				out << ")->readAll(*"
@@ -282,7 +422,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 				out << "std::map<std::string, std::string> directiveMap("
 						<< ioDirectives << ");\n";
 				out
-						<< R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+						<< R"_(if (!outputDirectory.empty() && (directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
 				out << "directiveMap[\"filename\"].front() != '/') {";
 				out
 						<< R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
@@ -291,6 +431,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 				out << "IOSystem::getInstance().getWriter(";
 				out << "SymbolMask({" << store.getRelation().getSymbolMask()
 						<< "})";
+				out << ", EnumTypeMask({"
+						<< store.getRelation().getEnumTypeMask() << "})";
 				out << ", symTable, ioDirectives";
 				out << ", " << Global::config().has("provenance");
 				out << ")->writeAll(*"
@@ -464,7 +606,68 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 		void visitLatNorm(const RamLatNorm& latNorm, std::ostream& out)
 				override {
 			PRINT_BEGIN_COMMENT(out);
-			out << "//TODO: visitLatNorm\n";
+			// lattice relations join the elements of a cell on insertion
+			out << synthesiser.getRelationName(latNorm.getRelation_OUT_Rel())
+					<< "->" << "insertAll(" << "*"
+					<< synthesiser.getRelationName(
+							latNorm.getRelation_IN_Rel()) << ");\n";
+			PRINT_END_COMMENT(out);
+		}
+
+		void visitLatMerge(const RamLatMerge& latMerge, std::ostream& out)
+				override {
+			PRINT_BEGIN_COMMENT(out);
+			const auto& origin = latMerge.getRelation_Origin();
+
+			// join new elements into the original relation and keep the cells which moved up
+			out << "for (const auto& cur : *"
+					<< synthesiser.getRelationName(latMerge.getRelation_IN_New())
+					<< ") {\n";
+			out << "Tuple<RamDomain," << origin.getArity() << "> tuple(cur);\n";
+			out << "if (" << synthesiser.getRelationName(origin)
+					<< "->merge(tuple)) {\n";
+			out << synthesiser.getRelationName(latMerge.getRelation_OUT_Delta())
+					<< "->insert(*" << synthesiser.getRelationName(origin)
+					<< "->getCell(tuple));\n";
+			out << "}\n";
+			out << "}\n";
+			PRINT_END_COMMENT(out);
+		}
+
+		void visitLatNarrow(const RamLatNarrow& latNarrow, std::ostream& out)
+				override {
+			PRINT_BEGIN_COMMENT(out);
+			const auto& origin = latNarrow.getRelation_Origin();
+
+			// narrow the cells by their recomputed elements and keep the cells which moved down
+			out << "for (const auto& cur : *"
+					<< synthesiser.getRelationName(latNarrow.getRelation_IN_New())
+					<< ") {\n";
+			out << "Tuple<RamDomain," << origin.getArity() << "> tuple(cur);\n";
+			out << "const auto* cell = " << synthesiser.getRelationName(origin)
+					<< "->getCell(tuple);\n";
+			out << "if (cell == nullptr) continue;\n";
+			for (size_t i = origin.getArity() - origin.getLatticeArity();
+					i < origin.getArity(); i++) {
+				// columns whose lattice has no narrowing keep their element
+				RamLatticeAssociation* lattice =
+						synthesiser.translationUnit.getP().getLattice(
+								origin.getLatticeAssociation(i));
+				if (lattice->hasNarrow()) {
+					out << "tuple[" << i << "] = "
+							<< synthesiser.getLatticeFunctionName(
+									lattice->getNarrow())
+							<< "((*cell)[" << i << "], cur[" << i << "]);\n";
+				} else {
+					out << "tuple[" << i << "] = (*cell)[" << i << "];\n";
+				}
+			}
+			out << "if (" << synthesiser.getRelationName(origin)
+					<< "->replace(tuple)) {\n";
+			out << synthesiser.getRelationName(latNarrow.getRelation_OUT_Delta())
+					<< "->insert(tuple);\n";
+			out << "}\n";
+			out << "}\n";
 			PRINT_END_COMMENT(out);
 		}
 
@@ -785,6 +988,111 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 			PRINT_END_COMMENT(out);
 		}
 
+		void visitIntersect(const RamIntersect& intersect, std::ostream& out)
+				override {
+			PRINT_BEGIN_COMMENT(out);
+			auto identifier = intersect.getIdentifier();
+			size_t num = intersect.getNumRelations();
+
+			// local names are derived from the identifier, as intersections may nest
+			const std::string range = "range" + toString(identifier);
+			const std::string values = "values" + toString(identifier);
+			const std::string cur = "cur" + toString(identifier);
+			const std::string value = "value" + toString(identifier);
+
+			// a lambda for printing the key of a relation, with the given
+			// value in the intersected column
+			auto printKeyTuple = [&](size_t i, const std::string& value) {
+				const auto pattern = intersect.getPattern(i);
+				out << "Tuple<RamDomain," << pattern.size() << ">({{";
+				for (size_t j = 0; j < pattern.size(); j++) {
+					if (j == intersect.getColumn(i)) {
+						out << value;
+					} else if (pattern[j] != nullptr) {
+						visit(pattern[j], out);
+					} else {
+						out << "0";
+					}
+					if (j + 1 < pattern.size()) {
+						out << ",";
+					}
+				}
+				out << "}})";
+			};
+
+			// the values are enumerated from a relation whose key and
+			// intersected column cover all its columns, hence whose range holds
+			// distinct values; the other relations are probed for each value
+			size_t first = 0;
+			bool distinct = false;
+			for (size_t i = 0; i < num && !distinct; i++) {
+				const auto& rel = intersect.getRelation(i);
+				SearchColumns keys = intersect.getRangeQueryColumns(i)
+						| (1UL << intersect.getColumn(i));
+				if (keys == (1UL << rel.getArity()) - 1) {
+					first = i;
+					distinct = true;
+				}
+			}
+
+			const auto& rel = intersect.getRelation(first);
+			auto relName = synthesiser.getRelationName(rel);
+			auto ctxName = "READ_OP_CONTEXT("
+					+ synthesiser.getOpContextName(rel) + ")";
+			auto keys = intersect.getRangeQueryColumns(first);
+			if (keys == 0) {
+				out << "auto& " << range << " = *" << relName << ";\n";
+			} else {
+				out << "auto " << range << " = " << relName << "->equalRange_" << keys
+						<< "(";
+				printKeyTuple(first, "0");
+				out << "," << ctxName << ");\n";
+			}
+
+			if (distinct) {
+				out << "for(const auto& " << cur << " : " << range << ") {\n";
+				out << "const RamDomain " << value << " = " << cur << "["
+						<< intersect.getColumn(first) << "];\n";
+			} else {
+				// otherwise the index of the range need not be ordered by the
+				// intersected column, so its values are made distinct first
+				out << "std::vector<RamDomain> " << values << ";\n";
+				out << "for(const auto& " << cur << " : " << range << ") {\n";
+				out << values << ".push_back(" << cur << "["
+						<< intersect.getColumn(first) << "]);\n";
+				out << "}\n";
+				out << "std::sort(" << values << ".begin(), " << values << ".end());\n";
+				out << values << ".erase(std::unique(" << values << ".begin(), "
+						<< values << ".end()), " << values << ".end());\n";
+				out << "for(const RamDomain " << value << " : " << values << ") {\n";
+			}
+			out << "const ram::Tuple<RamDomain,1> env" << identifier
+					<< "({{" << value << "}});\n";
+
+			// probe the other relations
+			bool probes = false;
+			for (size_t i = 0; i < num; i++) {
+				if (i == first) {
+					continue;
+				}
+				const auto& rel = intersect.getRelation(i);
+				out << (probes ? " && " : "if (");
+				out << "!" << synthesiser.getRelationName(rel)
+						<< "->equalRange_"
+						<< (intersect.getRangeQueryColumns(i)
+								| (1UL << intersect.getColumn(i))) << "(";
+				printKeyTuple(i, value);
+				out << ",READ_OP_CONTEXT("
+						<< synthesiser.getOpContextName(rel) << ")).empty()";
+				probes = true;
+			}
+			out << (probes ? ") {\n" : "{\n");
+			visitSearch(intersect, out);
+			out << "}\n";
+			out << "}\n";
+			PRINT_END_COMMENT(out);
+		}
+
 		void visitLookup(const RamLookup& lookup, std::ostream& out) override {
 			PRINT_BEGIN_COMMENT(out);
 			auto arity = lookup.getArity();
@@ -1195,7 +1503,19 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 		void visitLatticeGLB(const RamLatticeGLB& rGLB, std::ostream& out)
 				override {
 			PRINT_BEGIN_COMMENT(out);
-			out << "//TODO: visitLatticeGLB\n";
+			// fold the referenced lattice elements with the glb function
+			const auto* refs = rGLB.getRefs();
+			const std::string glb = "lattice_glb_"
+					+ SynthesiserRelation::getLatticeIdentifier(
+							rGLB.getLatticeAssociation());
+			for (size_t i = 1; i < refs->size(); i++) {
+				out << glb << "(";
+			}
+			auto it = refs->begin();
+			out << "env" << it->identifier << "[" << it->element << "]";
+			for (++it; it != refs->end(); ++it) {
+				out << ",env" << it->identifier << "[" << it->element << "])";
+			}
 			PRINT_END_COMMENT(out);
 		}
 
@@ -1444,7 +1764,33 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 		void visitQuestionMark(const RamQuestionMark& qmark, std::ostream& out)
 				override {
 			PRINT_BEGIN_COMMENT(out);
-			out << "//TODO: visitQuestionMark\n";
+			out << "((";
+			visit(qmark.getCondition(), out);
+			out << ") ? (";
+			visit(qmark.getFirstRet(), out);
+			out << ") : (";
+			visit(qmark.getSecondRet(), out);
+			out << "))";
+			PRINT_END_COMMENT(out);
+		}
+
+		void visitLatticeUnaryFunctor(const RamLatticeUnaryFunctor& luf,
+				std::ostream& out) override {
+			PRINT_BEGIN_COMMENT(out);
+			out << synthesiser.getLatticeFunctionName(luf.getFunc()) << "(";
+			visit(*luf.getRef(), out);
+			out << ")";
+			PRINT_END_COMMENT(out);
+		}
+
+		void visitLatticeBinaryFunctor(const RamLatticeBinaryFunctor& lbf,
+				std::ostream& out) override {
+			PRINT_BEGIN_COMMENT(out);
+			out << synthesiser.getLatticeFunctionName(lbf.getFunc()) << "(";
+			visit(*lbf.getRef1(), out);
+			out << ",";
+			visit(*lbf.getRef2(), out);
+			out << ")";
 			PRINT_END_COMMENT(out);
 		}
 
@@ -1561,7 +1907,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 	};
 
 	// emit code
-	CodeEmitter(*this).visit(stmt, out);
+	CodeEmitter(*this).visit(node, out);
 }
 
 void Synthesiser::generateCode(std::ostream& os, const std::string& id,
@@ -1634,6 +1980,9 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 	os << "namespace souffle {\n";
 	os << "using namespace ram;\n";
 
+	// lattice functions are used by the types of lattice relations
+	generateLatticeFunctions(os);
+
 	visitDepthFirst(*(prog.getMain()), [&](const RamCreate& create) {
 		// get some table details
 			const RamRelationReference& rel = create.getRelation();
@@ -1724,12 +2073,27 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 	// TODO: Qing Gong, avoid conflict in Symbol Table!
 	// declare symbol table
 	os << "// -- initialize symbol table --\n";
+	std::string moveSymbols;  // enum symbols moved to the end of the domain
 	{
+		// symbols are numbered in order of insertion, hence recreate them in that order; enum
+		// symbols keep their insertion index relative to the end of the domain
+		auto insertionIndex = [&](size_t i) {
+			return SymbolTable::isEnumSymbol(i) ? i - SymbolTable::enumStart() : i;
+		};
+		std::vector<size_t> indices = symTable.getIndices();
+		std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+			return insertionIndex(a) < insertionIndex(b);
+		});
+
 		os << "SymbolTable symTable\n";
 		if (symTable.size() > 0) {
 			os << "{\n";
-			for (size_t i : symTable.getIndices()) {
+			for (size_t i : indices) {
 				os << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
+				if (SymbolTable::isEnumSymbol(i)) {
+					moveSymbols += "symTable.moveToEnd(R\"_(" + symTable.resolve(i)
+							+ ")_\");\n";
+				}
 			}
 //            for (size_t i = 0; i < symTable.size(); i++) {
 //                os << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
@@ -1842,6 +2206,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 		os
 				<< "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
 	}
+	os << moveSymbols;
 	os << registerRel;
 	os << "}\n";
 	// -- destructor --
@@ -2008,13 +2373,14 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 					for (IODirectives ioDirectives : store->getIODirectives()) {
 						os << "try {";
 						os << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
-						os << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+						os << R"_(if (!outputDirectory.empty() && (directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
 						os << "directiveMap[\"filename\"].front() != '/') {";
 						os << R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
 						os << "}\n";
 						os << "IODirectives ioDirectives(directiveMap);\n";
 						os << "IOSystem::getInstance().getWriter(";
 						os << "SymbolMask({" << store->getRelation().getSymbolMask() << "})";
+						os << ", EnumTypeMask({" << store->getRelation().getEnumTypeMask() << "})";
 						os << ", symTable, ioDirectives, " << Global::config().has("provenance");
 						os << ")->writeAll(*" << getRelationName(store->getRelation()) << ");\n";
 
@@ -2049,13 +2415,14 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 				os << "try {";
 				os << "std::map<std::string, std::string> directiveMap(";
 				os << ioDirectives << ");\n";
-				os << R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+				os << R"_(if (!inputDirectory.empty() && (directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
 				os << "directiveMap[\"filename\"].front() != '/') {";
 				os << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
 				os << "}\n";
 				os << "IODirectives ioDirectives(directiveMap);\n";
 				os << "IOSystem::getInstance().getReader(";
 				os << "SymbolMask({" << load.getRelation().getSymbolMask() << "})";
+				os << ", EnumTypeMask({" << load.getRelation().getEnumTypeMask() << "})";
 				os << ", symTable, ioDirectives";
 				os << ", " << Global::config().has("provenance");
 				os << ")->readAll(*" << getRelationName(load.getRelation());
@@ -2068,7 +2435,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 
 	// issue dump methods
 	auto dumpRelation =
-			[&](const std::string& name, const SymbolMask& mask, size_t arity) {
+			[&](const std::string& name, const SymbolMask& mask, const EnumTypeMask& enumTypeMask, size_t arity) {
 				auto relName = name;
 
 				os << "try {";
@@ -2077,6 +2444,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 				os << "ioDirectives.setRelationName(\"" << name << "\");\n";
 				os << "IOSystem::getInstance().getWriter(";
 				os << "SymbolMask({" << mask << "})";
+				os << ", EnumTypeMask({" << enumTypeMask << "})";
 				os << ", symTable, ioDirectives, " << Global::config().has("provenance");
 				os << ")->writeAll(*" << relName << ");\n";
 				os << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
@@ -2088,8 +2456,9 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 	visitDepthFirst(*(prog.getMain()), [&](const RamLoad& load) {
 		auto& name = getRelationName(load.getRelation());
 		auto& mask = load.getRelation().getSymbolMask();
+		auto& enumTypeMask = load.getRelation().getEnumTypeMask();
 		size_t arity = load.getRelation().getArity();
-		dumpRelation(name, mask, arity);
+		dumpRelation(name, mask, enumTypeMask, arity);
 	});
 	os << "}\n";  // end of dumpInputs() method
 
@@ -2099,8 +2468,9 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id,
 	visitDepthFirst(*(prog.getMain()), [&](const RamStore& store) {
 		auto& name = getRelationName(store.getRelation());
 		auto& mask = store.getRelation().getSymbolMask();
+		auto& enumTypeMask = store.getRelation().getEnumTypeMask();
 		size_t arity = store.getRelation().getArity();
-		dumpRelation(name, mask, arity);
+		dumpRelation(name, mask, enumTypeMask, arity);
 	});
 	os << "}\n";  // end of dumpOutputs() method
 
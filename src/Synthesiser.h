@@ -26,6 +26,7 @@
 
 namespace souffle {
 
+class RamLatticeFunction;
 class RamOperation;
 class RamRelationReference;
 class RamTranslationUnit;
@@ -51,6 +52,9 @@ private:
     /** Cache for generated types for relations */
     std::set<std::string> typeCache;
 
+    /** C++ identifiers of the generated lattice functions */
+    std::map<const RamLatticeFunction*, std::string> latticeFunctions;
+
 protected:
     /** Convert RAM identifier */
     const std::string convertRamIdent(const std::string& name);
@@ -67,6 +71,12 @@ protected:
     /** Get context name */
     const std::string getOpContextName(const RamRelationReference& rel);
 
+    /** Get name of a generated lattice function */
+    const std::string& getLatticeFunctionName(const RamLatticeFunction& func);
+
+    /** Generate lattice constants and functions */
+    void generateLatticeFunctions(std::ostream& out);
+
     /** Get relation struct definition */
     void generateRelationTypeStruct(std::ostream& out, std::unique_ptr<SynthesiserRelation> relationType);
 
@@ -77,7 +87,7 @@ protected:
     std::set<RamRelationReference> getReferencedRelations(const RamOperation& op);
 
     /** Generate code */
-    void emitCode(std::ostream& out, const RamStatement& stmt);
+    void emitCode(std::ostream& out, const RamNode& node);
 
     /** Lookup frequency counter */
     unsigned lookupFreqIdx(const std::string& txt);
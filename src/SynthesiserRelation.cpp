@@ -10,6 +10,7 @@
 #include "RelationRepresentation.h"
 #include "Util.h"
 #include <algorithm>
+#include <cctype>
 #include <cassert>
 #include <map>
 #include <numeric>
@@ -24,6 +25,8 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
     // Handle the qualifier in souffle code
     if (isProvenance) {
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
+    } else if (ramRel.isLattice()) {
+        rel = new SynthesiserLatticeRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
@@ -675,6 +678,455 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "};\n";
 }
 
+// -------- Lattice Relation --------
+
+/**
+ * Lattice relations store a single tuple per cell, i.e. per valuation of the columns preceding the
+ * trailing lattice columns. The generated struct joins each inserted element into the stored one
+ * using the lattice_lub_<id>() function and the lattice_top_<id> constant of the lattice association
+ * of its column, emitted by the synthesiser ahead of the relation types. Tuples are stored indirectly
+ * so that a join updates the elements seen by all indices at once.
+ */
+
+/** Get the C++ identifier of a lattice association; underscores are escaped to keep it injective */
+std::string SynthesiserRelation::getLatticeIdentifier(const std::string& association) {
+    std::string id;
+    for (char ch : association) {
+        if (isalnum(ch)) {
+            id += ch;
+        } else if (ch == '_') {
+            id += "_u";
+        } else {
+            id += "_q";
+        }
+    }
+    return id;
+}
+
+/** Generate index set for a lattice relation */
+void SynthesiserLatticeRelation::computeIndices() {
+    assert(!isProvenance && "lattice relations cannot be used with provenance");
+
+    // Generate and set indices
+    std::vector<std::vector<int>> inds = indices.getAllOrders();
+    int cellArity = getArity() - getRamRelation().getLatticeArity();
+
+    // the master index orders tuples by their cell, reuse an index covering exactly the cell columns
+    for (size_t i = 0; i < inds.size(); i++) {
+        const auto& ind = inds[i];
+        if (ind.size() == (size_t)cellArity &&
+                std::all_of(ind.begin(), ind.end(), [&](int column) { return column < cellArity; })) {
+            masterIndex = i;
+            break;
+        }
+    }
+
+    // otherwise add a cell index, after the indices of the index set
+    if (masterIndex == (size_t)-1) {
+        std::vector<int> cellInd(cellArity);
+        std::iota(cellInd.begin(), cellInd.end(), 0);
+        inds.push_back(cellInd);
+        masterIndex = inds.size() - 1;
+    }
+
+    computedIndices = inds;
+}
+
+/** Check whether an in-place update of the lattice columns keeps an index ordered */
+bool SynthesiserLatticeRelation::isStableIndex(const std::vector<int>& ind) const {
+    int cellArity = getArity() - getRamRelation().getLatticeArity();
+
+    // the cell columns are unique, so the order only depends on them if they come first
+    for (size_t i = 0; i < ind.size() && i < (size_t)cellArity; i++) {
+        if (ind[i] >= cellArity) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Generate type name of a lattice relation */
+std::string SynthesiserLatticeRelation::getTypeName() {
+    std::stringstream res;
+    res << "t_lattice_" << getArity();
+
+    // the operators of the lattice columns are part of the type
+    for (size_t i = getArity() - getRamRelation().getLatticeArity(); i < getArity(); i++) {
+        res << "__" << getLatticeIdentifier(getRamRelation().getLatticeAssociation(i));
+    }
+
+    // only original relations widen their cells
+    if (!getRamRelation().isTemp()) {
+        res << "__widened";
+    }
+
+    for (auto& ind : getIndices()) {
+        res << "__" << join(ind, "_");
+    }
+
+    for (auto& search : getIndexSet().getSearches()) {
+        res << "__" << search;
+    }
+
+    return res.str();
+}
+
+/** Generate type struct of a lattice relation */
+void SynthesiserLatticeRelation::generateTypeStruct(std::ostream& out) {
+    size_t arity = getArity();
+    size_t cellArity = arity - getRamRelation().getLatticeArity();
+    const auto& inds = getIndices();
+    size_t numIndexes = inds.size();
+    std::map<std::vector<int>, int> indexToNumMap;
+    bool widened = !getRamRelation().isTemp();
+
+    // identifiers of the lattice associations of the lattice columns
+    std::vector<std::string> lattices;
+    std::vector<std::string> widening, unchanged;
+    for (size_t i = cellArity; i < arity; i++) {
+        lattices.push_back(getLatticeIdentifier(getRamRelation().getLatticeAssociation(i)));
+        widening.push_back("lattice_widening_" + lattices.back());
+        unchanged.push_back("cell[" + std::to_string(i) + "] == t[" + std::to_string(i) + "]");
+    }
+    auto lattice = [&](size_t column) -> const std::string& { return lattices[column - cellArity]; };
+
+    // indices whose order involves a lattice column before the end of the cell are rebuilt lazily
+    std::vector<size_t> unstable;
+    for (size_t i = 0; i < numIndexes; i++) {
+        if (!isStableIndex(inds[i])) {
+            unstable.push_back(i);
+        }
+    }
+
+    // struct definition
+    out << "struct " << getTypeName() << " {\n";
+
+    // stored tuple type
+    out << "using t_tuple = Tuple<RamDomain, " << arity << ">;\n";
+
+    // table and lock required for storing actual data for indirect indices
+    out << "Table<t_tuple> dataTable;\n";
+    out << "mutable Lock insert_lock;\n";
+
+    // btree types, the master index holds one tuple per cell
+    for (size_t i = 0; i < numIndexes; i++) {
+        auto ind = inds[i];
+
+        if (i < getIndexSet().getAllOrders().size()) {
+            indexToNumMap[getIndexSet().getAllOrders()[i]] = i;
+        }
+
+        if (ind.size() == arity || i == masterIndex) {
+            out << "using t_ind_" << i
+                << " = btree_set<const t_tuple*, index_utils::deref_compare<typename "
+                   "index_utils::comparator<"
+                << join(ind) << ">>>;\n";
+        } else {
+            out << "using t_ind_" << i
+                << " = btree_multiset<const t_tuple*, index_utils::deref_compare<typename "
+                   "index_utils::comparator<"
+                << join(ind) << ">>>;\n";
+        }
+
+        bool isUnstable = std::find(unstable.begin(), unstable.end(), i) != unstable.end();
+        out << (isUnstable ? "mutable " : "") << "t_ind_" << i << " ind_" << i << ";\n";
+    }
+    if (!unstable.empty()) {
+        out << "mutable std::atomic<bool> dirty{false};\n";
+    }
+    if (widened) {
+        out << "std::unordered_map<const t_tuple*, std::size_t> increases;\n";
+    }
+
+    // typedef deref iterators
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "using iterator_" << i << " = IterDerefWrapper<typename t_ind_" << i << "::iterator>;\n";
+    }
+    out << "using iterator = iterator_" << masterIndex << ";\n";
+
+    // Create a struct storing the context hints for each index
+    out << "struct context {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "t_ind_" << i << "::operation_hints hints_" << i << ";\n";
+    }
+    out << "};\n";
+    out << "context createContext() { return context(); }\n";
+
+    // insert methods
+    out << "bool insert(const t_tuple& t) {\n";
+    out << "context h;\n";
+    out << "return insert(t, h);\n";
+    out << "}\n";
+
+    // a new cell is added to all indices, an existing cell joins the inserted lattice element
+    if (widened) {
+        out << "bool insert(const t_tuple& t, context& h) {\n";
+        out << "return insert(t, h, false);\n";
+        out << "}\n";
+
+        // the fixpoint merges recomputed elements, widening cells which keep increasing
+        out << "bool merge(const t_tuple& t) {\n";
+        out << "context h;\n";
+        out << "return insert(t, h, true);\n";
+        out << "}\n";
+        out << "bool insert(const t_tuple& t, context& h, bool widen) {\n";
+    } else {
+        out << "bool insert(const t_tuple& t, context& h) {\n";
+    }
+    out << "const t_tuple* masterCopy = nullptr;\n";
+    out << "{\n";
+    out << "auto lease = insert_lock.acquire();\n";
+    out << "auto pos = ind_" << masterIndex << ".find(&t, h.hints_" << masterIndex << ");\n";
+    out << "if (pos != ind_" << masterIndex << ".end()) {\n";
+    out << "t_tuple& cell = const_cast<t_tuple&>(**pos);\n";
+    out << "if (" << join(unchanged, " && ") << ") return false;\n";
+    out << "t_tuple joined(cell);\n";
+    for (size_t i = cellArity; i < arity; i++) {
+        out << "if (cell[" << i << "] != lattice_top_" << lattice(i) << " && cell[" << i << "] != t[" << i
+            << "]) joined[" << i << "] = lattice_lub_" << lattice(i) << "(cell[" << i << "], t[" << i
+            << "]);\n";
+    }
+    out << "if (joined == cell) return false;\n";
+    if (widened) {
+        out << "if (widen && (" << join(widening, " || ") << ") && increases[&cell]++ >= lattice_widening_delay) {\n";
+        for (size_t i = cellArity; i < arity; i++) {
+            out << "if (joined[" << i << "] != cell[" << i << "]) joined[" << i << "] = lattice_widen_"
+                << lattice(i) << "(cell[" << i << "], joined[" << i << "]);\n";
+        }
+        out << "}\n";
+    }
+    out << "cell = joined;\n";
+    if (!unstable.empty()) {
+        out << "dirty = true;\n";
+    }
+    out << "return true;\n";
+    out << "}\n";
+    out << "masterCopy = &dataTable.insert(t);\n";
+    out << "ind_" << masterIndex << ".insert(masterCopy, h.hints_" << masterIndex << ");\n";
+    for (size_t i : unstable) {
+        out << "ind_" << i << ".insert(masterCopy, h.hints_" << i << ");\n";
+    }
+    out << "}\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        if (i != masterIndex && std::find(unstable.begin(), unstable.end(), i) == unstable.end()) {
+            out << "ind_" << i << ".insert(masterCopy, h.hints_" << i << ");\n";
+        }
+    }
+    out << "return true;\n";
+    out << "}\n";
+
+    out << "bool insert(const RamDomain* ramDomain) {\n";
+    out << "RamDomain data[" << arity << "];\n";
+    out << "std::copy(ramDomain, ramDomain + " << arity << ", data);\n";
+    out << "const t_tuple& tuple = reinterpret_cast<const t_tuple&>(data);\n";
+    out << "context h;\n";
+    out << "return insert(tuple, h);\n";
+    out << "}\n";  // end of insert(RamDomain*)
+
+    std::vector<std::string> decls, params;
+    for (size_t i = 0; i < arity; i++) {
+        decls.push_back("RamDomain a" + std::to_string(i));
+        params.push_back("a" + std::to_string(i));
+    }
+    out << "bool insert(" << join(decls, ",") << ") {\n";
+    out << "RamDomain data[" << arity << "] = {" << join(params, ",") << "};\n";
+    out << "return insert(data);\n";
+    out << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
+
+    // insertAll method, each tuple has to be joined into its cell
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    out << "for (auto const& cur : other) {\n";
+    out << "insert(cur);\n";
+    out << "}\n";
+    out << "}\n";
+
+    // overwrite the lattice element of an existing cell
+    out << "bool replace(const t_tuple& t) {\n";
+    out << "context h;\n";
+    out << "auto lease = insert_lock.acquire();\n";
+    out << "auto pos = ind_" << masterIndex << ".find(&t, h.hints_" << masterIndex << ");\n";
+    out << "if (pos == ind_" << masterIndex << ".end()) return false;\n";
+    out << "t_tuple& cell = const_cast<t_tuple&>(**pos);\n";
+    out << "if (" << join(unchanged, " && ") << ") return false;\n";
+    for (size_t i = cellArity; i < arity; i++) {
+        out << "cell[" << i << "] = t[" << i << "];\n";
+    }
+    if (!unstable.empty()) {
+        out << "dirty = true;\n";
+    }
+    out << "return true;\n";
+    out << "}\n";
+
+    // cell lookup
+    out << "const t_tuple* getCell(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "auto pos = ind_" << masterIndex << ".find(&t, h.hints_" << masterIndex << ");\n";
+    out << "return (pos != ind_" << masterIndex << ".end()) ? *pos : nullptr;\n";
+    out << "}\n";
+
+    // contains methods
+    out << "bool contains(const t_tuple& t, context& h) const {\n";
+    out << "auto pos = ind_" << masterIndex << ".find(&t, h.hints_" << masterIndex << ");\n";
+    out << "if (pos == ind_" << masterIndex << ".end()) return false;\n";
+    out << "const t_tuple& cell = **pos;\n";
+    out << "return " << join(unchanged, " && ") << ";\n";
+    out << "}\n";
+
+    out << "bool contains(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return contains(t, h);\n";
+    out << "}\n";
+
+    // size method
+    out << "std::size_t size() const {\n";
+    out << "return ind_" << masterIndex << ".size();\n";
+    out << "}\n";
+
+    // find methods
+    out << "iterator find(const t_tuple& t, context& h) const {\n";
+    out << "auto pos = ind_" << masterIndex << ".find(&t, h.hints_" << masterIndex << ");\n";
+    out << "if (pos == ind_" << masterIndex << ".end()) return pos;\n";
+    out << "const t_tuple& cell = **pos;\n";
+    out << "if (!(" << join(unchanged, " && ") << ")) return ind_" << masterIndex << ".end();\n";
+    out << "return pos;\n";
+    out << "}\n";
+
+    out << "iterator find(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return find(t, h);\n";
+    out << "}\n";
+
+    // rebuild indices invalidated by in-place joins
+    if (!unstable.empty()) {
+        out << "void refresh() const {\n";
+        out << "if (!dirty) return;\n";
+        out << "auto lease = insert_lock.acquire();\n";
+        out << "if (!dirty) return;\n";
+        for (size_t i : unstable) {
+            out << "ind_" << i << ".clear();\n";
+            out << "for (const t_tuple* cur : ind_" << masterIndex << ") ind_" << i << ".insert(cur);\n";
+        }
+        out << "dirty = false;\n";
+        out << "}\n";
+    }
+
+    // empty equalRange method
+    out << "range<iterator> equalRange_0(const t_tuple& t, context& h) const {\n";
+    out << "return range<iterator>(ind_" << masterIndex << ".begin(),ind_" << masterIndex << ".end());\n";
+    out << "}\n";
+
+    for (int64_t search : getIndexSet().getSearches()) {
+        auto lexOrder = getIndexSet().getLexOrder(search);
+        size_t indNum = indexToNumMap[lexOrder];
+
+        // count size of search pattern
+        size_t indSize = 0;
+        for (size_t column = 0; column < arity; column++) {
+            if ((search >> column) & 1) {
+                indSize++;
+            }
+        }
+
+        // full searches are answered by the master index
+        std::string rangeType = (indSize == arity) ? "range<iterator>"
+                                                   : "range<iterator_" + std::to_string(indNum) + ">";
+
+        out << rangeType << " equalRange_" << search;
+        out << "(const t_tuple& t, context& h) const {\n";
+
+        // use the more efficient find() method for full range search
+        if (indSize == arity) {
+            out << "auto pos = find(t, h);\n";
+            out << "auto fin = end();\n";
+            out << "if (pos != fin) {fin = pos; ++fin;}\n";
+            out << "return make_range(pos, fin);\n";
+        } else {
+            if (std::find(unstable.begin(), unstable.end(), indNum) != unstable.end()) {
+                out << "refresh();\n";
+            }
+            out << "t_tuple low(t); t_tuple high(t);\n";
+            // check which indices to pad out
+            for (size_t column = 0; column < arity; column++) {
+                // if bit number column is set
+                if (!((search >> column) & 1)) {
+                    out << "low[" << column << "] = MIN_RAM_DOMAIN;\n";
+                    out << "high[" << column << "] = MAX_RAM_DOMAIN;\n";
+                }
+            }
+            out << "return range<iterator_" << indNum << ">(ind_" << indNum << ".lower_bound(&low, h.hints_"
+                << indNum << "), ind_" << indNum << ".upper_bound(&high, h.hints_" << indNum << "));\n";
+        }
+        out << "}\n";
+
+        out << rangeType << " equalRange_" << search;
+        out << "(const t_tuple& t) const {\n";
+        out << "context h; return equalRange_" << search << "(t, h);\n";
+        out << "}\n";
+    }
+
+    // empty method
+    out << "bool empty() const {\n";
+    out << "return ind_" << masterIndex << ".empty();\n";
+    out << "}\n";
+
+    // partition method
+    out << "std::vector<range<iterator>> partition() const {\n";
+    out << "std::vector<range<iterator>> res;\n";
+    out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(400)) {\n";
+    out << "    res.push_back(make_range(derefIter(cur.begin()), derefIter(cur.end())));\n";
+    out << "}\n";
+    out << "return res;\n";
+    out << "}\n";
+
+    // purge method
+    out << "void purge() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".clear();\n";
+    }
+    out << "dataTable.clear();\n";
+    if (!unstable.empty()) {
+        out << "dirty = false;\n";
+    }
+    if (widened) {
+        out << "increases.clear();\n";
+    }
+    out << "}\n";
+
+    // begin and end iterators
+    out << "iterator begin() const {\n";
+    out << "return ind_" << masterIndex << ".begin();\n";
+    out << "}\n";
+
+    out << "iterator end() const {\n";
+    out << "return ind_" << masterIndex << ".end();\n";
+    out << "}\n";
+
+    // printHintStatistics method
+    out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
+        out << "o << prefix << \"arity " << arity << " lattice b-tree index " << inds[i]
+            << ": (hits/misses/total)\\n\";\n";
+        out << "o << prefix << \"Insert: \" << stats_" << i << ".inserts.getHits() << \"/\" << stats_" << i
+            << ".inserts.getMisses() << \"/\" << stats_" << i << ".inserts.getAccesses() << \"\\n\";\n";
+        out << "o << prefix << \"Contains: \" << stats_" << i << ".contains.getHits() << \"/\" << stats_" << i
+            << ".contains.getMisses() << \"/\" << stats_" << i << ".contains.getAccesses() << \"\\n\";\n";
+        out << "o << prefix << \"Lower-bound: \" << stats_" << i
+            << ".lower_bound.getHits() << \"/\" << stats_" << i
+            << ".lower_bound.getMisses() << \"/\" << stats_" << i
+            << ".lower_bound.getAccesses() << \"\\n\";\n";
+        out << "o << prefix << \"Upper-bound: \" << stats_" << i
+            << ".upper_bound.getHits() << \"/\" << stats_" << i
+            << ".upper_bound.getMisses() << \"/\" << stats_" << i
+            << ".upper_bound.getAccesses() << \"\\n\";\n";
+    }
+    out << "}\n";
+
+    // end struct
+    out << "};\n";
+}
+
 // -------- Brie Relation --------
 
 /** Generate index set for a brie relation */
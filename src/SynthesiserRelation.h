@@ -66,6 +66,9 @@ public:
     static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(
             const RamRelationReference& ramRel, const IndexSet& indexSet, bool isProvenance);
 
+    /** Get the C++ identifier suffixing the constants and operators of a lattice association */
+    static std::string getLatticeIdentifier(const std::string& association);
+
 protected:
     /** Ram relation referred to by this */
     const RamRelationReference& relation;
@@ -118,6 +121,21 @@ public:
     void generateTypeStruct(std::ostream& out) override;
 };
 
+class SynthesiserLatticeRelation : public SynthesiserRelation {
+public:
+    SynthesiserLatticeRelation(
+            const RamRelationReference& ramRel, const IndexSet& indexSet, bool isProvenance)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+
+    void computeIndices() override;
+    std::string getTypeName() override;
+    void generateTypeStruct(std::ostream& out) override;
+
+protected:
+    /** Check whether an index stays ordered when the lattice element of a cell is updated in place */
+    bool isStableIndex(const std::vector<int>& ind) const;
+};
+
 class SynthesiserBrieRelation : public SynthesiserRelation {
 public:
     SynthesiserBrieRelation(const RamRelationReference& ramRel, const IndexSet& indexSet, bool isProvenance)
@@ -21,6 +21,7 @@
 #include "SymbolTable.h"
 
 #include <cassert>
+#include <vector>
 
 namespace souffle {
 
@@ -41,11 +42,25 @@ public:
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
+            finish();
             return;
         }
+        const size_t width = symbolMask.getArity();
+        std::vector<RamDomain> tuples;
+        tuples.reserve(BLOCK_SIZE * width);
+        size_t num = 0;
         for (const auto& current : relation) {
-            writeNext(current);
+            appendNext(tuples, current);
+            if (++num == BLOCK_SIZE) {
+                writeNextTuples(tuples.data(), num);
+                tuples.clear();
+                num = 0;
+            }
+        }
+        if (num > 0) {
+            writeNextTuples(tuples.data(), num);
         }
+        finish();
     }
     template <typename T>
     void writeSize(const T& relation) {
@@ -55,6 +70,9 @@ public:
     virtual ~WriteStream() = default;
 
 protected:
+    /** Number of tuples handed to writeNextTuples at once */
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
     const SymbolMask& symbolMask;
     const EnumTypeMask& enumTypeMask;
     const SymbolTable& symbolTable;
@@ -64,12 +82,23 @@ protected:
 
     virtual void writeNullary() = 0;
     virtual void writeNextTuple(const RamDomain* tuple) = 0;
+
+    /** Write a block of tuples, stored consecutively */
+    virtual void writeNextTuples(const RamDomain* tuples, size_t num) {
+        const size_t width = symbolMask.getArity();
+        for (size_t i = 0; i < num; ++i) {
+            writeNextTuple(tuples + i * width);
+        }
+    }
     virtual void writeSize(std::size_t size) {
         assert(false && "attempting to print size of a write operation");
     }
+
+    /** Complete the output after the last tuple, throwing if it could not be written */
+    virtual void finish() {}
     template <typename Tuple>
-    void writeNext(const Tuple tuple) {
-        writeNextTuple(tuple.data);
+    void appendNext(std::vector<RamDomain>& tuples, const Tuple& tuple) {
+        tuples.insert(tuples.end(), tuple.data, tuple.data + symbolMask.getArity());
     }
 };
 
@@ -82,8 +111,8 @@ public:
 };
 
 template <>
-inline void WriteStream::writeNext(const RamDomain* tuple) {
-    writeNextTuple(tuple);
+inline void WriteStream::appendNext(std::vector<RamDomain>& tuples, const RamDomain* const& tuple) {
+    tuples.insert(tuples.end(), tuple, tuple + symbolMask.getArity());
 }
 
 } /* namespace souffle */
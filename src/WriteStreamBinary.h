@@ -0,0 +1,168 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BinaryFormat.h"
+#include "EnumTypeMask.h"
+#include "IODirectives.h"
+#include "SymbolMask.h"
+#include "SymbolTable.h"
+#include "WriteStream.h"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+
+class WriteFileBinary : public WriteStream {
+public:
+    WriteFileBinary(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask, const SymbolTable& symbolTable,
+            const IODirectives& ioDirectives, const bool provenance = false)
+            : WriteStream(symbolMask, enumTypeMask, symbolTable, provenance), fileName(ioDirectives.getFileName()),
+              header(symbolMask.getArity()), file(fileName, std::ios::out | std::ios::binary) {
+        if (!file.is_open()) {
+            throw std::invalid_argument("Cannot open output file " + fileName + "\n");
+        }
+        std::vector<char> masks(header.getMaskSize(), 0);
+        for (size_t col = 0; col < header.arity; ++col) {
+            masks[col] = symbolMask.isSymbol(col);
+            masks[header.arity + col] = enumTypeMask.isEnumType(col);
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(masks.data(), masks.size());
+    }
+
+    ~WriteFileBinary() override = default;
+
+protected:
+    /**
+     * Append the symbol segment and complete the header. Until then the header
+     * has no symbol segment, so a file left incomplete is rejected by the reader.
+     */
+    void finish() override {
+        header.symbolOffset = file.tellp();
+        writeValue(symbols.size());
+        for (const std::string* symbol : symbols) {
+            writeValue(symbol->size());
+            file.write(symbol->data(), symbol->size());
+        }
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("Cannot write output file " + fileName + "\n");
+        }
+    }
+
+    void writeNullary() override {
+        writeNextTuples(nullptr, 1);
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        writeNextTuples(tuple, 1);
+    }
+
+    /** Write the tuples as a block of columns */
+    void writeNextTuples(const RamDomain* tuples, size_t num) override {
+        const size_t width = header.arity;
+        writeValue(num);
+        column.resize(num);
+        for (size_t col = 0; col < width; ++col) {
+            if (symbolMask.isSymbol(col)) {
+                for (size_t i = 0; i < num; ++i) {
+                    column[i] = getSymbolID(tuples[i * width + col]);
+                }
+            } else if (enumTypeMask.isEnumType(col)) {
+                // elements of enum types are written as their symbols, their indices depend on the program
+                for (size_t i = 0; i < num; ++i) {
+                    column[i] = getEnumID(tuples[i * width + col]);
+                }
+            } else {
+                for (size_t i = 0; i < num; ++i) {
+                    column[i] = tuples[i * width + col];
+                }
+            }
+            file.write(reinterpret_cast<const char*>(column.data()), num * sizeof(RamDomain));
+        }
+        header.numTuples += num;
+    }
+
+    void writeValue(uint64_t value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    /** Get the position of a symbol in the symbol segment of the file */
+    RamDomain getSymbolID(RamDomain index) {
+        auto it = symbolIDs.find(index);
+        if (it != symbolIDs.end()) {
+            return it->second;
+        }
+        RamDomain id = symbols.size();
+        symbolIDs[index] = id;
+        symbols.push_back(&symbolTable.unsafeResolve(index));
+        return id;
+    }
+
+    /**
+     * Get the position of the symbol of a value in an enum column. Values which
+     * are no enum symbols are written as numbers, like WriteStreamCSV does.
+     */
+    RamDomain getEnumID(RamDomain value) {
+        if (SymbolTable::isEnumSymbol(value)) {
+            return getSymbolID(value);
+        }
+        auto it = numberIDs.find(value);
+        if (it != numberIDs.end()) {
+            return it->second;
+        }
+        RamDomain id = symbols.size();
+        numberIDs[value] = id;
+        numbers.push_back(std::to_string(value));
+        symbols.push_back(&numbers.back());
+        return id;
+    }
+
+    std::string fileName;
+    BinaryHeader header;
+    std::ofstream file;
+    // the symbols written so far, in the order of their positions
+    std::vector<const std::string*> symbols;
+    std::unordered_map<RamDomain, RamDomain> symbolIDs;
+    // the values of enum columns which are no enum symbols, as strings
+    std::deque<std::string> numbers;
+    std::unordered_map<RamDomain, RamDomain> numberIDs;
+    std::vector<RamDomain> column;
+};
+
+class WriteFileBinaryFactory : public WriteStreamFactory {
+public:
+    std::unique_ptr<WriteStream> getWriter(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask,
+            const SymbolTable& symbolTable, const IODirectives& ioDirectives, const bool provenance) override {
+        return std::make_unique<WriteFileBinary>(symbolMask, enumTypeMask, symbolTable, ioDirectives, provenance);
+    }
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+    ~WriteFileBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -24,29 +24,119 @@
 #include "gzfstream.h"
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
-class WriteStreamCSV {
+class WriteStreamCSV : public WriteStream {
+public:
+    WriteStreamCSV(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask, const SymbolTable& symbolTable,
+            const IODirectives& ioDirectives, const bool provenance = false)
+            : WriteStream(symbolMask, enumTypeMask, symbolTable, provenance), delimiter(getDelimiter(ioDirectives)) {}
+
 protected:
+    /** Number of tuples formatted by a task */
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    const std::string delimiter;
+
     virtual std::string getDelimiter(const IODirectives& ioDirectives) const {
         if (ioDirectives.has("delimiter")) {
             return ioDirectives.get("delimiter");
         }
         return "\t";
     }
+
+    /** Write formatted text to the output */
+    virtual void writeText(const char* text, size_t size) = 0;
+
+    void writeNullary() override {
+        writeText("()\n", 3);
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        writeNextTuples(tuple, 1);
+    }
+
+    /**
+     * Format chunks of the tuples into buffers in parallel, and write the
+     * buffers in order.
+     */
+    void writeNextTuples(const RamDomain* tuples, size_t num) override {
+        const size_t width = symbolMask.getArity();
+        const size_t numChunks = (num + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (buffers.size() < numChunks) {
+            buffers.resize(numChunks);
+        }
+#ifndef USE_MPI
+#pragma omp parallel for schedule(dynamic) if (numChunks > 1)
+#endif
+        for (size_t i = 0; i < numChunks; i++) {
+            std::string& buffer = buffers[i];
+            buffer.clear();
+            const size_t end = std::min(num, (i + 1) * CHUNK_SIZE);
+            for (size_t j = i * CHUNK_SIZE; j < end; j++) {
+                formatTuple(buffer, tuples + j * width);
+            }
+        }
+        for (size_t i = 0; i < numChunks; i++) {
+            writeText(buffers[i].data(), buffers[i].size());
+        }
+    }
+
+    /** Append a tuple as a line of the output */
+    void formatTuple(std::string& buffer, const RamDomain* tuple) const {
+        for (size_t col = 0; col < arity; ++col) {
+            if (col > 0) {
+                buffer.append(delimiter);
+            }
+            if (symbolMask.isSymbol(col)) {
+                buffer.append(symbolTable.unsafeResolve(tuple[col]));
+            } else if (enumTypeMask.isEnumType(col)) {
+                buffer.append(symbolTable.enumTypeResolve(tuple[col]));
+            } else {
+                formatNumber(buffer, tuple[col]);
+            }
+        }
+        buffer.push_back('\n');
+    }
+
+    /** Append the decimal digits of a number */
+    static void formatNumber(std::string& buffer, RamDomain value) {
+        char digits[24];
+        char* pos = digits + sizeof(digits);
+        // negate in unsigned arithmetic, which covers the minimum of the domain
+        uint64_t magnitude = static_cast<uint64_t>(value);
+        if (value < 0) {
+            magnitude = 0 - magnitude;
+        }
+        do {
+            *--pos = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) {
+            *--pos = '-';
+        }
+        buffer.append(pos, digits + sizeof(digits));
+    }
+
+private:
+    // the buffers of the chunks of a block of tuples
+    std::vector<std::string> buffers;
 };
 
-class WriteFileCSV : public WriteStreamCSV, public WriteStream {
+class WriteFileCSV : public WriteStreamCSV {
 public:
     WriteFileCSV(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask, const SymbolTable& symbolTable,
             const IODirectives& ioDirectives, const bool provenance = false)
-            : WriteStream(symbolMask, enumTypeMask, symbolTable, provenance), delimiter(getDelimiter(ioDirectives)),
+            : WriteStreamCSV(symbolMask, enumTypeMask, symbolTable, ioDirectives, provenance),
               file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
             file << ioDirectives.get("attributeNames") << std::endl;
@@ -56,41 +146,19 @@ public:
     ~WriteFileCSV() override = default;
 
 protected:
-    const std::string delimiter;
     std::ofstream file;
 
-    void writeNullary() override {
-        file << "()\n";
-    }
-
-    void writeNextTuple(const RamDomain* tuple) override {
-        if (symbolMask.isSymbol(0)) {
-            file << symbolTable.unsafeResolve(tuple[0]);
-        } else if (enumTypeMask.isEnumType(0)) {
-        	file << symbolTable.enumTypeResolve(tuple[0]);
-        } else {
-            file << tuple[0];
-        }
-        for (size_t col = 1; col < arity; ++col) {
-            file << delimiter;
-            if (symbolMask.isSymbol(col)) {
-                file << symbolTable.unsafeResolve(tuple[col]);
-            } else if (enumTypeMask.isEnumType(col)) {
-            	file << symbolTable.enumTypeResolve(tuple[col]);
-            } else {
-                file << tuple[col];
-            }
-        }
-        file << "\n";
+    void writeText(const char* text, size_t size) override {
+        file.write(text, size);
     }
 };
 
 #ifdef USE_LIBZ
-class WriteGZipFileCSV : public WriteStreamCSV, public WriteStream {
+class WriteGZipFileCSV : public WriteStreamCSV {
 public:
     WriteGZipFileCSV(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask, const SymbolTable& symbolTable,
             const IODirectives& ioDirectives, const bool provenance = false)
-            : WriteStream(symbolMask, enumTypeMask, symbolTable, provenance), delimiter(getDelimiter(ioDirectives)),
+            : WriteStreamCSV(symbolMask, enumTypeMask, symbolTable, ioDirectives, provenance),
               file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
             file << ioDirectives.get("attributeNames") << std::endl;
@@ -100,41 +168,19 @@ public:
     ~WriteGZipFileCSV() override = default;
 
 protected:
-    void writeNullary() override {
-        file << "()\n";
+    void writeText(const char* text, size_t size) override {
+        file.write(text, size);
     }
 
-    void writeNextTuple(const RamDomain* tuple) override {
-        if (symbolMask.isSymbol(0)) {
-            file << symbolTable.unsafeResolve(tuple[0]);
-        } else if (enumTypeMask.isEnumType(0)) {
-        	file << symbolTable.enumTypeResolve(tuple[0]);
-        } else {
-            file << tuple[0];
-        }
-        for (size_t col = 1; col < arity; ++col) {
-            file << delimiter;
-            if (symbolMask.isSymbol(col)) {
-                file << symbolTable.unsafeResolve(tuple[col]);
-            } else if (enumTypeMask.isEnumType(col)) {
-            	file << symbolTable.enumTypeResolve(tuple[col]);
-            } else {
-                file << tuple[col];
-            }
-        }
-        file << "\n";
-    }
-
-    const std::string delimiter;
     gzfstream::ogzfstream file;
 };
 #endif
 
-class WriteCoutCSV : public WriteStreamCSV, public WriteStream {
+class WriteCoutCSV : public WriteStreamCSV {
 public:
     WriteCoutCSV(const SymbolMask& symbolMask, const EnumTypeMask& enumTypeMask, const SymbolTable& symbolTable,
             const IODirectives& ioDirectives, const bool provenance = false)
-            : WriteStream(symbolMask, enumTypeMask, symbolTable, provenance), delimiter(getDelimiter(ioDirectives)) {
+            : WriteStreamCSV(symbolMask, enumTypeMask, symbolTable, ioDirectives, provenance) {
         std::cout << "---------------\n" << ioDirectives.getRelationName();
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
             std::cout << "\n" << ioDirectives.get("attributeNames");
@@ -147,32 +193,9 @@ public:
     }
 
 protected:
-    void writeNullary() override {
-        std::cout << "()\n";
-    }
-
-    void writeNextTuple(const RamDomain* tuple) override {
-        if (symbolMask.isSymbol(0)) {
-            std::cout << symbolTable.unsafeResolve(tuple[0]);
-        } else if (enumTypeMask.isEnumType(0)) {
-        	std::cout << symbolTable.enumTypeResolve(tuple[0]);
-        } else {
-            std::cout << tuple[0];
-        }
-        for (size_t col = 1; col < arity; ++col) {
-            std::cout << delimiter;
-            if (symbolMask.isSymbol(col)) {
-                std::cout << symbolTable.unsafeResolve(tuple[col]);
-            } else if (enumTypeMask.isEnumType(col)) {
-            	std::cout << symbolTable.enumTypeResolve(tuple[col]);
-            } else {
-                std::cout << tuple[col];
-            }
-        }
-        std::cout << "\n";
+    void writeText(const char* text, size_t size) override {
+        std::cout.write(text, size);
     }
-
-    const std::string delimiter;
 };
 
 class WriteCoutPrintSize : public WriteStream {
@@ -15,27 +15,40 @@
 
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <zlib.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace souffle {
 
 namespace gzfstream {
 
 namespace internal {
 
+/**
+ * A stream buffer of a gzip file. Reading decompresses the file in a background thread into a ring of
+ * buffers. Writing compresses blocks of the output in parallel, as one gzip member of deflate blocks
+ * that end on byte boundaries (like pigz), so that the file can be read by any gzip tool.
+ */
 class gzfstreambuf : public std::streambuf {
 public:
-    gzfstreambuf() {
-        setp(buffer, buffer + (bufferSize - 1));
-        setg(buffer + reserveSize, buffer + reserveSize, buffer + reserveSize);
-    }
+    gzfstreambuf() = default;
 
     gzfstreambuf(const gzfstreambuf&) = delete;
 
-    gzfstreambuf(gzfstreambuf&& old) = default;
+    gzfstreambuf(gzfstreambuf&& old) = delete;
 
     gzfstreambuf* open(const std::string& filename, std::ios_base::openmode mode) {
         if (is_open()) {
@@ -46,11 +59,22 @@ public:
         }
 
         this->mode = mode;
-        std::string gzmode(mode & std::ios::in ? "rb" : "wb");
-        fileHandle = gzopen(filename.c_str(), gzmode.c_str());
-
-        if (!fileHandle) {
-            return nullptr;
+        if (mode & std::ios::in) {
+            fileHandle = gzopen(filename.c_str(), "rb");
+            if (!fileHandle) {
+                return nullptr;
+            }
+            setg(nullptr, nullptr, nullptr);
+        } else {
+            output = fopen(filename.c_str(), "wb");
+            if (!output) {
+                return nullptr;
+            }
+            // gzip header: deflate, no flags, no time, unix
+            const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+            fwrite(header, 1, sizeof(header), output);
+            crc = crc32(0L, Z_NULL, 0);
+            newBlock();
         }
         isOpen = true;
 
@@ -58,14 +82,23 @@ public:
     }
 
     gzfstreambuf* close() {
-        if (is_open()) {
-            sync();
-            isOpen = false;
-            if (gzclose(fileHandle) == Z_OK) {
-                return this;
-            }
+        if (!is_open()) {
+            return nullptr;
         }
-        return nullptr;
+        isOpen = false;
+        if (mode & std::ios::in) {
+            stopReader();
+            return (gzclose(fileHandle) == Z_OK) ? this : nullptr;
+        }
+        bool ok = queueBlock(true);
+        // gzip trailer: CRC-32 and size modulo 2^32, little endian
+        unsigned char trailer[8];
+        for (int i = 0; i < 4; ++i) {
+            trailer[i] = static_cast<unsigned char>(crc >> (8 * i));
+            trailer[4 + i] = static_cast<unsigned char>(totalSize >> (8 * i));
+        }
+        ok = ok && fwrite(trailer, 1, sizeof(trailer), output) == sizeof(trailer);
+        return (fclose(output) == 0 && ok) ? this : nullptr;
     }
 
     bool is_open() const {
@@ -85,18 +118,14 @@ protected:
         if (!(mode & std::ios::out) || !isOpen) {
             return EOF;
         }
-
+        if (pptr() == epptr() && !queueBlock()) {
+            return EOF;
+        }
         if (c != EOF) {
             *pptr() = c;
             pbump(1);
         }
-        int toWrite = pptr() - pbase();
-        if (gzwrite(fileHandle, pbase(), toWrite) != toWrite) {
-            return EOF;
-        }
-        pbump(-toWrite);
-
-        return c;
+        return traits_type::not_eof(c);
     }
 
     int_type underflow() override {
@@ -106,42 +135,211 @@ protected:
         if (gptr() && (gptr() < egptr())) {
             return traits_type::to_int_type(*gptr());
         }
+        if (atEnd) {
+            return EOF;
+        }
+        if (!reader.joinable()) {
+            ring.assign(ringSize, std::vector<char>(reserveSize + chunkSize));
+            sizes.assign(ringSize, 0);
+            reader = std::thread([this]() { decompress(); });
+        }
 
-        unsigned charsPutBack = gptr() - eback();
-        if (charsPutBack > reserveSize) {
-            charsPutBack = reserveSize;
+        std::unique_lock<std::mutex> lock(ringMutex);
+        // wait for the slot after the one being consumed
+        const size_t needed = holding ? 2 : 1;
+        ringChanged.wait(lock, [&]() { return filled >= needed; });
+        const size_t next = holding ? (current + 1) % ringSize : current;
+        char* slot = ring[next].data();
+
+        unsigned charsPutBack = 0;
+        if (holding) {
+            charsPutBack = gptr() - eback();
+            if (charsPutBack > reserveSize) {
+                charsPutBack = reserveSize;
+            }
+            memcpy(slot + reserveSize - charsPutBack, gptr() - charsPutBack, charsPutBack);
+            // hand the consumed slot back to the reader
+            --filled;
+            ringChanged.notify_all();
         }
-        memcpy(buffer + reserveSize - charsPutBack, gptr() - charsPutBack, charsPutBack);
+        current = next;
+        holding = true;
 
-        int charsRead = gzread(fileHandle, buffer + reserveSize, bufferSize - reserveSize);
+        int charsRead = sizes[next];
         if (charsRead <= 0) {
+            atEnd = true;
+            setg(slot + reserveSize - charsPutBack, slot + reserveSize, slot + reserveSize);
             return EOF;
         }
 
-        setg(buffer + reserveSize - charsPutBack, buffer + reserveSize, buffer + reserveSize + charsRead);
+        setg(slot + reserveSize - charsPutBack, slot + reserveSize, slot + reserveSize + charsRead);
 
         return traits_type::to_int_type(*gptr());
     }
 
     int sync() override {
-        if (pptr() && pptr() > pbase()) {
-            int toWrite = pptr() - pbase();
-            if (gzwrite(fileHandle, pbase(), toWrite) != toWrite) {
-                return -1;
-            }
-            pbump(-toWrite);
+        // compress and write the blocks queued so far; they end on a byte boundary, so the
+        // output written up to here can be decompressed
+        if (!(mode & std::ios::out) || !isOpen) {
+            return 0;
+        }
+        if (pptr() != pbase() && !queueBlock()) {
+            return -1;
         }
-        return 0;
+        return (compressBlocks(false) && fflush(output) == 0) ? 0 : -1;
     }
 
 private:
-    static constexpr unsigned int bufferSize = 65536;
+    /** Size of the decompressed chunks of the ring, and the number of chunks */
+    static constexpr unsigned int chunkSize = 1 << 18;
+    static constexpr unsigned int ringSize = 4;
     static constexpr unsigned int reserveSize = 16;
 
-    char buffer[bufferSize] = {};
-    gzFile fileHandle = {};
+    /** Size of the blocks compressed independently, and the size of the window primed from the previous block */
+    static constexpr size_t blockSize = 1 << 18;
+    static constexpr size_t windowSize = 1 << 15;
+
+    /** Fill the ring with decompressed chunks, until the end of the file or until stopped */
+    void decompress() {
+        for (size_t slot = 0;; slot = (slot + 1) % ringSize) {
+            {
+                std::unique_lock<std::mutex> lock(ringMutex);
+                ringChanged.wait(lock, [&]() { return filled < ringSize || stopped; });
+                if (stopped) {
+                    return;
+                }
+            }
+            // the slot is not visible to the consumer until it is counted as filled
+            int charsRead = gzread(fileHandle, ring[slot].data() + reserveSize, chunkSize);
+            std::lock_guard<std::mutex> lock(ringMutex);
+            sizes[slot] = charsRead;
+            ++filled;
+            ringChanged.notify_all();
+            if (charsRead <= 0) {
+                return;
+            }
+        }
+    }
+
+    void stopReader() {
+        if (reader.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(ringMutex);
+                stopped = true;
+                ringChanged.notify_all();
+            }
+            reader.join();
+        }
+    }
+
+    void newBlock() {
+        block.resize(blockSize);
+        setp(&block[0], &block[0] + blockSize);
+    }
+
+    /**
+     * Queue the written part of the current block, compressing the queue once it is long enough,
+     * or with the final block of the file when finishing.
+     */
+    bool queueBlock(bool finish = false) {
+        block.resize(pptr() - pbase());
+        blocks.push_back(std::move(block));
+        block = std::string();
+        if (finish) {
+            return compressBlocks(true);
+        }
+        newBlock();
+        size_t numThreads = 1;
+#ifdef _OPENMP
+        numThreads = omp_get_max_threads();
+#endif
+        return blocks.size() < 2 * numThreads || compressBlocks(false);
+    }
+
+    /** Compress the queued blocks in parallel and write them in order */
+    bool compressBlocks(bool finish) {
+        const size_t num = blocks.size();
+        std::vector<std::string> compressed(num);
+        std::vector<uLong> crcs(num);
+        // status of each block, such that the threads do not share a flag
+        std::vector<char> deflated(num);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < num; i++) {
+            const std::string& dictionary = (i == 0) ? window : blocks[i - 1];
+            deflated[i] = deflateBlock(blocks[i], dictionary, finish && i + 1 == num, compressed[i]);
+            crcs[i] = crc32(0L, reinterpret_cast<const Bytef*>(blocks[i].data()), blocks[i].size());
+        }
+        bool ok = true;
+        for (size_t i = 0; i < num; i++) {
+            ok = ok && deflated[i] &&
+                 fwrite(compressed[i].data(), 1, compressed[i].size(), output) == compressed[i].size();
+            crc = crc32_combine(crc, crcs[i], blocks[i].size());
+            totalSize += blocks[i].size();
+        }
+        // keep the end of the output as the dictionary of the next block
+        for (const std::string& cur : blocks) {
+            if (cur.size() >= windowSize) {
+                window.assign(cur, cur.size() - windowSize, windowSize);
+            } else {
+                window.append(cur);
+                if (window.size() > windowSize) {
+                    window.erase(0, window.size() - windowSize);
+                }
+            }
+        }
+        blocks.clear();
+        return ok;
+    }
+
+    /** Deflate a block as raw deflate data ending on a byte boundary, or as the final block */
+    static bool deflateBlock(const std::string& input, const std::string& dictionary, bool last, std::string& result) {
+        z_stream stream = {};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        if (!dictionary.empty()) {
+            const size_t size = std::min(dictionary.size(), windowSize);
+            deflateSetDictionary(&stream,
+                    reinterpret_cast<const Bytef*>(dictionary.data() + dictionary.size() - size), size);
+        }
+        // room for the flush markers of sync and final blocks
+        result.resize(deflateBound(&stream, input.size()) + 16);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = input.size();
+        stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+        stream.avail_out = result.size();
+        int status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        // a full output buffer may hold back the end of the flush marker
+        bool ok = (last ? status == Z_STREAM_END : status == Z_OK) && stream.avail_in == 0 &&
+                  stream.avail_out != 0;
+        result.resize(stream.total_out);
+        deflateEnd(&stream);
+        return ok;
+    }
+
     bool isOpen = false;
     std::ios_base::openmode mode = std::ios_base::in;
+
+    // reading: the file, the ring of chunks and their sizes, the slot being consumed
+    gzFile fileHandle = {};
+    std::vector<std::vector<char>> ring;
+    std::vector<int> sizes;
+    size_t filled = 0;
+    size_t current = 0;
+    bool holding = false;
+    bool atEnd = false;
+    bool stopped = false;
+    std::mutex ringMutex;
+    std::condition_variable ringChanged;
+    std::thread reader;
+
+    // writing: the file, the block being written and the blocks to be compressed
+    FILE* output = nullptr;
+    std::string block;
+    std::vector<std::string> blocks;
+    std::string window;
+    uLong crc = 0;
+    uLong totalSize = 0;
 };
 
 class gzfstream : virtual public std::ios {
@@ -173,8 +173,14 @@ int main(int argc, char** argv) {
                         "Enable magic set transformation changes on the given relations, use '*' "
                         "for all."},
                 {"macro", 'M', "MACROS", "", false, "Set macro definitions for the pre-processor"},
+                {"widening-delay", '\3', "N", "3", false,
+                        "Widen a lattice cell after N increases, if the lattice association has a "
+                        "widening operator."},
+                {"index-selection", '\4', "[ lazy | chain ]", "lazy", false,
+                        "Select the indices of the interpreter lazily per search, or up front by a minimal "
+                        "chain cover of the searches of each relation, dropping indices that are not probed."},
                 {"disable-transformers", 'z', "TRANSFORMERS", "", false,
-                        "Disable the given AST transformers."},
+                        "Disable the given AST and RAM transformers."},
                 {"dl-program", 'o', "FILE", "", false,
                         "Generate C++ source code, written to <FILE>, and compile this to a "
                         "binary executable (without executing it)."},
@@ -332,6 +338,12 @@ int main(int argc, char** argv) {
 #endif
         }
 
+        /* check the index selection of the interpreter */
+        const auto& indexSelection = Global::config().get("index-selection");
+        if (indexSelection != "lazy" && indexSelection != "chain") {
+            throw std::invalid_argument("Error: Index selection '" + indexSelection + "' is not supported.");
+        }
+
         if (Global::config().has("live-profile") && !Global::config().has("profile")) {
             Global::config().set("profile");
         }
@@ -486,12 +498,22 @@ int main(int argc, char** argv) {
     //ramTranslationUnit->getProgram()->getLattice()->print(std::cout);
 
     std::vector<std::unique_ptr<RamTransformer>> ramTransforms;
-    //ramTransforms.push_back(std::make_unique<LevelConditionsTransformer>());
-    //ramTransforms.push_back(std::make_unique<CreateIndicesTransformer>());
-    //ramTransforms.push_back(std::make_unique<ConvertExistenceChecksTransformer>());
+    ramTransforms.push_back(std::make_unique<LevelConditionsTransformer>());
+    ramTransforms.push_back(std::make_unique<CreateIndicesTransformer>());
+    ramTransforms.push_back(std::make_unique<ConvertExistenceChecksTransformer>());
     //ramTransforms.push_back(std::make_unique<RamSemanticChecker>());
 
+    std::set<std::string> disabledRamTransforms;
+    if (Global::config().has("disable-transformers")) {
+        std::vector<std::string> givenTransformers =
+                splitString(Global::config().get("disable-transformers"), ',');
+        disabledRamTransforms.insert(givenTransformers.begin(), givenTransformers.end());
+    }
+
     for (const auto& transform : ramTransforms) {
+        if (disabledRamTransforms.count(transform->getName()) > 0) {
+            continue;
+        }
         transform->apply(*ramTranslationUnit);
 
         /* Abort evaluation of the program if errors were encountered */
@@ -100,6 +100,7 @@
 %token BRIE_QUALIFIER            "BRIE datastructure qualifier"
 %token BTREE_QUALIFIER           "BTREE datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
+%token HASH_QUALIFIER            "HASH datastructure qualifier"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
 %token TMATCH                    "match predicate"
@@ -454,17 +455,21 @@ qualifiers
         $$ = $1 | INLINE_RELATION;
     }
   | qualifiers BRIE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION)) driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASH_RELATION)) driver.error(@2, "btree/brie/eqrel/hash qualifier already set");
         $$ = $1 | BRIE_RELATION;
     }
   | qualifiers BTREE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION)) driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASH_RELATION)) driver.error(@2, "btree/brie/eqrel/hash qualifier already set");
         $$ = $1 | BTREE_RELATION;
     }
   | qualifiers EQREL_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION)) driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASH_RELATION)) driver.error(@2, "btree/brie/eqrel/hash qualifier already set");
         $$ = $1 | EQREL_RELATION;
     }
+  | qualifiers HASH_QUALIFIER {
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASH_RELATION)) driver.error(@2, "btree/brie/eqrel/hash qualifier already set");
+        $$ = $1 | HASH_RELATION;
+    }
   | %empty {
         $$ = 0;
     }
@@ -532,6 +537,27 @@ lattice_asscoiation
   : LET IDENT LT GT EQUALS LPAREN STRING COMMA STRING COMMA IDENT COMMA IDENT RPAREN {
     	$$ = new AstLatticeAssociation($2);
     	$$->setALL($7, $9, $11, $13);
+    	$$->setSrcLoc(@$);
+  	}
+  | LET IDENT LT GT EQUALS LPAREN STRING COMMA STRING COMMA IDENT COMMA IDENT COMMA IDENT RPAREN {
+    	$$ = new AstLatticeAssociation($2);
+    	$$->setALL($7, $9, $11, $13);
+    	$$->setWidenNarrow($15, "");
+    	$$->setSrcLoc(@$);
+  	}
+  | LET IDENT LT GT EQUALS LPAREN STRING COMMA STRING COMMA IDENT COMMA IDENT COMMA IDENT COMMA IDENT RPAREN {
+    	$$ = new AstLatticeAssociation($2);
+    	$$->setALL($7, $9, $11, $13);
+    	$$->setWidenNarrow($15, $17);
+    	$$->setSrcLoc(@$);
+  	}
+  | LET IDENT LT GT EQUALS IDENT {
+    	$$ = new AstLatticeAssociation($2);
+    	if ($6 != "powerset") {
+    	    driver.error(@6, "unknown built-in lattice " + $6);
+    	}
+    	$$->setPowerset();
+    	$$->setSrcLoc(@$);
   	}
   	
 lattice_unary_def
@@ -0,0 +1,231 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file binary_io_test.cpp
+ *
+ * Tests writing and reading relations in the binary IO format.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BinaryFormat.h"
+#include "ReadStreamBinary.h"
+#include "WriteStreamBinary.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+namespace {
+
+const std::string FILE_NAME = "binary_io_test.bin";
+
+/** Tuples read from a file */
+struct Tuples {
+    size_t arity;
+    std::vector<std::vector<RamDomain>> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.emplace_back(tuple, tuple + arity);
+    }
+};
+
+IODirectives directives() {
+    return IODirectives({{"IO", "binary"}, {"filename", FILE_NAME}});
+}
+
+void write(const SymbolMask& symbolMask, const EnumTypeMask& enumMask, const SymbolTable& symbolTable,
+        const std::vector<std::vector<RamDomain>>& tuples) {
+    std::vector<const RamDomain*> relation;
+    for (const auto& cur : tuples) {
+        relation.push_back(cur.data());
+    }
+    WriteFileBinary(symbolMask, enumMask, symbolTable, directives()).writeAll(relation);
+}
+
+std::vector<std::vector<RamDomain>> read(
+        const SymbolMask& symbolMask, const EnumTypeMask& enumMask, SymbolTable& symbolTable) {
+    Tuples result{symbolMask.getArity(), {}};
+    ReadFileBinary(symbolMask, enumMask, symbolTable, directives()).readAll(result);
+    return result.tuples;
+}
+
+/** Whether reading the file fails */
+bool rejects(const SymbolMask& symbolMask, const EnumTypeMask& enumMask) {
+    SymbolTable symbolTable;
+    try {
+        read(symbolMask, enumMask, symbolTable);
+    } catch (std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+std::string readFile() {
+    std::ifstream in(FILE_NAME, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& data) {
+    std::ofstream(FILE_NAME, std::ios::binary).write(data.data(), data.size());
+}
+
+}  // namespace
+
+TEST(BinaryIO, SymbolColumns) {
+    SymbolMask symbolMask({true, false, true});
+    EnumTypeMask enumMask(3);
+    SymbolTable out;
+    std::vector<std::vector<RamDomain>> tuples;
+    for (RamDomain i = 0; i < 100; i++) {
+        tuples.push_back({out.lookup("a" + std::to_string(i % 7)), i - 50, out.lookup("b" + std::to_string(i))});
+    }
+    tuples.push_back({out.lookup(""), MIN_RAM_DOMAIN, out.lookup("a1")});
+    tuples.push_back({out.lookup("a\tb\nc"), MAX_RAM_DOMAIN, out.lookup("a2")});
+    write(symbolMask, enumMask, out, tuples);
+
+    // the symbols are mapped to the indices of another table
+    SymbolTable in({"x", "b99", "y"});
+    auto result = read(symbolMask, enumMask, in);
+    EXPECT_EQ(tuples.size(), result.size());
+    for (size_t i = 0; i < tuples.size() && i < result.size(); i++) {
+        EXPECT_EQ(out.resolve(tuples[i][0]), in.resolve(result[i][0]));
+        EXPECT_EQ(tuples[i][1], result[i][1]);
+        EXPECT_EQ(out.resolve(tuples[i][2]), in.resolve(result[i][2]));
+    }
+    EXPECT_EQ(1, in.lookup("b99"));
+    std::remove(FILE_NAME.c_str());
+}
+
+TEST(BinaryIO, EnumColumns) {
+    SymbolMask symbolMask(2);
+    EnumTypeMask enumMask({false, true});
+    SymbolTable out({"Bot", "Top"});
+    out.moveToEnd("Bot");
+    out.moveToEnd("Top");
+    write(symbolMask, enumMask, out, {{1, out.lookup("Top")}, {2, out.lookup("Bot")}});
+
+    // the enum elements have other indices in the reading table
+    SymbolTable in({"x", "Top", "Bot"});
+    in.moveToEnd("Top");
+    in.moveToEnd("Bot");
+    auto result = read(symbolMask, enumMask, in);
+    EXPECT_EQ(2, result.size());
+    EXPECT_EQ(in.lookup("Top"), result[0][1]);
+    EXPECT_EQ(in.lookup("Bot"), result[1][1]);
+
+    // elements which are not enum symbols of the reading table are rejected
+    SymbolTable other({"Top"});
+    other.moveToEnd("Top");
+    bool rejected = false;
+    try {
+        read(symbolMask, enumMask, other);
+    } catch (std::invalid_argument&) {
+        rejected = true;
+    }
+    EXPECT_TRUE(rejected);
+
+    // as are files whose enum columns differ from the relation
+    EXPECT_TRUE(rejects(symbolMask, EnumTypeMask(2)));
+    std::remove(FILE_NAME.c_str());
+}
+
+TEST(BinaryIO, EnumColumnNumbers) {
+    SymbolMask symbolMask({true, false});
+    EnumTypeMask enumMask({false, true});
+    SymbolTable out({"7", "Top"});
+    out.moveToEnd("Top");
+    // values of enum columns which are no enum symbols are written as numbers
+    write(symbolMask, enumMask, out, {{out.lookup("7"), 7}, {out.lookup("7"), out.lookup("Top")}});
+
+    // which are not elements of the enum type when read back
+    SymbolTable in({"Top"});
+    in.moveToEnd("Top");
+    std::string message;
+    try {
+        read(symbolMask, enumMask, in);
+    } catch (std::invalid_argument& e) {
+        message = e.what();
+    }
+    EXPECT_NE(std::string::npos, message.find("holds <7>"));
+    std::remove(FILE_NAME.c_str());
+}
+
+TEST(BinaryIO, Empty) {
+    SymbolMask symbolMask({true, false});
+    EnumTypeMask enumMask(2);
+    SymbolTable out;
+    write(symbolMask, enumMask, out, {});
+    SymbolTable in;
+    EXPECT_EQ(0, read(symbolMask, enumMask, in).size());
+
+    // nullary relations hold the empty tuple or nothing
+    SymbolMask nullary(0);
+    EnumTypeMask nullaryEnums(0);
+    write(nullary, nullaryEnums, out, {{}});
+    EXPECT_EQ(1, read(nullary, nullaryEnums, in).size());
+    write(nullary, nullaryEnums, out, {});
+    EXPECT_EQ(0, read(nullary, nullaryEnums, in).size());
+    std::remove(FILE_NAME.c_str());
+}
+
+TEST(BinaryIO, Rejected) {
+    SymbolMask symbolMask({true, false});
+    EnumTypeMask enumMask(2);
+    SymbolTable out;
+    write(symbolMask, enumMask, out, {{out.lookup("a"), 1}, {out.lookup("b"), 2}});
+    const std::string valid = readFile();
+    EXPECT_FALSE(rejects(symbolMask, enumMask));
+
+    // masks of another relation
+    EXPECT_TRUE(rejects(SymbolMask({false, false}), enumMask));
+    EXPECT_TRUE(rejects(SymbolMask({true, false, false}), EnumTypeMask(3)));
+
+    // a corrupted magic number
+    std::string data = valid;
+    data[0] = 'X';
+    writeFile(data);
+    EXPECT_TRUE(rejects(symbolMask, enumMask));
+
+    // a file truncated in the header or before the symbol segment
+    writeFile(valid.substr(0, sizeof(BinaryHeader) / 2));
+    EXPECT_TRUE(rejects(symbolMask, enumMask));
+    writeFile(valid.substr(0, valid.size() - 8));
+    EXPECT_TRUE(rejects(symbolMask, enumMask));
+
+    // a block count that overflows the size of the block, in a header agreeing with it
+    const size_t block = sizeof(BinaryHeader) + BinaryHeader(2).getMaskSize();
+    data = valid;
+    uint64_t count = ~static_cast<uint64_t>(0) / sizeof(RamDomain) + 2;
+    data.replace(block, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+    uint64_t total = ~static_cast<uint64_t>(0);
+    data.replace(offsetof(BinaryHeader, numTuples), sizeof(total), reinterpret_cast<const char*>(&total),
+            sizeof(total));
+    writeFile(data);
+    EXPECT_TRUE(rejects(symbolMask, enumMask));
+
+    // a number of tuples in the header which does not match the blocks
+    data = valid;
+    data[offsetof(BinaryHeader, numTuples)]++;
+    writeFile(data);
+    EXPECT_TRUE(rejects(symbolMask, enumMask));
+    std::remove(FILE_NAME.c_str());
+}
+
+}  // namespace test
+}  // namespace souffle
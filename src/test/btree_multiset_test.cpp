@@ -355,6 +355,27 @@ TEST(BTreeMultiSet, Load) {
     }
 }
 
+TEST(BTreeMultiSet, LoadSorted) {
+    using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 100; N++) {
+        // generate some ordered data with duplicates
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(i / 2);
+        }
+        test_set t;
+        t.loadSorted(data.begin(), data.end());
+        EXPECT_EQ(data.size(), t.size());
+        EXPECT_TRUE(t.check());
+
+        // the loaded tree accepts further insertions
+        t.insert(N);
+        EXPECT_TRUE(t.contains(N));
+        EXPECT_EQ(data.size() + 1, t.size());
+    }
+}
+
 TEST(BTreeMultiSet, Clear) {
     using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -0,0 +1,245 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file csv_io_test.cpp
+ *
+ * Tests reading fact files and writing output files. Plain fact files are
+ * parsed in chunks of the mapped file, compressed files line by line; both
+ * have to agree.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "ReadStreamCSV.h"
+#include "WriteStreamCSV.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+namespace {
+
+const std::string FILE_NAME = "csv_io_test.facts";
+
+/** Tuples read from a file */
+struct Tuples {
+    size_t arity;
+    std::vector<std::vector<RamDomain>> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.emplace_back(tuple, tuple + arity);
+    }
+};
+
+/** Rows read from a fact file, each as its comma-separated values, and the error of the file */
+struct Result {
+    std::vector<std::string> rows;
+    std::string error;
+};
+
+Result read(const std::string& content, const SymbolMask& symbolMask,
+        std::map<std::string, std::string> directives, bool compressed) {
+#ifdef USE_LIBZ
+    if (compressed) {
+        gzfstream::ogzfstream(FILE_NAME) << content;
+    }
+#endif
+    if (!compressed) {
+        std::ofstream(FILE_NAME, std::ios::binary) << content;
+    }
+    directives["filename"] = FILE_NAME;
+    SymbolTable symbolTable;
+    Tuples tuples{symbolMask.getArity(), {}};
+    Result result;
+    try {
+        ReadFileCSV(symbolMask, EnumTypeMask(symbolMask.getArity()), symbolTable, IODirectives(directives))
+                .readAll(tuples);
+    } catch (std::invalid_argument& e) {
+        result.error = e.what();
+    }
+    for (const auto& tuple : tuples.tuples) {
+        std::string row;
+        for (size_t i = 0; i < tuple.size(); i++) {
+            row += (i > 0) ? "," : "";
+            row += symbolMask.isSymbol(i) ? symbolTable.resolve(tuple[i]) : std::to_string(tuple[i]);
+        }
+        result.rows.push_back(row);
+    }
+    std::remove(FILE_NAME.c_str());
+    return result;
+}
+
+/** Read a fact file by both parsers; a difference between them is reported as an error */
+Result read(const std::string& content, const SymbolMask& symbolMask,
+        const std::map<std::string, std::string>& directives = {}) {
+    Result mapped = read(content, symbolMask, directives, false);
+#ifdef USE_LIBZ
+    Result streamed = read(content, symbolMask, directives, true);
+    if (mapped.rows != streamed.rows || mapped.error != streamed.error) {
+        mapped.error += "the compressed file is read differently";
+    }
+#endif
+    return mapped;
+}
+
+std::string numberError(const std::string& number, size_t column, size_t line) {
+    return "Error converting number <" + number + "> in column " + std::to_string(column) + " in line " +
+           std::to_string(line) + "; cannot parse fact file " + FILE_NAME + "!\n";
+}
+
+/** Write tuples to an output file, returning its text; without zlib compressed files are plain */
+std::string write(const SymbolMask& symbolMask, const EnumTypeMask& enumMask, const SymbolTable& symbolTable,
+        const std::vector<std::vector<RamDomain>>& tuples, std::map<std::string, std::string> directives,
+        bool compressed) {
+    std::vector<const RamDomain*> relation;
+    for (const auto& cur : tuples) {
+        relation.push_back(cur.data());
+    }
+    directives["filename"] = FILE_NAME;
+    std::string text;
+#ifdef USE_LIBZ
+    if (compressed) {
+        WriteGZipFileCSV(symbolMask, enumMask, symbolTable, IODirectives(directives)).writeAll(relation);
+        gzfstream::igzfstream in(FILE_NAME);
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        std::remove(FILE_NAME.c_str());
+        return text;
+    }
+#endif
+    WriteFileCSV(symbolMask, enumMask, symbolTable, IODirectives(directives)).writeAll(relation);
+    std::ifstream in(FILE_NAME, std::ios::binary);
+    text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    std::remove(FILE_NAME.c_str());
+    return text;
+}
+
+}  // namespace
+
+TEST(ReadCSV, Columns) {
+    // the fields of the file are stored in the columns given by their position in the directive
+    Result result = read("ign\t9\tk1\nign\t8\tk2\n", SymbolMask({true, false}), {{"columns", "2:1"}});
+    EXPECT_EQ(std::vector<std::string>({"k1,9", "k2,8"}), result.rows);
+    EXPECT_EQ("", result.error);
+
+    result = read("a::1::b\nc::2::d", SymbolMask({false, true, true}),
+            {{"delimiter", "::"}, {"columns", "1:0:2"}});
+    EXPECT_EQ(std::vector<std::string>({"1,a,b", "2,c,d"}), result.rows);
+}
+
+TEST(ReadCSV, WindowsLineEndings) {
+    Result result = read("a\t1\r\nb\t2\r\nc\t3", SymbolMask({true, false}));
+    EXPECT_EQ(std::vector<std::string>({"a,1", "b,2", "c,3"}), result.rows);
+    EXPECT_EQ("", result.error);
+
+    // the carriage return does not belong to the last symbol
+    result = read("1\ta\r\n", SymbolMask({false, true}));
+    EXPECT_EQ(std::vector<std::string>({"1,a"}), result.rows);
+}
+
+TEST(ReadCSV, Headers) {
+    Result result = read("x\ty\na\t1\nb\t2\n", SymbolMask({true, false}), {{"headers", "true"}});
+    EXPECT_EQ(std::vector<std::string>({"a,1", "b,2"}), result.rows);
+    EXPECT_EQ("", result.error);
+
+    result = read("x\ty\n", SymbolMask({true, false}), {{"headers", "true"}});
+    EXPECT_EQ(0, result.rows.size());
+}
+
+TEST(ReadCSV, MalformedLine) {
+    // the malformed line is in the second chunk of the mapped file
+    std::string content;
+    const size_t numRows = 150000;
+    for (size_t i = 0; i < numRows; i++) {
+        content += "symbol" + std::to_string(i) + "\t" + std::to_string(i) + "\n";
+    }
+    ASSERT_TRUE(content.size() > (1 << 20));
+    content += "bad\tzz\n";
+    for (size_t i = 0; i < 10; i++) {
+        content += "after\t" + std::to_string(i) + "\n";
+    }
+
+    Result result = read(content, SymbolMask({true, false}));
+    EXPECT_EQ(numberError("zz", 2, numRows + 1), result.error);
+    EXPECT_EQ(numRows, result.rows.size());
+    EXPECT_EQ("symbol0,0", result.rows.front());
+    EXPECT_EQ("symbol" + std::to_string(numRows - 1) + "," + std::to_string(numRows - 1), result.rows.back());
+
+    // rows before a line with missing values are kept as well
+    result = read("a\t1\nb\t2\n\nc\t3\n", SymbolMask({true, false}));
+    EXPECT_EQ("Values missing in line 3; cannot parse fact file " + FILE_NAME + "!\n", result.error);
+    EXPECT_EQ(std::vector<std::string>({"a,1", "b,2"}), result.rows);
+}
+
+TEST(ReadCSV, Numbers) {
+    const std::string max = std::to_string(MAX_RAM_DOMAIN);
+    const std::string min = std::to_string(MIN_RAM_DOMAIN);
+    Result result = read(max + "\n" + min + "\n-0\n+7\n 12\n3x\n", SymbolMask({false}));
+    EXPECT_EQ(std::vector<std::string>({max, min, "0", "7", "12", "3"}), result.rows);
+    EXPECT_EQ("", result.error);
+
+    // numbers out of the range of the domain are rejected
+    result = read("1\n" + max + "0\n", SymbolMask({false}));
+    EXPECT_EQ(std::vector<std::string>({"1"}), result.rows);
+    EXPECT_EQ(numberError(max + "0", 1, 2), result.error);
+
+    result = read(min + "0\n", SymbolMask({false}));
+    EXPECT_EQ(0, result.rows.size());
+    EXPECT_EQ(numberError(min + "0", 1, 1), result.error);
+
+    result = read("2\t-\n", SymbolMask({false, false}));
+    EXPECT_EQ(numberError("-", 2, 1), result.error);
+}
+
+TEST(WriteCSV, Tuples) {
+    // more tuples than fit into a chunk, and into a block of the writer
+    SymbolMask symbolMask({false, true, false, false});
+    EnumTypeMask enumMask({false, false, false, true});
+    SymbolTable symbolTable({"Bot", "Top"});
+    symbolTable.moveToEnd("Bot");
+    symbolTable.moveToEnd("Top");
+    const RamDomain numbers[] = {0, -1, 9, -10, 1234567, MIN_RAM_DOMAIN, MAX_RAM_DOMAIN, MIN_RAM_DOMAIN + 1};
+    std::vector<std::vector<RamDomain>> tuples;
+    std::ostringstream expected;
+    for (RamDomain i = 0; i < 70000; i++) {
+        const RamDomain number = numbers[i % 8] - (i % 8 < 5 ? i : 0);
+        const std::string symbol = (i % 3 == 0) ? "" : "s" + std::to_string(i % 1000);
+        const std::string element = (i % 2 == 0) ? "Top" : "Bot";
+        tuples.push_back({number, symbolTable.lookup(symbol), -i, symbolTable.lookup(element)});
+        expected << number << ":=" << symbol << ":=" << -i << ":=" << element << "\n";
+    }
+    const std::map<std::string, std::string> directives = {{"delimiter", ":="}};
+    EXPECT_EQ(expected.str(), write(symbolMask, enumMask, symbolTable, tuples, directives, false));
+    EXPECT_EQ(expected.str(), write(symbolMask, enumMask, symbolTable, tuples, directives, true));
+}
+
+TEST(WriteCSV, Headers) {
+    SymbolMask symbolMask({false, false});
+    EnumTypeMask enumMask(2);
+    SymbolTable symbolTable;
+    const std::map<std::string, std::string> directives = {{"headers", "true"}, {"attributeNames", "x\ty"}};
+    EXPECT_EQ("x\ty\n1\t-2\n", write(symbolMask, enumMask, symbolTable, {{1, -2}}, directives, false));
+    EXPECT_EQ("x\ty\n", write(symbolMask, enumMask, symbolTable, {}, directives, true));
+
+    // nullary relations hold the empty tuple or nothing
+    EXPECT_EQ("()\n", write(SymbolMask(0), EnumTypeMask(0), symbolTable, {{}}, {}, false));
+    EXPECT_EQ("", write(SymbolMask(0), EnumTypeMask(0), symbolTable, {}, {}, false));
+}
+
+}  // namespace test
+}  // namespace souffle
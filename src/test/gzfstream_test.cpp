@@ -0,0 +1,172 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file gzfstream_test.cpp
+ *
+ * Tests the gzip file streams, whose output is compressed in blocks.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "gzfstream.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include <zlib.h>
+
+namespace souffle {
+namespace test {
+
+namespace {
+
+const std::string FILE_NAME = "gzfstream_test.gz";
+
+std::string readFile() {
+    std::ifstream in(FILE_NAME, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/** Decompress a complete gzip stream by zlib, checking its trailer; empty if it is not valid */
+std::string gunzip(const std::string& data, bool& valid) {
+    z_stream stream = {};
+    valid = false;
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        return "";
+    }
+    std::string result;
+    char buffer[1 << 16];
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    int status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        result.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    valid = status == Z_STREAM_END && stream.avail_in == 0;
+    inflateEnd(&stream);
+    return result;
+}
+
+/** Decompress the data of a gzip file written so far, which lacks the trailer */
+std::string gunzipPrefix(const std::string& data) {
+    z_stream stream = {};
+    inflateInit2(&stream, 16 + MAX_WBITS);
+    std::string result;
+    char buffer[1 << 16];
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    int status = Z_OK;
+    while (status == Z_OK && (stream.avail_in > 0 || stream.avail_out == 0)) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_SYNC_FLUSH);
+        result.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return result;
+}
+
+/** Text of lines, mixed with random bytes which do not compress */
+std::string content(size_t size, unsigned seed) {
+    std::mt19937 random(seed);
+    std::string result;
+    for (size_t i = 0; result.size() < size; i++) {
+        if (i % 16 == 0) {
+            for (size_t j = 0; j < 1000; j++) {
+                result.push_back(static_cast<char>(random()));
+            }
+        }
+        result += "line " + std::to_string(i) + "\tvalue " + std::to_string(i % 97) + "\n";
+    }
+    result.resize(size);
+    return result;
+}
+
+}  // namespace
+
+TEST(GZipStream, WriteRead) {
+    const std::string first = content(700000, 1);
+    const std::string second = content(600000, 2);
+    {
+        gzfstream::ogzfstream out(FILE_NAME);
+        out << first;
+        out.flush();
+        EXPECT_TRUE(out.good());
+
+        // everything before the sync can be decompressed from the file
+        EXPECT_EQ(first, gunzipPrefix(readFile()));
+
+        // including after a second sync without new data
+        out.flush();
+        EXPECT_EQ(first, gunzipPrefix(readFile()));
+
+        out << second;
+        out.close();
+        EXPECT_TRUE(out.good());
+    }
+
+    // the file is a single valid gzip stream with the size and checksum of the data
+    bool valid = false;
+    EXPECT_EQ(first + second, gunzip(readFile(), valid));
+    EXPECT_TRUE(valid);
+
+    gzfstream::igzfstream in(FILE_NAME);
+    const std::string read(std::istreambuf_iterator<char>(in), {});
+    EXPECT_EQ(first + second, read);
+    std::remove(FILE_NAME.c_str());
+}
+
+TEST(GZipStream, Lines) {
+    {
+        gzfstream::ogzfstream out(FILE_NAME);
+        for (size_t i = 0; i < 100000; i++) {
+            out << "line " << i << "\n";
+            if (i % 30000 == 7) {
+                out.flush();
+            }
+        }
+    }
+    bool valid = false;
+    gunzip(readFile(), valid);
+    EXPECT_TRUE(valid);
+
+    gzfstream::igzfstream in(FILE_NAME);
+    std::string line;
+    size_t num = 0;
+    bool ordered = true;
+    while (std::getline(in, line)) {
+        ordered = ordered && line == "line " + std::to_string(num);
+        num++;
+    }
+    EXPECT_EQ(100000, num);
+    EXPECT_TRUE(ordered);
+    std::remove(FILE_NAME.c_str());
+}
+
+TEST(GZipStream, Empty) {
+    { gzfstream::ogzfstream out(FILE_NAME); }
+    bool valid = false;
+    EXPECT_EQ("", gunzip(readFile(), valid));
+    EXPECT_TRUE(valid);
+
+    gzfstream::igzfstream in(FILE_NAME);
+    EXPECT_EQ("", std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+    std::remove(FILE_NAME.c_str());
+}
+
+}  // namespace test
+}  // namespace souffle
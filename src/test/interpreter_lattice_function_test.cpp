@@ -0,0 +1,170 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file interpreter_lattice_function_test.cpp
+ *
+ * Tests and benchmarks the evaluation of lattice functions by the interpreter
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BinaryConstraintOps.h"
+#include "DebugReport.h"
+#include "ErrorReport.h"
+#include "Interpreter.h"
+#include "InterpreterContext.h"
+#include "RamCondition.h"
+#include "RamLatticeFunction.h"
+#include "RamLatticeFunctionAnalysis.h"
+#include "RamProgram.h"
+#include "RamStatement.h"
+#include "RamTranslationUnit.h"
+#include "RamValue.h"
+#include "SymbolTable.h"
+
+#include <chrono>
+#include <iomanip>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+namespace {
+
+/** An interpreter exposing the evaluation of lattice functions */
+class LatticeInterpreter : public Interpreter {
+public:
+    LatticeInterpreter(RamTranslationUnit& tUnit) : Interpreter(tUnit) {}
+
+    using Interpreter::evalLatticeFunction;
+
+    /**
+     * Evaluate a lattice function as the interpreter did before the cases were
+     * evaluated without allocation: the arguments are copied into a vector, and
+     * the nodes of the cases are visited by evalCond and evalVal
+     */
+    RamDomain evalLatticeFunctionByVisitor(const RamLatticeBinaryFunction& func, RamDomain x, RamDomain y) {
+        const RamLatticeFunctionTable& table =
+                getTranslationUnit().getAnalysis<RamLatticeFunctionAnalysis>()->getTable(func);
+        std::vector<RamDomain> arguments = {x, y};
+        if (const RamDomain* res = table.lookup(arguments.data())) {
+            return *res;
+        }
+        const RamLatticeFunctionTable::Entry& entry = table.getEntry(arguments.data());
+        switch (entry.kind) {
+            case RamLatticeFunctionTable::CONSTANT:
+                return entry.value;
+            case RamLatticeFunctionTable::ARGUMENT:
+                return arguments[entry.value];
+            case RamLatticeFunctionTable::CASES:
+                break;
+        }
+        InterpreterContext ctxt;
+        ctxt.setArguments(arguments);
+        for (const auto& cas : entry.cases) {
+            if (cas.match == nullptr || evalCond(*cas.match, ctxt)) {
+                return evalVal(*cas.output, ctxt);
+            }
+        }
+        return 0;
+    }
+};
+
+/**
+ * The maximum of two numbers, written such that every call evaluates cases:
+ *
+ *   case (0, _) => y, case (_, 0) => x, case (_, _) => x < y ? y : x
+ */
+std::shared_ptr<RamLatticeBinaryFunction> maxFunction() {
+    auto max = std::make_shared<RamLatticeBinaryFunction>();
+    max->addCase(std::make_unique<RamConstraint>(BinaryConstraintOp::EQ, std::make_unique<RamArgument>(0),
+                         std::make_unique<RamNumber>(0)),
+            std::make_unique<RamArgument>(1));
+    max->addCase(std::make_unique<RamConstraint>(BinaryConstraintOp::EQ, std::make_unique<RamArgument>(1),
+                         std::make_unique<RamNumber>(0)),
+            std::make_unique<RamArgument>(0));
+    max->addCase(std::make_unique<RamConstraint>(BinaryConstraintOp::LT, std::make_unique<RamArgument>(0),
+                         std::make_unique<RamArgument>(1)),
+            std::make_unique<RamArgument>(1));
+    max->addCase(nullptr, std::make_unique<RamArgument>(0));
+    return max;
+}
+
+}  // namespace
+
+TEST(LatticeFunction, Cases) {
+    SymbolTable symbols;
+    ErrorReport errors;
+    DebugReport debug;
+    auto program = std::make_unique<RamProgram>(std::make_unique<RamSequence>());
+    auto max = maxFunction();
+    program->addLBF("max", max);
+    RamTranslationUnit tUnit(std::move(program), symbols, errors, debug);
+    LatticeInterpreter interpreter(tUnit);
+
+    EXPECT_EQ(5, interpreter.evalLatticeFunction(*max, 0, 5));
+    EXPECT_EQ(5, interpreter.evalLatticeFunction(*max, 5, 0));
+    EXPECT_EQ(7, interpreter.evalLatticeFunction(*max, 3, 7));
+    EXPECT_EQ(7, interpreter.evalLatticeFunction(*max, 7, 3));
+    EXPECT_EQ(-1, interpreter.evalLatticeFunction(*max, -1, -2));
+
+    // the baseline of the benchmark computes the same function
+    EXPECT_EQ(5, interpreter.evalLatticeFunctionByVisitor(*max, 0, 5));
+    EXPECT_EQ(7, interpreter.evalLatticeFunctionByVisitor(*max, 7, 3));
+    EXPECT_EQ(-1, interpreter.evalLatticeFunctionByVisitor(*max, -1, -2));
+}
+
+TEST(LatticeFunction, Benchmark) {
+    // whether to print the recorded times to stdout, of both the evaluation of
+    // the cases and the visiting baseline; should be false unless developing
+    const bool ECHO_TIME = false;
+
+    SymbolTable symbols;
+    ErrorReport errors;
+    DebugReport debug;
+    auto program = std::make_unique<RamProgram>(std::make_unique<RamSequence>());
+    auto max = maxFunction();
+    program->addLBF("max", max);
+    RamTranslationUnit tUnit(std::move(program), symbols, errors, debug);
+    LatticeInterpreter interpreter(tUnit);
+
+    const int N = 20000;
+
+    // the allocation-free evaluation of the cases
+    RamDomain res = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 1; i <= N; i++) {
+        res = interpreter.evalLatticeFunction(*max, res, i % 1000 + 1);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    EXPECT_EQ(1000, res);
+
+    // the baseline, visiting the nodes of the cases
+    RamDomain baseline = 0;
+    auto baselineStart = std::chrono::high_resolution_clock::now();
+    for (int i = 1; i <= N; i++) {
+        baseline = interpreter.evalLatticeFunctionByVisitor(*max, baseline, i % 1000 + 1);
+    }
+    auto baselineEnd = std::chrono::high_resolution_clock::now();
+    EXPECT_EQ(1000, baseline);
+
+    if (ECHO_TIME) {
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double baselineSeconds = std::chrono::duration<double>(baselineEnd - baselineStart).count();
+        std::cout << "\tlattice function calls ... " << std::setw(12) << static_cast<long>(N / seconds)
+                  << " calls/s\n";
+        std::cout << "\tvisiting the cases ....... " << std::setw(12)
+                  << static_cast<long>(N / baselineSeconds) << " calls/s\n";
+    }
+}
+
+}  // end namespace test
+}  // end namespace souffle
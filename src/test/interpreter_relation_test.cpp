@@ -0,0 +1,454 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2018, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file interpreter_relation_test.cpp
+ *
+ * A test case testing the relations of the interpreter
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "InterpreterRelation.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+namespace {
+
+/** a chain lattice over numbers with top element 100 */
+const RamDomain TOP = 100;
+
+InterpreterLatticeRelation::lub_function maxLub() {
+    return [](RamDomain x, RamDomain y) { return std::max(x, y); };
+}
+
+}  // namespace
+
+TEST(InterpreterRelation, Basic) {
+    InterpreterRelation rel(2);
+    EXPECT_TRUE(rel.empty());
+
+    RamDomain a[2] = {1, 2};
+    RamDomain b[2] = {1, 3};
+    rel.insert(a);
+    rel.insert(b);
+    rel.insert(a);
+
+    EXPECT_EQ(2, rel.size());
+    EXPECT_TRUE(rel.exists(a));
+    EXPECT_TRUE(rel.exists(b));
+}
+
+TEST(InterpreterRelation, InsertBatch) {
+    InterpreterRelation rel(2);
+    RamDomain a[2] = {3, 1};
+    rel.insert(a);
+
+    // an index on the second column, which is updated by the batch as well
+    InterpreterIndex* idx = rel.getIndex(2);
+
+    // the batch repeats tuples and contains a stored one
+    RamDomain tuples[10] = {5, 0, 3, 1, 1, 2, 5, 0, 2, 2};
+    rel.insertBatch(tuples, 5);
+    EXPECT_EQ(4, rel.size());
+    EXPECT_TRUE(rel.exists(&tuples[0]));
+    EXPECT_TRUE(rel.exists(&tuples[4]));
+    EXPECT_TRUE(rel.exists(&tuples[8]));
+
+    RamDomain low[2] = {MIN_RAM_DOMAIN, 2};
+    RamDomain high[2] = {MAX_RAM_DOMAIN, 2};
+    auto range = idx->lowerUpperBound(low, high);
+    EXPECT_EQ(2, std::distance(range.first, range.second));
+
+    // the total index holds the batch as well
+    InterpreterIndex* first = rel.getIndex(1);
+    RamDomain key[2] = {5, MIN_RAM_DOMAIN};
+    RamDomain keyHigh[2] = {5, MAX_RAM_DOMAIN};
+    range = first->lowerUpperBound(key, keyHigh);
+    EXPECT_EQ(1, std::distance(range.first, range.second));
+}
+
+TEST(InterpreterRelation, InsertConcurrently) {
+    InterpreterRelation rel(2);
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < 1000; i++) {
+        tuples.push_back(i % 500);
+        tuples.push_back(i % 3);
+    }
+
+#pragma omp parallel for
+    for (size_t i = 0; i < 10; i++) {
+        rel.insertConcurrently(&tuples[i * 200], 100);
+    }
+
+    // (i % 500, i % 3) repeats with period 1500, so all 1000 tuples differ
+    EXPECT_EQ(1000, rel.size());
+    EXPECT_TRUE(rel.exists(&tuples[998]));
+}
+
+TEST(InterpreterRelation, ExistsConcurrently) {
+    InterpreterRelation rel(2);
+    for (RamDomain i = 0; i < 100; i++) {
+        RamDomain tuple[2] = {i, i % 7};
+        rel.insert(tuple);
+    }
+
+    // the first existence checks of parallel threads create the total index together
+    std::vector<const InterpreterIndex*> total(200);
+    std::vector<char> found(200);
+#pragma omp parallel for
+    for (RamDomain i = 0; i < 200; i++) {
+        RamDomain tuple[2] = {i, i % 7};
+        found[i] = rel.exists(tuple);
+        total[i] = rel.getTotalIndex();
+    }
+    for (RamDomain i = 0; i < 200; i++) {
+        EXPECT_EQ(i < 100, found[i] != 0);
+        EXPECT_EQ(total[0], total[i]);
+    }
+}
+
+TEST(InterpreterRelation, PlannedIndices) {
+    InterpreterRelation rel(3);
+    rel.planIndices({InterpreterIndexOrder({1, 0, 2})});
+
+    // searches on column 1 and on columns 0 and 1 share the planned index
+    InterpreterIndex* idx = rel.getIndex(0b010);
+    EXPECT_EQ(3, idx->order().size());
+    EXPECT_EQ(1, idx->order()[0]);
+    EXPECT_EQ(0, idx->order()[1]);
+    EXPECT_EQ(idx, rel.getIndex(0b011));
+
+    // searches not covered by the plan are indexed lazily
+    EXPECT_NE(idx, rel.getIndex(0b100));
+}
+
+TEST(InterpreterRelation, SeekIndices) {
+    InterpreterRelation rel(3);
+    rel.planIndices({InterpreterIndexOrder({1, 0, 2})});
+
+    // seeking column 0 within ranges of column 1 uses the planned index
+    InterpreterIndex* idx = rel.getSeekIndex(0b010, 0);
+    EXPECT_EQ(1, idx->order()[0]);
+    EXPECT_EQ(0, idx->order()[1]);
+
+    // seeking column 2 within ranges of column 1 needs another order
+    InterpreterIndex* other = rel.getSeekIndex(0b010, 2);
+    EXPECT_NE(idx, other);
+    EXPECT_EQ(1, other->order()[0]);
+    EXPECT_EQ(2, other->order()[1]);
+    EXPECT_EQ(other, rel.getSeekIndex(0b010, 2));
+
+    // seeking column 1 over the whole relation
+    EXPECT_EQ(idx, rel.getSeekIndex(0b000, 1));
+}
+
+TEST(InterpreterRelation, DropUnusedIndices) {
+    InterpreterRelation rel(2);
+    rel.trackIndices(true);
+    const InterpreterIndex* total = rel.getTotalIndex();
+
+    RamDomain t[2] = {1, 2};
+    RamDomain low[2] = {MIN_RAM_DOMAIN, 2};
+    RamDomain high[2] = {MAX_RAM_DOMAIN, 2};
+    InterpreterIndex* idx = rel.getIndex(0b10);
+    rel.insert(t);
+    idx->lowerUpperBound(low, high);
+    RamDomain missing[2] = {1, 3};
+    idx->lowerUpperBound(missing, missing);
+    EXPECT_EQ(2, idx->getProbes());
+    EXPECT_EQ(1, idx->getHits());
+
+    // probed since the last purge: kept with its probes, where a re-created
+    // index would start from none
+    rel.purge();
+    EXPECT_EQ(2, rel.getIndex(InterpreterIndexOrder({1, 0}))->getProbes());
+    EXPECT_EQ(1, rel.getIndex(InterpreterIndexOrder({1, 0}))->getHits());
+
+    // not probed since the last purge: dropped, but its probes are retained
+    rel.insert(t);
+    rel.purge();
+    EXPECT_EQ(total, rel.getTotalIndex());
+    auto stats = rel.getProbeStatistics();
+    EXPECT_EQ(2, stats[InterpreterIndexOrder({1, 0})].first);
+    EXPECT_EQ(1, stats[InterpreterIndexOrder({1, 0})].second);
+
+    // the index is re-created on its next search, and its probes add to the
+    // retained ones
+    rel.insert(t);
+    idx = rel.getIndex(0b10);
+    EXPECT_EQ(0, idx->getProbes());
+    EXPECT_EQ(1, idx->order()[0]);
+    EXPECT_TRUE(idx->lowerUpperBound(low, high).first != idx->end());
+    stats = rel.getProbeStatistics();
+    EXPECT_EQ(3, stats[InterpreterIndexOrder({1, 0})].first);
+    EXPECT_EQ(2, stats[InterpreterIndexOrder({1, 0})].second);
+}
+
+TEST(InterpreterRelation, HashIndices) {
+    InterpreterRelation rel(2);
+
+    // tuples stored before the hash index is created are indexed
+    for (RamDomain i = 0; i < 100; i++) {
+        RamDomain t[2] = {i % 10, i};
+        rel.insert(t);
+    }
+    InterpreterHashIndex* idx = rel.getHashIndex(0b01);
+    EXPECT_EQ(idx, rel.getHashIndex(0b01));
+    RamDomain key[2] = {3, 0};
+    EXPECT_EQ(10, idx->equalRange(key).size());
+    for (const RamDomain* cur : idx->equalRange(key)) {
+        EXPECT_EQ(3, cur[0]);
+    }
+
+    // later insertions follow, including batches and further groups
+    RamDomain t[2] = {3, 100};
+    rel.insert(t);
+    RamDomain batch[6] = {3, 101, 42, 0, 42, 1};
+    rel.insertBatch(batch, 3);
+    EXPECT_EQ(12, idx->equalRange(key).size());
+    key[0] = 42;
+    EXPECT_EQ(2, idx->equalRange(key).size());
+    key[0] = 11;
+    EXPECT_TRUE(idx->equalRange(key).empty());
+
+    // purging empties the index
+    rel.purge();
+    key[0] = 3;
+    EXPECT_TRUE(idx->equalRange(key).empty());
+    rel.insert(t);
+    EXPECT_EQ(1, idx->equalRange(key).size());
+}
+
+TEST(InterpreterLatticeRelation, OneValuePerCell) {
+    InterpreterLatticeRelation rel(3, maxLub(), TOP);
+
+    RamDomain t1[3] = {1, 2, 5};
+    RamDomain t2[3] = {1, 2, 3};
+    RamDomain t3[3] = {1, 2, 7};
+    RamDomain t4[3] = {1, 3, 4};
+    rel.insert(t1);
+    rel.insert(t2);
+    EXPECT_EQ(1, rel.size());
+    EXPECT_TRUE(rel.exists(t1));
+    EXPECT_FALSE(rel.exists(t2));
+
+    rel.insert(t3);
+    EXPECT_EQ(1, rel.size());
+    EXPECT_FALSE(rel.exists(t1));
+    EXPECT_TRUE(rel.exists(t3));
+
+    rel.insert(t4);
+    EXPECT_EQ(2, rel.size());
+    EXPECT_EQ(7, rel.getCell(t1)[2]);
+    EXPECT_EQ(4, rel.getCell(t4)[2]);
+}
+
+TEST(InterpreterLatticeRelation, CellsConcurrently) {
+    InterpreterLatticeRelation rel(2, maxLub(), TOP);
+    for (RamDomain i = 0; i < 100; i++) {
+        RamDomain tuple[2] = {i, i % 50};
+        rel.insert(tuple);
+    }
+
+    // the first cell lookups of parallel threads create the cell index together
+    std::vector<RamDomain> element(200, -1);
+#pragma omp parallel for
+    for (RamDomain i = 0; i < 200; i++) {
+        RamDomain tuple[2] = {i, 0};
+        const RamDomain* cell = rel.getCell(tuple);
+        element[i] = cell == nullptr ? -1 : cell[1];
+    }
+    for (RamDomain i = 0; i < 200; i++) {
+        EXPECT_EQ(i < 100 ? i % 50 : -1, element[i]);
+    }
+}
+
+TEST(InterpreterLatticeRelation, TopAbsorbs) {
+    int calls = 0;
+    InterpreterLatticeRelation rel(2,
+            [&](RamDomain, RamDomain) -> RamDomain {
+                ++calls;
+                return TOP;
+            },
+            TOP);
+
+    RamDomain t1[2] = {1, TOP};
+    RamDomain t2[2] = {1, 3};
+    rel.insert(t1);
+    rel.insert(t2);
+    EXPECT_EQ(1, rel.size());
+    EXPECT_TRUE(rel.exists(t1));
+
+    // the top element short-cuts the join
+    EXPECT_EQ(0, calls);
+}
+
+TEST(InterpreterLatticeRelation, IndicesFollowUpdates) {
+    InterpreterLatticeRelation rel(2, maxLub(), TOP);
+
+    RamDomain t1[2] = {1, 5};
+    RamDomain t2[2] = {2, 6};
+    rel.insert(t1);
+    rel.insert(t2);
+
+    // an index sorted by the lattice column first
+    InterpreterIndexOrder order;
+    order.append(1);
+    order.append(0);
+    InterpreterIndex* idx = rel.getIndex(order);
+
+    RamDomain t3[2] = {1, 9};
+    rel.insert(t3);
+
+    std::vector<RamDomain> keys;
+    for (auto it = idx->begin(); it != idx->end(); ++it) {
+        keys.push_back((*it)[0]);
+    }
+    EXPECT_EQ(2, keys.size());
+    EXPECT_EQ(2, keys[0]);
+    EXPECT_EQ(1, keys[1]);
+
+    // every index, including the cell index, holds the joined cell and no
+    // longer the one it replaced
+    const auto orders = rel.getProbeStatistics();
+    EXPECT_EQ(2, orders.size());
+    for (const auto& cur : orders) {
+        InterpreterIndex* index = rel.getIndex(cur.first);
+        size_t count = 0;
+        for (auto it = index->begin(); it != index->end(); ++it) {
+            EXPECT_FALSE((*it)[0] == 1 && (*it)[1] == 5);
+            count++;
+        }
+        EXPECT_EQ(2, count);
+
+        RamDomain oldLow[2] = {1, 5};
+        RamDomain oldHigh[2] = {1, 5};
+        auto oldRange = index->lowerUpperBound(oldLow, oldHigh);
+        EXPECT_TRUE(oldRange.first == oldRange.second);
+
+        RamDomain newLow[2] = {1, 9};
+        RamDomain newHigh[2] = {1, 9};
+        auto newRange = index->lowerUpperBound(newLow, newHigh);
+        ASSERT_TRUE(newRange.first != newRange.second);
+        EXPECT_EQ(1, (*newRange.first)[0]);
+        EXPECT_EQ(9, (*newRange.first)[1]);
+        EXPECT_TRUE(++newRange.first == newRange.second);
+
+        // the range of the old element along the lattice column is empty
+        RamDomain colLow[2] = {MIN_RAM_DOMAIN, 5};
+        RamDomain colHigh[2] = {MAX_RAM_DOMAIN, 5};
+        if (cur.first[0] == 1) {
+            auto colRange = index->lowerUpperBound(colLow, colHigh);
+            EXPECT_TRUE(colRange.first == colRange.second);
+        }
+    }
+}
+
+TEST(InterpreterLatticeRelation, ComponentWiseJoin) {
+    // a product of the max chain and the min chain (reversed order, top 0)
+    InterpreterLatticeRelation rel(3, {{maxLub(), TOP, nullptr},
+                                              {[](RamDomain x, RamDomain y) { return std::min(x, y); }, 0,
+                                                      nullptr}});
+    EXPECT_EQ(2, rel.getLatticeArity());
+
+    RamDomain t1[3] = {1, 5, 8};
+    RamDomain t2[3] = {1, 7, 9};
+    RamDomain t3[3] = {1, 3, 2};
+    RamDomain t4[3] = {2, 3, 2};
+    rel.insert(t1);
+    rel.insert(t2);
+    EXPECT_EQ(1, rel.size());
+    EXPECT_EQ(7, rel.getCell(t1)[1]);
+    EXPECT_EQ(8, rel.getCell(t1)[2]);
+
+    rel.insert(t3);
+    EXPECT_EQ(7, rel.getCell(t1)[1]);
+    EXPECT_EQ(2, rel.getCell(t1)[2]);
+
+    // absorbed joins do not report a change
+    EXPECT_EQ(nullptr, rel.update(t2));
+
+    rel.insert(t4);
+    EXPECT_EQ(2, rel.size());
+    EXPECT_EQ(3, rel.getCell(t4)[1]);
+}
+
+TEST(InterpreterLatticeRelation, WidensMergedCells) {
+    // widens to the top element once a cell has increased in a merge
+    InterpreterLatticeRelation rel(2, maxLub(), TOP, [](RamDomain, RamDomain) { return TOP; }, 1);
+
+    // inserts outside of the fixpoint never widen
+    RamDomain t1[2] = {1, 1};
+    RamDomain t2[2] = {1, 2};
+    RamDomain t3[2] = {1, 3};
+    rel.insert(t1);
+    rel.insert(t2);
+    rel.insert(t3);
+    EXPECT_EQ(3, rel.getCell(t1)[1]);
+
+    InterpreterLatticeRelation::Join res;
+    RamDomain t4[2] = {1, 4};
+    ASSERT_TRUE(rel.join(t4, res));
+    EXPECT_EQ(4, rel.commit(t4, res)[1]);
+
+    RamDomain t5[2] = {1, 5};
+    ASSERT_TRUE(rel.join(t5, res));
+    EXPECT_EQ(TOP, rel.commit(t5, res)[1]);
+}
+
+TEST(InterpreterLatticeRelation, CommitsRaisedCells) {
+    // sets of bits, so that joins are not one of their elements
+    InterpreterLatticeRelation rel(2, [](RamDomain x, RamDomain y) { return x | y; }, 15);
+    RamDomain t1[2] = {1, 1};
+    rel.insert(t1);
+
+    // unchanged and lower elements are absorbed
+    InterpreterLatticeRelation::Join res;
+    EXPECT_FALSE(rel.join(t1, res));
+    RamDomain t2[2] = {1, 0};
+    EXPECT_FALSE(rel.join(t2, res));
+
+    // a raised cell is committed with the joined element
+    RamDomain t3[2] = {1, 2};
+    ASSERT_TRUE(rel.join(t3, res));
+    const RamDomain* cell = rel.commit(t3, res);
+    ASSERT_TRUE(cell != nullptr);
+    EXPECT_EQ(3, cell[1]);
+    EXPECT_EQ(1, rel.size());
+
+    // joins computed before the cell changed are recomputed on commit
+    RamDomain t4[2] = {1, 4};
+    RamDomain t5[2] = {1, 8};
+    InterpreterLatticeRelation::Join res4;
+    InterpreterLatticeRelation::Join res5;
+    ASSERT_TRUE(rel.join(t4, res4));
+    ASSERT_TRUE(rel.join(t5, res5));
+    EXPECT_EQ(7, rel.commit(t4, res4)[1]);
+    EXPECT_EQ(15, rel.commit(t5, res5)[1]);
+
+    // ... and not committed if the cell absorbs them by then
+    RamDomain t6[2] = {2, 1};
+    RamDomain t7[2] = {2, 2};
+    rel.insert(t6);
+    ASSERT_TRUE(rel.join(t7, res4));
+    ASSERT_TRUE(rel.join(t7, res5));
+    EXPECT_EQ(3, rel.commit(t7, res4)[1]);
+    EXPECT_EQ(nullptr, rel.commit(t7, res5));
+    EXPECT_EQ(2, rel.size());
+}
+
+}  // end namespace test
+}  // end namespace souffle
@@ -0,0 +1,219 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ram_lattice_function_table_test.cpp
+ *
+ * Tests the lookup tables of lattice functions
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BinaryConstraintOps.h"
+#include "RamCondition.h"
+#include "RamLatticeFunctionAnalysis.h"
+#include "RamValue.h"
+#include "SymbolTable.h"
+
+#include <memory>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+namespace {
+
+/** The test arg_pos = value */
+std::unique_ptr<RamCondition> isValue(size_t pos, RamDomain value) {
+    return std::make_unique<RamConstraint>(
+            BinaryConstraintOp::EQ, std::make_unique<RamArgument>(pos), std::make_unique<RamNumber>(value));
+}
+
+/** Cases of a lattice function; owns the nodes the table refers to */
+class Cases {
+public:
+    void add(std::unique_ptr<RamCondition> match, std::unique_ptr<RamValue> output) {
+        cases.push_back({match.get(), output.get()});
+        matches.push_back(std::move(match));
+        outputs.push_back(std::move(output));
+    }
+
+    const std::vector<RamLatticeFunctionTable::Case>& get() const {
+        return cases;
+    }
+
+private:
+    std::vector<RamLatticeFunctionTable::Case> cases;
+    std::vector<std::unique_ptr<RamCondition>> matches;
+    std::vector<std::unique_ptr<RamValue>> outputs;
+};
+
+/**
+ * A join over the enum symbols bot, mid and top starting at the given base:
+ *
+ *   case (bot, _) => y, case (_, bot) => x, case (_, _) => top
+ */
+Cases enumJoin(RamDomain base) {
+    Cases res;
+    res.add(isValue(0, base), std::make_unique<RamArgument>(1));
+    res.add(isValue(1, base), std::make_unique<RamArgument>(0));
+    res.add(nullptr, std::make_unique<RamNumber>(base + 2));
+    return res;
+}
+
+}  // namespace
+
+TEST(LatticeFunctionTable, Entries) {
+    // case (1, _) => y, case (_, 1) => x, case (2, 3) => 4, case x < y => y, case (_, _) => 9
+    Cases cases;
+    cases.add(isValue(0, 1), std::make_unique<RamArgument>(1));
+    cases.add(isValue(1, 1), std::make_unique<RamArgument>(0));
+    cases.add(std::make_unique<RamConjunction>(isValue(0, 2), isValue(1, 3)), std::make_unique<RamNumber>(4));
+    cases.add(std::make_unique<RamConstraint>(BinaryConstraintOp::LT, std::make_unique<RamArgument>(0),
+                      std::make_unique<RamArgument>(1)),
+            std::make_unique<RamArgument>(1));
+    cases.add(nullptr, std::make_unique<RamNumber>(9));
+    RamLatticeFunctionTable table(cases.get(), 2, 0, 0);
+    EXPECT_EQ(2, table.getArity());
+
+    // the tested constants are classes of their own, all other values share one
+    EXPECT_EQ(0, table.getClass(1));
+    EXPECT_EQ(1, table.getClass(2));
+    EXPECT_EQ(2, table.getClass(3));
+    EXPECT_EQ(3, table.getClass(0));
+    EXPECT_EQ(3, table.getClass(7));
+
+    RamDomain first[2] = {1, 7};
+    EXPECT_EQ(RamLatticeFunctionTable::ARGUMENT, table.getEntry(first).kind);
+    EXPECT_EQ(1, table.getEntry(first).value);
+
+    RamDomain second[2] = {7, 1};
+    EXPECT_EQ(RamLatticeFunctionTable::ARGUMENT, table.getEntry(second).kind);
+    EXPECT_EQ(0, table.getEntry(second).value);
+
+    // the earlier case wins where two cases match unconditionally
+    RamDomain both[2] = {1, 1};
+    EXPECT_EQ(RamLatticeFunctionTable::ARGUMENT, table.getEntry(both).kind);
+    EXPECT_EQ(1, table.getEntry(both).value);
+
+    RamDomain pair[2] = {2, 3};
+    EXPECT_EQ(RamLatticeFunctionTable::CONSTANT, table.getEntry(pair).kind);
+    EXPECT_EQ(4, table.getEntry(pair).value);
+
+    // other values keep the residual test and the default case, in order
+    RamDomain other[2] = {5, 6};
+    const auto& entry = table.getEntry(other);
+    EXPECT_EQ(RamLatticeFunctionTable::CASES, entry.kind);
+    EXPECT_EQ(2, entry.cases.size());
+    EXPECT_EQ(cases.get()[3].match, entry.cases[0].match);
+    EXPECT_EQ(nullptr, entry.cases[1].match);
+    EXPECT_EQ(cases.get()[4].output, entry.cases[1].output);
+
+    // the case on (2, 3) does not apply to (2, 5)
+    RamDomain half[2] = {2, 5};
+    EXPECT_EQ(2, table.getEntry(half).cases.size());
+
+    // no enum symbols are tested, so there is no dense table
+    EXPECT_FALSE(table.isFinite());
+    EXPECT_EQ(nullptr, table.lookup(pair));
+}
+
+TEST(LatticeFunctionTable, Tabulation) {
+    const RamDomain base = SymbolTable::enumStart();
+    Cases cases = enumJoin(base);
+    RamLatticeFunctionTable table(cases.get(), 2, base, 3);
+    EXPECT_TRUE(table.isFinite());
+
+    // nothing is looked up before the table is computed
+    RamDomain args[2] = {base, base + 1};
+    EXPECT_EQ(nullptr, table.lookup(args));
+
+    size_t calls = 0;
+    auto eval = [&](const RamDomain* args) {
+        calls++;
+        if (args[0] == base) {
+            return args[1];
+        }
+        return args[1] == base ? args[0] : base + 2;
+    };
+    table.tabulate(eval);
+    EXPECT_EQ(9, calls);
+
+    // every pair of symbols is tabulated
+    for (RamDomain x = base; x < base + 3; x++) {
+        for (RamDomain y = base; y < base + 3; y++) {
+            RamDomain pair[2] = {x, y};
+            const RamDomain* res = table.lookup(pair);
+            ASSERT_TRUE(res != nullptr);
+            EXPECT_EQ(eval(pair), *res);
+        }
+    }
+
+    // the table is computed once
+    calls = 0;
+    table.tabulate(eval);
+    EXPECT_EQ(0, calls);
+}
+
+TEST(LatticeFunctionTable, OutsideDomain) {
+    const RamDomain base = SymbolTable::enumStart();
+    Cases cases = enumJoin(base);
+    RamLatticeFunctionTable table(cases.get(), 2, base, 3);
+    table.tabulate([&](const RamDomain* args) { return base; });
+
+    // arguments outside the window of symbols fall back to the entries
+    RamDomain below[2] = {base - 1, base};
+    RamDomain above[2] = {base, base + 3};
+    RamDomain zero[2] = {0, 0};
+    RamDomain lowest[2] = {MIN_RAM_DOMAIN, base};
+    RamDomain highest[2] = {base, MAX_RAM_DOMAIN};
+    EXPECT_EQ(nullptr, table.lookup(below));
+    EXPECT_EQ(nullptr, table.lookup(above));
+    EXPECT_EQ(nullptr, table.lookup(zero));
+    EXPECT_EQ(nullptr, table.lookup(lowest));
+    EXPECT_EQ(nullptr, table.lookup(highest));
+
+    EXPECT_EQ(RamLatticeFunctionTable::ARGUMENT, table.getEntry(below).kind);
+    EXPECT_EQ(0, table.getEntry(below).value);
+    EXPECT_EQ(RamLatticeFunctionTable::CONSTANT, table.getEntry(zero).kind);
+    EXPECT_EQ(base + 2, table.getEntry(zero).value);
+}
+
+TEST(LatticeFunctionTable, NotTabulated) {
+    const RamDomain base = SymbolTable::enumStart();
+
+    // without a window of enum symbols
+    Cases join = enumJoin(base);
+    RamLatticeFunctionTable empty(join.get(), 2, base, 0);
+    EXPECT_FALSE(empty.isFinite());
+
+    // the tested constants lie outside the window
+    RamLatticeFunctionTable elsewhere(join.get(), 2, base + 3, 3);
+    EXPECT_FALSE(elsewhere.isFinite());
+
+    // a case may fail for some arguments, so its results cannot all be tabulated
+    Cases partial;
+    partial.add(isValue(0, base), std::make_unique<RamArgument>(1));
+    partial.add(isValue(1, base), std::make_unique<RamArgument>(0));
+    RamLatticeFunctionTable failing(partial.get(), 2, base, 3);
+    EXPECT_FALSE(failing.isFinite());
+
+    size_t calls = 0;
+    failing.tabulate([&](const RamDomain* args) {
+        calls++;
+        return base;
+    });
+    EXPECT_EQ(0, calls);
+    RamDomain args[2] = {base, base};
+    EXPECT_EQ(nullptr, failing.lookup(args));
+}
+
+}  // end namespace test
+}  // end namespace souffle
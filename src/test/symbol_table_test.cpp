@@ -17,6 +17,7 @@
 #include "AstProgram.h"
 #include "test.h"
 
+#include <algorithm>
 #include <functional>
 
 using namespace souffle;
@@ -90,6 +91,53 @@ TEST(SymbolTable, Assign) {
     EXPECT_STREQ("Hello", c.resolve(c_idx));
 }
 
+TEST(SymbolTable, EnumSymbols) {
+    SymbolTable table({"a", "Top", "b"});
+    table.moveToEnd("Top");
+
+    // enum symbols keep their insertion index relative to the end of the domain
+    RamDomain top = table.lookup("Top");
+    EXPECT_EQ(MAX_RAM_DOMAIN - 65536 + 1, top);
+    EXPECT_STREQ("Top", table.resolve(top));
+    EXPECT_STREQ("Top", table.enumTypeResolve(top));
+    EXPECT_STREQ("7", table.enumTypeResolve(7));
+    EXPECT_EQ(2, table.lookup("b"));
+    EXPECT_EQ(3, table.lookup("c"));
+    EXPECT_EQ(4, table.size());
+
+    // the old index of a moved symbol is no longer listed
+    std::vector<size_t> indices = table.getIndices();
+    EXPECT_EQ(4, indices.size());
+    EXPECT_EQ(0, std::count(indices.begin(), indices.end(), 1));
+    EXPECT_EQ(1, std::count(indices.begin(), indices.end(), static_cast<size_t>(top)));
+
+    // copies keep the moved symbols
+    SymbolTable copy(table);
+    EXPECT_EQ(top, copy.lookup("Top"));
+    EXPECT_STREQ("Top", copy.resolve(top));
+    EXPECT_EQ(3, copy.lookup("c"));
+}
+
+TEST(SymbolTable, ConcurrentLookups) {
+    const int N = 100000;
+    SymbolTable table;
+    std::vector<RamDomain> indices(N);
+
+    // every symbol is looked up by two threads, which must agree on its index
+#pragma omp parallel for num_threads(4)
+    for (int i = 0; i < 2 * N; i++) {
+        RamDomain index = table.lookup(std::to_string(i % N) + "symbol");
+        if (i < N) {
+            indices[i] = index;
+        }
+    }
+    EXPECT_EQ(N, table.size());
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(indices[i], table.lookup(std::to_string(i) + "symbol"));
+        EXPECT_EQ(std::to_string(i) + "symbol", table.resolve(indices[i]));
+    }
+}
+
 TEST(SymbolTable, Inserts) {
     // whether to print the recorded times to stdout
     // should be false unless developing